@@ -13,9 +13,9 @@ uniform vec2 screen_size;
 
 out vec4 finalColor;
 
-void main() {
-    vec4 texel = texture(texture0, fragTexCoord);
-
+// Shared with the tilemap's GPU layer renderer, which compiles this file with
+// TILEMAP_GPU_LAYER defined and feeds its own tile texels through here
+vec4 layer_effect(vec4 texel) {
     // Reconstruct world position from screen-space fragment coords
     // Note: gl_FragCoord.y is flipped (0 at bottom in OpenGL, but raylib uses 0 at top)
     vec2 screen_pos = vec2(gl_FragCoord.x, screen_size.y - gl_FragCoord.y);
@@ -31,5 +31,11 @@ void main() {
     vec3 water_tint = mix(vec3(0.85, 0.92, 1.0), vec3(0.88, 1.0, 0.95), tint_wave);
 
     vec3 result = texel.rgb * brightness * water_tint;
-    finalColor = vec4(result, texel.a) * colDiffuse * fragColor;
+    return vec4(result, texel.a);
+}
+
+#ifndef TILEMAP_GPU_LAYER
+void main() {
+    finalColor = layer_effect(texture(texture0, fragTexCoord)) * colDiffuse * fragColor;
 }
+#endif
@@ -36,13 +36,21 @@ else
     LIBS="-lGL -lm -lpthread -ldl -lrt -lX11"
 fi
 
+# Optional zstd-compressed tile layers: TILEMAP_ZSTD=1 ./build.sh
+DEFINES=""
+if [ "${TILEMAP_ZSTD:-0}" = "1" ]; then
+    DEFINES="-DTILEMAP_ZSTD"
+    LIBS="$LIBS -lzstd"
+fi
+
 echo "=== Building ${OUTPUT##*/} ($PLATFORM) ==="
 gcc -o "$OUTPUT" \
     src/main.c src/game.c src/event.c src/settings.c src/audio.c src/ui.c src/inventory.c \
     src/scene_menu.c src/scene_overworld.c src/scene_dungeon1.c src/scene_settings.c src/scene_battle.c \
-    src/tilemap.c src/cJSON.c src/collision.c src/sprite.c \
+    src/tilemap.c src/tile_batch.c src/tile_palette.c src/tile_codec.c src/json_stream.c src/task_pool.c src/arena.c src/cJSON.c src/collision.c src/sprite.c src/platform.c src/assets.c \
     -I"$RAYLIB_INCLUDE" \
     -Isrc \
+    $DEFINES \
     "$RAYLIB_LIB" \
     $LIBS \
     -Wall -Wextra -O2
@@ -0,0 +1,70 @@
+#!/bin/bash
+set -e
+
+SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
+cd "$SCRIPT_DIR"
+
+# Platform detection
+OS="$(uname -s)"
+case "$OS" in
+    Linux*)   PLATFORM=linux ;;
+    MINGW*|MSYS*|CYGWIN*) PLATFORM=windows ;;
+    *)
+        echo "ERROR: Unsupported platform: $OS"
+        exit 1
+        ;;
+esac
+
+# Auto-detect w64devkit on Windows
+if [ "$PLATFORM" = "windows" ]; then
+    W64DEV="$HOME/w64devkit/w64devkit/bin"
+    if [ -d "$W64DEV" ] && ! command -v gcc &>/dev/null; then
+        export PATH="$W64DEV:$PATH"
+    fi
+fi
+
+mkdir -p build
+
+RAYLIB_INCLUDE="raylib/src"
+RAYLIB_LIB="build/libraylib.a"
+
+if [ "$PLATFORM" = "windows" ]; then
+    EXE=".exe"
+    LIBS="-lopengl32 -lgdi32 -lwinmm"
+else
+    EXE=""
+    LIBS="-lGL -lm -lpthread -ldl -lrt -lX11"
+fi
+
+DEFINES=""
+if [ "${TILEMAP_ZSTD:-0}" = "1" ]; then
+    DEFINES="-DTILEMAP_ZSTD"
+    LIBS="$LIBS -lzstd"
+fi
+
+TILEMAP_SRC="src/tilemap.c src/tile_batch.c src/tile_palette.c src/tile_codec.c src/json_stream.c src/task_pool.c src/arena.c src/cJSON.c src/platform.c src/assets.c"
+
+# build_tool <name> [extra sources or flags]
+build_tool() {
+    local name="$1"
+    shift
+    echo "=== Building $name$EXE ($PLATFORM) ==="
+    gcc -o "build/$name$EXE" \
+        "tools/$name.c" $TILEMAP_SRC "$@" \
+        -I"$RAYLIB_INCLUDE" \
+        -Isrc \
+        $DEFINES \
+        "$RAYLIB_LIB" \
+        $LIBS \
+        -Wall -Wextra -O2
+}
+
+build_tool tmjcook
+build_tool bench_tilemap_load
+build_tool bench_tilemap_draw
+build_tool bench_tile_batch
+build_tool bench_tile_palette
+build_tool bench_collision src/collision.c
+build_tool bench_tile_codec
+
+echo "=== Tools build complete ==="
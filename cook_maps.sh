@@ -0,0 +1,18 @@
+#!/bin/bash
+# Cooks every Tiled map in assets/ into the binary .tmb format loaded at runtime
+set -e
+
+SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
+cd "$SCRIPT_DIR"
+
+COOK="build/tmjcook"
+[ -f "$COOK.exe" ] && COOK="$COOK.exe"
+if [ ! -f "$COOK" ]; then
+    echo "ERROR: $COOK not found. Run: bash build_tools.sh"
+    exit 1
+fi
+
+for map in assets/*.tmj; do
+    echo "=== Cooking $map ==="
+    "$COOK" "$map"
+done
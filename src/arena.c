@@ -0,0 +1,99 @@
+#include "arena.h"
+#include "platform.h"
+#include <stdint.h>
+#include <stdlib.h>
+
+typedef struct ArenaBlock {
+    struct ArenaBlock *next;
+    size_t size;
+    size_t used;
+    _Alignas(ARENA_ALIGN) unsigned char data[];
+} ArenaBlock;
+
+struct Arena {
+    ArenaBlock *head;       // block allocations are served from
+    PlatformMutex *mutex;   // NULL unless thread_safe
+    size_t used;
+    size_t reserved;
+    int block_count;
+};
+
+static size_t align_up(size_t size) {
+    return (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+}
+
+// calloc'd, so every allocation comes out zeroed without a memset
+static ArenaBlock *new_block(size_t size) {
+    ArenaBlock *block = (ArenaBlock *)calloc(1, sizeof(ArenaBlock) + size);
+    if (block) block->size = size;
+    return block;
+}
+
+Arena *arena_create(size_t capacity, bool thread_safe) {
+    Arena *arena = (Arena *)calloc(1, sizeof(Arena));
+    if (!arena) return NULL;
+    arena->head = new_block(align_up(capacity > 0 ? capacity : ARENA_MIN_BLOCK));
+    if (thread_safe) arena->mutex = platform_mutex_create();
+    if (!arena->head || (thread_safe && !arena->mutex)) {
+        arena_destroy(arena);
+        return NULL;
+    }
+    arena->reserved = arena->head->size;
+    arena->block_count = 1;
+    return arena;
+}
+
+void arena_destroy(Arena *arena) {
+    if (!arena) return;
+    ArenaBlock *block = arena->head;
+    while (block) {
+        ArenaBlock *next = block->next;
+        free(block);
+        block = next;
+    }
+    if (arena->mutex) platform_mutex_destroy(arena->mutex);
+    free(arena);
+}
+
+void *arena_alloc(Arena *arena, size_t size) {
+    if (size > SIZE_MAX - ARENA_ALIGN) return NULL;
+    size = align_up(size > 0 ? size : 1);
+    if (arena->mutex) platform_mutex_lock(arena->mutex);
+
+    ArenaBlock *block = arena->head;
+    if (block->size - block->used < size) {
+        // The old block's tail is abandoned; only the newest block is bumped
+        block = new_block(size > ARENA_MIN_BLOCK ? size : ARENA_MIN_BLOCK);
+        if (!block) {
+            if (arena->mutex) platform_mutex_unlock(arena->mutex);
+            return NULL;
+        }
+        block->next = arena->head;
+        arena->head = block;
+        arena->reserved += block->size;
+        arena->block_count++;
+    }
+    void *ptr = block->data + block->used;
+    block->used += size;
+    arena->used += size;
+
+    if (arena->mutex) platform_mutex_unlock(arena->mutex);
+    return ptr;
+}
+
+void *arena_alloc_array(Arena *arena, size_t count, size_t size) {
+    if (size != 0 && count > SIZE_MAX / size) return NULL;
+    return arena_alloc(arena, count * size);
+}
+
+size_t arena_used(const Arena *arena) {
+    return arena->used;
+}
+
+size_t arena_reserved(const Arena *arena) {
+    return arena->reserved;
+}
+
+int arena_block_count(const Arena *arena) {
+    return arena->block_count;
+}
@@ -0,0 +1,33 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Bump allocator for data that lives and dies together (a loaded map).
+// Memory comes from a first block sized up front; if that runs out, further
+// blocks are chained on. There is no per-allocation free: arena_destroy()
+// releases everything at once.
+
+#define ARENA_ALIGN 16
+// Smallest block chained on once the first one is full
+#define ARENA_MIN_BLOCK (64 * 1024)
+
+typedef struct Arena Arena;
+
+// capacity: size of the first block. thread_safe: allocations may come from
+// several threads at once (guarded by a mutex).
+Arena *arena_create(size_t capacity, bool thread_safe);
+void arena_destroy(Arena *arena);
+
+// Zeroed, ARENA_ALIGN-aligned memory; NULL if out of memory
+void *arena_alloc(Arena *arena, size_t size);
+// arena_alloc() of count * size bytes, with overflow check
+void *arena_alloc_array(Arena *arena, size_t count, size_t size);
+
+// Bytes handed out, and bytes reserved across all blocks
+size_t arena_used(const Arena *arena);
+size_t arena_reserved(const Arena *arena);
+int arena_block_count(const Arena *arena);
+
+#endif
@@ -0,0 +1,324 @@
+#include "assets.h"
+#include "platform.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef enum AssetKind {
+    ASSET_TEXTURE,
+    ASSET_IMAGE,
+    ASSET_SHADER,
+} AssetKind;
+
+// Blob derived from a texture's pixels, see assets_set_texture_data()
+typedef struct AssetData {
+    char tag[64];
+    size_t size;
+    struct AssetData *next;
+    // size bytes follow
+} AssetData;
+
+typedef struct AssetEntry {
+    AssetKind kind;
+    char key[512];          // normalized path ("vs|fs" for shaders)
+    int refs;
+    Texture2D texture;
+    Image image;
+    Shader shader;
+    AssetData *data;        // textures only
+} AssetEntry;
+
+// A game holds a few dozen assets at most, so lookups are a linear scan
+static AssetEntry *entries = NULL;
+static int entry_count = 0;
+static int entry_capacity = 0;
+static PlatformMutex *cache_mutex = NULL;
+
+void assets_init(void) {
+    if (!cache_mutex) cache_mutex = platform_mutex_create();
+}
+
+// "a\b/./c/../d.png" -> "a/b/d.png": one key per file however it was reached
+static void normalize_path(const char *path, char *out, size_t out_size) {
+    char buf[512];
+    snprintf(buf, sizeof(buf), "%s", path ? path : "");
+    for (char *p = buf; *p; p++) {
+        if (*p == '\\') *p = '/';
+    }
+
+    // Split in place (strtok is not thread-safe)
+    const char *segments[64];
+    int count = 0;
+    bool absolute = buf[0] == '/';
+    for (char *seg = buf, *next; seg; seg = next) {
+        next = strchr(seg, '/');
+        if (next) *next++ = '\0';
+        if (seg[0] == '\0' || strcmp(seg, ".") == 0) continue;
+        if (strcmp(seg, "..") == 0 && count > 0 && strcmp(segments[count - 1], "..") != 0) {
+            count--;
+            continue;
+        }
+        if (count < 64) segments[count++] = seg;
+    }
+
+    size_t len = 0;
+    out[0] = '\0';
+    if (absolute && len + 1 < out_size) out[len++] = '/';
+    for (int i = 0; i < count; i++) {
+        int written = snprintf(out + len, out_size - len, "%s%s", i > 0 ? "/" : "", segments[i]);
+        if (written < 0 || (size_t)written >= out_size - len) break;
+        len += (size_t)written;
+    }
+    out[len] = '\0';
+}
+
+static AssetEntry *find_entry(AssetKind kind, const char *key) {
+    for (int i = 0; i < entry_count; i++) {
+        if (entries[i].kind == kind && strcmp(entries[i].key, key) == 0) return &entries[i];
+    }
+    return NULL;
+}
+
+static AssetEntry *add_entry(AssetKind kind, const char *key) {
+    if (entry_count == entry_capacity) {
+        int capacity = entry_capacity ? entry_capacity * 2 : 32;
+        AssetEntry *grown = (AssetEntry *)realloc(entries, capacity * sizeof(AssetEntry));
+        if (!grown) return NULL;
+        entries = grown;
+        entry_capacity = capacity;
+    }
+    AssetEntry *entry = &entries[entry_count++];
+    memset(entry, 0, sizeof(*entry));
+    entry->kind = kind;
+    memcpy(entry->key, key, sizeof(entry->key));
+    entry->refs = 1;
+    return entry;
+}
+
+static void free_entry_data(AssetEntry *entry) {
+    while (entry->data) {
+        AssetData *next = entry->data->next;
+        free(entry->data);
+        entry->data = next;
+    }
+}
+
+static void remove_entry(AssetEntry *entry) {
+    free_entry_data(entry);
+    *entry = entries[--entry_count];
+}
+
+static void lock(void) {
+    assets_init();
+    platform_mutex_lock(cache_mutex);
+}
+
+static void unlock(void) {
+    platform_mutex_unlock(cache_mutex);
+}
+
+// Cache hit: take a reference and copy the resource out
+static bool acquire_cached(AssetKind kind, const char *key, AssetEntry *out) {
+    lock();
+    AssetEntry *entry = find_entry(kind, key);
+    if (entry) {
+        entry->refs++;
+        *out = *entry;
+    }
+    unlock();
+    return entry != NULL;
+}
+
+// Cache miss: store a freshly loaded resource. If another thread stored the
+// same key meanwhile, its copy wins and false is returned so the caller can
+// unload its own.
+static bool store_loaded(const AssetEntry *loaded, AssetEntry *out) {
+    lock();
+    AssetEntry *entry = find_entry(loaded->kind, loaded->key);
+    bool stored = false;
+    if (entry) {
+        entry->refs++;
+    } else {
+        entry = add_entry(loaded->kind, loaded->key);
+        if (entry) {
+            entry->texture = loaded->texture;
+            entry->image = loaded->image;
+            entry->shader = loaded->shader;
+            stored = true;
+        }
+    }
+    *out = entry ? *entry : *loaded;
+    unlock();
+    return stored || !entry;
+}
+
+Texture2D assets_acquire_texture_from_image(const char *path, Image image) {
+    AssetEntry loaded = { .kind = ASSET_TEXTURE };
+    normalize_path(path, loaded.key, sizeof(loaded.key));
+
+    AssetEntry cached;
+    if (acquire_cached(ASSET_TEXTURE, loaded.key, &cached)) return cached.texture;
+
+    if (image.data) {
+        loaded.texture = LoadTextureFromImage(image);
+    } else {
+        loaded.texture = LoadTexture(loaded.key);
+    }
+    if (loaded.texture.id == 0) {
+        printf("[assets] WARNING: Could not load texture: %s\n", loaded.key);
+        return loaded.texture;
+    }
+
+    // Textures are only created on the main thread, so this always stores
+    store_loaded(&loaded, &cached);
+    return cached.texture;
+}
+
+Texture2D assets_acquire_texture(const char *path) {
+    return assets_acquire_texture_from_image(path, (Image){ 0 });
+}
+
+void assets_release_texture(Texture2D texture) {
+    if (texture.id == 0) return;
+    lock();
+    for (int i = 0; i < entry_count; i++) {
+        AssetEntry *entry = &entries[i];
+        if (entry->kind != ASSET_TEXTURE || entry->texture.id != texture.id) continue;
+        bool last = --entry->refs == 0;
+        if (last) remove_entry(entry);
+        unlock();
+        if (last) UnloadTexture(texture);
+        return;
+    }
+    unlock();
+    printf("[assets] WARNING: Released texture %u that is not in the cache\n", texture.id);
+    UnloadTexture(texture);
+}
+
+bool assets_texture_cached(const char *path) {
+    char key[512];
+    normalize_path(path, key, sizeof(key));
+    lock();
+    bool cached = find_entry(ASSET_TEXTURE, key) != NULL;
+    unlock();
+    return cached;
+}
+
+static AssetData *find_data(const AssetEntry *entry, const char *tag) {
+    for (AssetData *data = entry ? entry->data : NULL; data; data = data->next) {
+        if (strcmp(data->tag, tag) == 0) return data;
+    }
+    return NULL;
+}
+
+void assets_set_texture_data(const char *path, const char *tag, const void *bytes, size_t size) {
+    char key[512];
+    normalize_path(path, key, sizeof(key));
+    lock();
+    AssetEntry *entry = find_entry(ASSET_TEXTURE, key);
+    if (entry && !find_data(entry, tag)) {
+        AssetData *data = (AssetData *)malloc(sizeof(AssetData) + size);
+        if (data) {
+            snprintf(data->tag, sizeof(data->tag), "%s", tag);
+            data->size = size;
+            memcpy(data + 1, bytes, size);
+            data->next = entry->data;
+            entry->data = data;
+        }
+    }
+    unlock();
+}
+
+bool assets_texture_data(const char *path, const char *tag, void *out, size_t size) {
+    char key[512];
+    normalize_path(path, key, sizeof(key));
+    lock();
+    AssetData *data = find_data(find_entry(ASSET_TEXTURE, key), tag);
+    bool found = data && data->size == size;
+    if (found) memcpy(out, data + 1, size);
+    unlock();
+    return found;
+}
+
+Image assets_acquire_image(const char *path) {
+    AssetEntry loaded = { .kind = ASSET_IMAGE };
+    normalize_path(path, loaded.key, sizeof(loaded.key));
+
+    AssetEntry cached;
+    if (acquire_cached(ASSET_IMAGE, loaded.key, &cached)) return cached.image;
+
+    // Decoded outside the lock so loader threads don't serialize on it
+    loaded.image = LoadImage(loaded.key);
+    if (!loaded.image.data) {
+        printf("[assets] WARNING: Could not load image: %s\n", loaded.key);
+        return loaded.image;
+    }
+    if (!store_loaded(&loaded, &cached)) UnloadImage(loaded.image);
+    return cached.image;
+}
+
+void assets_release_image(Image image) {
+    if (!image.data) return;
+    lock();
+    for (int i = 0; i < entry_count; i++) {
+        AssetEntry *entry = &entries[i];
+        if (entry->kind != ASSET_IMAGE || entry->image.data != image.data) continue;
+        bool last = --entry->refs == 0;
+        if (last) remove_entry(entry);
+        unlock();
+        if (last) UnloadImage(image);
+        return;
+    }
+    unlock();
+    printf("[assets] WARNING: Released an image that is not in the cache\n");
+}
+
+Shader assets_acquire_shader(const char *vs_path, const char *fs_path) {
+    char vs_key[512], fs_key[512];
+    normalize_path(vs_path, vs_key, sizeof(vs_key));
+    normalize_path(fs_path, fs_key, sizeof(fs_key));
+
+    AssetEntry loaded = { .kind = ASSET_SHADER };
+    snprintf(loaded.key, sizeof(loaded.key), "%.250s|%.250s", vs_key, fs_key);
+
+    AssetEntry cached;
+    if (acquire_cached(ASSET_SHADER, loaded.key, &cached)) return cached.shader;
+
+    loaded.shader = LoadShader(vs_path ? vs_key : NULL, fs_path ? fs_key : NULL);
+    store_loaded(&loaded, &cached);
+    return cached.shader;
+}
+
+void assets_release_shader(Shader shader) {
+    if (shader.id == 0) return;
+    lock();
+    for (int i = 0; i < entry_count; i++) {
+        AssetEntry *entry = &entries[i];
+        if (entry->kind != ASSET_SHADER || entry->shader.id != shader.id) continue;
+        bool last = --entry->refs == 0;
+        if (last) remove_entry(entry);
+        unlock();
+        if (last) UnloadShader(shader);
+        return;
+    }
+    unlock();
+    printf("[assets] WARNING: Released shader %u that is not in the cache\n", shader.id);
+    UnloadShader(shader);
+}
+
+void assets_shutdown(void) {
+    for (int i = 0; i < entry_count; i++) {
+        AssetEntry *entry = &entries[i];
+        printf("[assets] WARNING: %s still has %d reference(s) at shutdown\n", entry->key, entry->refs);
+        free_entry_data(entry);
+        if (entry->kind == ASSET_TEXTURE) UnloadTexture(entry->texture);
+        else if (entry->kind == ASSET_IMAGE) UnloadImage(entry->image);
+        else UnloadShader(entry->shader);
+    }
+    free(entries);
+    entries = NULL;
+    entry_count = 0;
+    entry_capacity = 0;
+    platform_mutex_destroy(cache_mutex);
+    cache_mutex = NULL;
+}
@@ -0,0 +1,46 @@
+#ifndef ASSETS_H
+#define ASSETS_H
+
+#include "raylib.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+// Reference-counted cache of textures, images and shaders, keyed by the
+// normalized file path. Every acquire must be paired with a release; the
+// resource is unloaded when its last reference is released, so a second user
+// of the same file (another scene, a duplicate tileset) costs no disk read or
+// GPU upload.
+//
+// Textures and shaders are main-thread only. Images, assets_texture_cached()
+// and assets_texture_data() may be used from loader threads once
+// assets_init() has run on the main thread.
+
+void assets_init(void);
+// Unload everything still cached (leaked references are reported)
+void assets_shutdown(void);
+
+// Returns a texture with id 0 if the file could not be loaded
+Texture2D assets_acquire_texture(const char *path);
+// Like assets_acquire_texture(), but uploads `image` (already decoded from
+// `path`, e.g. on a loader thread) on a cache miss instead of reading the file.
+// The image stays owned by the caller.
+Texture2D assets_acquire_texture_from_image(const char *path, Image image);
+void assets_release_texture(Texture2D texture);
+bool assets_texture_cached(const char *path);
+// Data derived from a texture's pixels (e.g. a tileset's per-tile analysis),
+// kept with the cached texture under `tag` until the texture is unloaded, so
+// a later user of the texture doesn't decode the file again to redo it. Set
+// copies `bytes` (a no-op if the texture isn't cached or `tag` is already
+// set); get copies the data into `out` and is false unless it is `size` bytes.
+void assets_set_texture_data(const char *path, const char *tag, const void *bytes, size_t size);
+bool assets_texture_data(const char *path, const char *tag, void *out, size_t size);
+
+// The pixels are shared: never UnloadImage() or modify the result
+Image assets_acquire_image(const char *path);
+void assets_release_image(Image image);
+
+// vs_path may be NULL (default vertex shader), as with LoadShader()
+Shader assets_acquire_shader(const char *vs_path, const char *fs_path);
+void assets_release_shader(Shader shader);
+
+#endif
@@ -1,8 +1,9 @@
 #include "collision.h"
 #include "tilemap.h"
+#include <math.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <math.h>
 
 CollisionWorld *collision_create(void) {
     CollisionWorld *world = calloc(1, sizeof(CollisionWorld));
@@ -10,30 +11,381 @@ CollisionWorld *collision_create(void) {
 }
 
 void collision_destroy(CollisionWorld *world) {
-    if (world) free(world);
-}
-
-int collision_add_body(CollisionWorld *world, Rectangle rect, BodyType type, BodyTag tag, int elevation, void *user_data) {
-    if (world->body_count >= COLLISION_MAX_BODIES) return -1;
-    int index = world->body_count++;
-    world->bodies[index].rect = rect;
-    world->bodies[index].type = type;
-    world->bodies[index].tag = tag;
-    world->bodies[index].active = true;
-    world->bodies[index].elevation = elevation;
-    world->bodies[index].user_data = user_data;
+    if (!world) return;
+    for (int i = 0; i <= world->cell_mask && world->cells; i++) free(world->cells[i].bodies);
+    free(world->cells);
+    free(world->candidates);
+    free(world->rects);
+    free(world->elevations);
+    free(world->types);
+    free(world->tags);
+    free(world->flags);
+    free(world->object_ids);
+    free(world->user_data);
+    free(world->handles);
+    free(world->grid_spans);
+    free(world->query_marks);
+    free(world->holes);
+    free(world->slot_index);
+    free(world->slot_generation);
+    free(world->free_slots);
+    free(world);
+}
+
+// Body storage: growable parallel arrays plus a table of handle slots
+
+static bool grow_array(void **array, int capacity, size_t size) {
+    void *grown = realloc(*array, (size_t)capacity * size);
+    if (!grown) return false;
+    *array = grown;
+    return true;
+}
+
+static bool grow_bodies(CollisionWorld *world) {
+    int capacity = world->body_capacity ? world->body_capacity * 2 : 256;
+    if (!grow_array((void **)&world->rects, capacity, sizeof(Rectangle)) ||
+        !grow_array((void **)&world->elevations, capacity, sizeof(int)) ||
+        !grow_array((void **)&world->types, capacity, sizeof(BodyType)) ||
+        !grow_array((void **)&world->tags, capacity, sizeof(BodyTag)) ||
+        !grow_array((void **)&world->flags, capacity, sizeof(uint8_t)) ||
+        !grow_array((void **)&world->object_ids, capacity, sizeof(int)) ||
+        !grow_array((void **)&world->user_data, capacity, sizeof(void *)) ||
+        !grow_array((void **)&world->handles, capacity, sizeof(CollisionHandle)) ||
+        !grow_array((void **)&world->grid_spans, capacity, sizeof(CollisionGridSpan)) ||
+        !grow_array((void **)&world->query_marks, capacity, sizeof(unsigned)) ||
+        !grow_array((void **)&world->holes, capacity, sizeof(int))) {
+        return false;
+    }
+    world->body_capacity = capacity;
+    return true;
+}
+
+static CollisionHandle make_handle(int slot, uint32_t generation) {
+    return (generation << COLLISION_HANDLE_SLOT_BITS) | (uint32_t)slot;
+}
+
+// Generations use the bits above the slot and skip 0, so no handle is NONE
+static uint32_t next_generation(uint32_t generation) {
+    generation = (generation + 1) & ((1u << (32 - COLLISION_HANDLE_SLOT_BITS)) - 1);
+    return generation ? generation : 1;
+}
+
+static CollisionHandle alloc_handle(CollisionWorld *world, int index) {
+    int slot;
+    if (world->free_slot_count > 0) {
+        slot = world->free_slots[--world->free_slot_count];
+    } else {
+        if (world->slot_count == COLLISION_MAX_HANDLES) return COLLISION_HANDLE_NONE;
+        if (world->slot_count == world->slot_capacity) {
+            int capacity = world->slot_capacity ? world->slot_capacity * 2 : 256;
+            if (!grow_array((void **)&world->slot_index, capacity, sizeof(int)) ||
+                !grow_array((void **)&world->slot_generation, capacity, sizeof(uint32_t)) ||
+                !grow_array((void **)&world->free_slots, capacity, sizeof(int))) {
+                return COLLISION_HANDLE_NONE;
+            }
+            world->slot_capacity = capacity;
+        }
+        slot = world->slot_count++;
+        world->slot_generation[slot] = 1;
+    }
+    world->slot_index[slot] = index;
+    return make_handle(slot, world->slot_generation[slot]);
+}
+
+int collision_body_index(const CollisionWorld *world, CollisionHandle handle) {
+    if (!world || handle == COLLISION_HANDLE_NONE) return -1;
+    int slot = (int)(handle & (COLLISION_MAX_HANDLES - 1));
+    uint32_t generation = handle >> COLLISION_HANDLE_SLOT_BITS;
+    if (slot >= world->slot_count || world->slot_generation[slot] != generation) return -1;
+    return world->slot_index[slot];
+}
+
+bool collision_body_valid(const CollisionWorld *world, CollisionHandle handle) {
+    return collision_body_index(world, handle) >= 0;
+}
+
+// Broadphase: a spatial hash of (elevation, cell) -> bodies whose rects
+// touch the cell. Static and kinematic bodies are both listed; a body is
+// re-listed only when the cells it covers change.
+
+static int grid_coord(float v) {
+    return (int)floorf(v / COLLISION_GRID_CELL);
+}
+
+static uint32_t cell_hash(int x, int y, int elevation) {
+    return ((uint32_t)x * 73856093u) ^ ((uint32_t)y * 19349663u) ^ ((uint32_t)elevation * 83492791u);
+}
+
+static CollisionCell *probe_cell(CollisionCell *cells, int mask, int x, int y, int elevation) {
+    uint32_t slot = cell_hash(x, y, elevation) & (uint32_t)mask;
+    while (cells[slot].used && (cells[slot].x != x || cells[slot].y != y || cells[slot].elevation != elevation)) {
+        slot = (slot + 1) & (uint32_t)mask;
+    }
+    return &cells[slot];
+}
+
+// Table kept at most half full
+static bool grow_cells(CollisionWorld *world) {
+    int size = world->cell_mask ? (world->cell_mask + 1) * 2 : 256;
+    CollisionCell *cells = calloc(size, sizeof(CollisionCell));
+    if (!cells) return false;
+    for (int i = 0; world->cells && i <= world->cell_mask; i++) {
+        CollisionCell *cell = &world->cells[i];
+        if (cell->used) *probe_cell(cells, size - 1, cell->x, cell->y, cell->elevation) = *cell;
+    }
+    free(world->cells);
+    world->cells = cells;
+    world->cell_mask = size - 1;
+    return true;
+}
+
+// NULL if the cell has no table entry (and `create` is false, or out of memory)
+static CollisionCell *find_cell(CollisionWorld *world, int x, int y, int elevation, bool create) {
+    if (!world->cells) {
+        if (!create || !grow_cells(world)) return NULL;
+    }
+    CollisionCell *cell = probe_cell(world->cells, world->cell_mask, x, y, elevation);
+    if (cell->used) return cell;
+    if (!create) return NULL;
+    if ((world->cells_used + 1) * 2 > world->cell_mask + 1) {
+        if (!grow_cells(world)) return NULL;
+        cell = probe_cell(world->cells, world->cell_mask, x, y, elevation);
+    }
+    cell->used = true;
+    cell->x = x;
+    cell->y = y;
+    cell->elevation = elevation;
+    world->cells_used++;
+    return cell;
+}
+
+static void grid_unlist(CollisionWorld *world, int index) {
+    if (!(world->flags[index] & BODY_IN_GRID)) return;
+    const CollisionGridSpan *span = &world->grid_spans[index];
+    for (int y = span->y0; y <= span->y1; y++) {
+        for (int x = span->x0; x <= span->x1; x++) {
+            CollisionCell *cell = find_cell(world, x, y, span->elevation, false);
+            for (int i = 0; cell && i < cell->count; i++) {
+                if (cell->bodies[i] != index) continue;
+                cell->bodies[i] = cell->bodies[--cell->count];
+                break;
+            }
+        }
+    }
+    world->flags[index] &= (uint8_t)~BODY_IN_GRID;
+}
+
+static CollisionGridSpan grid_span(Rectangle rect, int elevation) {
+    return (CollisionGridSpan){ grid_coord(rect.x), grid_coord(rect.y), grid_coord(rect.x + rect.width),
+                                grid_coord(rect.y + rect.height), elevation };
+}
+
+static void grid_list(CollisionWorld *world, int index) {
+    CollisionGridSpan *span = &world->grid_spans[index];
+    *span = grid_span(world->rects[index], world->elevations[index]);
+    world->flags[index] |= BODY_IN_GRID;
+    for (int y = span->y0; y <= span->y1; y++) {
+        for (int x = span->x0; x <= span->x1; x++) {
+            CollisionCell *cell = find_cell(world, x, y, span->elevation, true);
+            if (!cell) continue;
+            if (cell->count == cell->capacity) {
+                int capacity = cell->capacity ? cell->capacity * 2 : 4;
+                int *bodies = realloc(cell->bodies, capacity * sizeof(int));
+                if (!bodies) continue;
+                cell->bodies = bodies;
+                cell->capacity = capacity;
+            }
+            cell->bodies[cell->count++] = index;
+        }
+    }
+}
+
+// Re-list a live body whose rect or elevation changed, if its cells did
+static void update_body(CollisionWorld *world, int index) {
+    CollisionGridSpan span = grid_span(world->rects[index], world->elevations[index]);
+    const CollisionGridSpan *listed = &world->grid_spans[index];
+    if ((world->flags[index] & BODY_IN_GRID) && listed->x0 == span.x0 && listed->y0 == span.y0 &&
+        listed->x1 == span.x1 && listed->y1 == span.y1 && listed->elevation == span.elevation) {
+        return;
+    }
+    grid_unlist(world, index);
+    grid_list(world, index);
+}
+
+static int compare_ints(const void *a, const void *b) {
+    int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+// Active bodies listed in the cells under `rect` at `elevation`, each once,
+// into world->candidates in dense order. Returns the count.
+static int collect_candidates(CollisionWorld *world, Rectangle rect, int elevation) {
+    if (++world->query_mark == 0) {
+        for (int i = 0; i < world->body_count; i++) world->query_marks[i] = 0;
+        world->query_mark = 1;
+    }
+    int count = 0;
+    int x0 = grid_coord(rect.x), x1 = grid_coord(rect.x + rect.width);
+    int y0 = grid_coord(rect.y), y1 = grid_coord(rect.y + rect.height);
+    for (int y = y0; y <= y1; y++) {
+        for (int x = x0; x <= x1; x++) {
+            CollisionCell *cell = find_cell(world, x, y, elevation, false);
+            for (int i = 0; cell && i < cell->count; i++) {
+                int index = cell->bodies[i];
+                if (world->query_marks[index] == world->query_mark || !(world->flags[index] & BODY_ACTIVE)) continue;
+                world->query_marks[index] = world->query_mark;
+                if (count == world->candidate_capacity) {
+                    int capacity = world->candidate_capacity ? world->candidate_capacity * 2 : 64;
+                    int *candidates = realloc(world->candidates, capacity * sizeof(int));
+                    if (!candidates) return count;
+                    world->candidates = candidates;
+                    world->candidate_capacity = capacity;
+                }
+                world->candidates[count++] = index;
+            }
+        }
+    }
+    qsort(world->candidates, count, sizeof(int), compare_ints);
+    return count;
+}
+
+int collision_query_rect(CollisionWorld *world, Rectangle rect, int elevation, CollisionHandle *out, int capacity) {
+    if (!world) return 0;
+    int count = collect_candidates(world, rect, elevation), found = 0;
+    for (int c = 0; c < count; c++) {
+        int index = world->candidates[c];
+        if (world->elevations[index] != elevation || !CheckCollisionRecs(rect, world->rects[index])) continue;
+        if (out && found < capacity) out[found] = world->handles[index];
+        found++;
+    }
+    return found;
+}
+
+// Dense index of the new body, or -1 if out of memory
+static int add_body(CollisionWorld *world, Rectangle rect, BodyType type, BodyTag tag, int elevation,
+                    void *user_data) {
+    int index;
+    if (world->hole_count > 0) {
+        index = world->holes[--world->hole_count];
+    } else {
+        if (world->body_count == world->body_capacity && !grow_bodies(world)) return -1;
+        index = world->body_count;
+    }
+    CollisionHandle handle = alloc_handle(world, index);
+    if (handle == COLLISION_HANDLE_NONE) {
+        if (index < world->body_count) world->holes[world->hole_count++] = index;
+        return -1;
+    }
+    if (index == world->body_count) world->body_count++;
+    world->rects[index] = rect;
+    world->elevations[index] = elevation;
+    world->types[index] = type;
+    world->tags[index] = tag;
+    world->flags[index] = BODY_ACTIVE;
+    world->object_ids[index] = 0;
+    world->user_data[index] = user_data;
+    world->handles[index] = handle;
+    world->query_marks[index] = 0;
+    world->live_count++;
+    grid_list(world, index);
     return index;
 }
 
-void collision_remove_body(CollisionWorld *world, int index) {
-    if (index >= 0 && index < world->body_count) {
-        world->bodies[index].active = false;
+CollisionHandle collision_add_body(CollisionWorld *world, Rectangle rect, BodyType type, BodyTag tag, int elevation,
+                                   void *user_data) {
+    int index = add_body(world, rect, type, tag, elevation, user_data);
+    if (index < 0) {
+        printf("[collision] Out of memory after %d bodies\n", world->live_count);
+        return COLLISION_HANDLE_NONE;
     }
+    return world->handles[index];
+}
+
+static void remove_body(CollisionWorld *world, int index) {
+    grid_unlist(world, index);
+    int slot = (int)(world->handles[index] & (COLLISION_MAX_HANDLES - 1));
+    world->slot_generation[slot] = next_generation(world->slot_generation[slot]);
+    world->slot_index[slot] = -1;
+    world->free_slots[world->free_slot_count++] = slot;
+    world->flags[index] = 0;
+    world->user_data[index] = NULL;
+    world->holes[world->hole_count++] = index;
+    world->live_count--;
+}
+
+void collision_remove_body(CollisionWorld *world, CollisionHandle handle) {
+    int index = collision_body_index(world, handle);
+    if (index >= 0) remove_body(world, index);
+}
+
+Rectangle collision_body_rect(const CollisionWorld *world, CollisionHandle handle) {
+    int index = collision_body_index(world, handle);
+    return index >= 0 ? world->rects[index] : (Rectangle){ 0, 0, 0, 0 };
+}
+
+int collision_body_elevation(const CollisionWorld *world, CollisionHandle handle) {
+    int index = collision_body_index(world, handle);
+    return index >= 0 ? world->elevations[index] : 0;
+}
+
+void collision_set_body_rect(CollisionWorld *world, CollisionHandle handle, Rectangle rect) {
+    int index = collision_body_index(world, handle);
+    if (index < 0) return;
+    world->rects[index] = rect;
+    update_body(world, index);
+}
+
+void collision_set_body_elevation(CollisionWorld *world, CollisionHandle handle, int elevation) {
+    int index = collision_body_index(world, handle);
+    if (index < 0) return;
+    world->elevations[index] = elevation;
+    update_body(world, index);
+}
+
+bool collision_compact(CollisionWorld *world) {
+    if (!world || world->hole_count < COLLISION_COMPACT_MIN_HOLES || world->hole_count * 4 < world->body_count) {
+        return false;
+    }
+    // Slide live bodies down in order; `holes` becomes the old -> new map
+    int *remap = world->holes;
+    int count = 0;
+    for (int i = 0; i < world->body_count; i++) {
+        if (!(world->flags[i] & BODY_ACTIVE)) {
+            remap[i] = -1;
+            continue;
+        }
+        remap[i] = count;
+        if (i != count) {
+            world->rects[count] = world->rects[i];
+            world->elevations[count] = world->elevations[i];
+            world->types[count] = world->types[i];
+            world->tags[count] = world->tags[i];
+            world->flags[count] = world->flags[i];
+            world->object_ids[count] = world->object_ids[i];
+            world->user_data[count] = world->user_data[i];
+            world->handles[count] = world->handles[i];
+            world->grid_spans[count] = world->grid_spans[i];
+        }
+        world->slot_index[world->handles[count] & (COLLISION_MAX_HANDLES - 1)] = count;
+        world->query_marks[count] = 0;
+        count++;
+    }
+    // Cells only list live bodies, and keep their order under the remap
+    for (int c = 0; world->cells && c <= world->cell_mask; c++) {
+        CollisionCell *cell = &world->cells[c];
+        for (int i = 0; i < cell->count; i++) cell->bodies[i] = remap[cell->bodies[i]];
+    }
+    world->query_mark = 0;
+    world->body_count = count;
+    world->hole_count = 0;
+    return true;
 }
 
 int collision_load_from_tilemap(CollisionWorld *world, TileMap *tilemap, const char *layer_name) {
     if (!tilemap || !tilemap->loaded) return 0;
 
+    // Ramp objects are loaded separately
+    int ramp_type = tilemap_string_id(tilemap, "elevation_ramp");
     int count = 0;
     for (int l = 0; l < tilemap->object_layer_count; l++) {
         ObjectLayer *layer = &tilemap->object_layers[l];
@@ -41,106 +393,172 @@ int collision_load_from_tilemap(CollisionWorld *world, TileMap *tilemap, const c
 
         for (int i = 0; i < layer->object_count; i++) {
             MapObject *obj = &layer->objects[i];
+            if (obj->type_id == ramp_type) continue;
 
-            // Skip ramp objects — they are loaded separately
-            if (strcmp(obj->type, "elevation_ramp") == 0) continue;
-
-            float ox = (float)obj->x;
-            float oy = (float)obj->y;
-            float ow = (float)obj->width;
-            float oh = (float)obj->height;
-
-            if (obj->rotation != 0.0) {
-                /* Tiled rotates around top-left corner. Compute AABB of rotated rect. */
-                float rad = (float)(obj->rotation * (3.14159265358979323846 / 180.0));
-                float cos_r = cosf(rad);
-                float sin_r = sinf(rad);
-
-                /* Four corners relative to top-left (rotation pivot) */
-                float cx[4] = { 0, ow, ow, 0 };
-                float cy[4] = { 0, 0, oh, oh };
-
-                float min_x = ox, max_x = ox;
-                float min_y = oy, max_y = oy;
-                for (int c = 0; c < 4; c++) {
-                    float rx = ox + cx[c] * cos_r - cy[c] * sin_r;
-                    float ry = oy + cx[c] * sin_r + cy[c] * cos_r;
-                    if (rx < min_x) min_x = rx;
-                    if (rx > max_x) max_x = rx;
-                    if (ry < min_y) min_y = ry;
-                    if (ry > max_y) max_y = ry;
-                }
-
-                Rectangle rect = { min_x, min_y, max_x - min_x, max_y - min_y };
-                collision_add_body(world, rect, BODY_STATIC, TAG_WALL, obj->elevation, NULL);
-            } else {
-                Rectangle rect = { ox, oy, ow, oh };
-                collision_add_body(world, rect, BODY_STATIC, TAG_WALL, obj->elevation, NULL);
+            // bounds is the AABB of the rect rotated around its top-left corner
+            int index = add_body(world, obj->bounds, BODY_STATIC, TAG_WALL, obj->elevation, NULL);
+            if (index < 0) {
+                printf("[collision] Out of memory after %d bodies of %s\n", count, layer_name);
+                return count;
             }
+            world->object_ids[index] = obj->id;
             count++;
         }
     }
     return count;
 }
 
-Vector2 collision_move_and_slide(CollisionWorld *world, int body_index, float dx, float dy) {
-    if (body_index < 0 || body_index >= world->body_count) return (Vector2){0, 0};
-    CollisionBody *body = &world->bodies[body_index];
-    if (!body->active) return (Vector2){body->rect.x, body->rect.y};
+static int compare_object_ids(const void *a, const void *b) {
+    int x = (*(MapObject *const *)a)->id, y = (*(MapObject *const *)b)->id;
+    return (x > y) - (x < y);
+}
 
-    /* Step 1: Move X */
-    body->rect.x += dx;
-    for (int i = 0; i < world->body_count; i++) {
-        if (i == body_index) continue;
-        CollisionBody *other = &world->bodies[i];
-        if (!other->active || other->type != BODY_STATIC) continue;
-        if (other->elevation != body->elevation) continue;
-        if (CheckCollisionRecs(body->rect, other->rect)) {
-            if (dx > 0) {
-                body->rect.x = other->rect.x - body->rect.width;
-            } else if (dx < 0) {
-                body->rect.x = other->rect.x + other->rect.width;
-            }
+static bool same_rect(Rectangle a, Rectangle b) {
+    return a.x == b.x && a.y == b.y && a.width == b.width && a.height == b.height;
+}
+
+int collision_reload_from_tilemap(CollisionWorld *world, TileMap *tilemap, const char *layer_name) {
+    if (!world || !tilemap || !tilemap->loaded) return 0;
+    int ramp_type = tilemap_string_id(tilemap, "elevation_ramp");
+    int object_count = 0;
+    for (int l = 0; l < tilemap->object_layer_count; l++) {
+        const ObjectLayer *layer = &tilemap->object_layers[l];
+        if (strcmp(layer->name, layer_name) == 0) object_count += layer->object_count;
+    }
+
+    // The wall objects of every layer with this name by id, each matched to
+    // at most one body
+    int wall_count = 0;
+    MapObject **walls = calloc(object_count > 0 ? object_count : 1, sizeof(MapObject *));
+    bool *matched = calloc(object_count > 0 ? object_count : 1, sizeof(bool));
+    if (!walls || !matched) {
+        free(walls);
+        free(matched);
+        return 0;
+    }
+    for (int l = 0; l < tilemap->object_layer_count; l++) {
+        ObjectLayer *layer = &tilemap->object_layers[l];
+        if (strcmp(layer->name, layer_name) != 0) continue;
+        for (int i = 0; i < layer->object_count; i++) {
+            if (layer->objects[i].type_id != ramp_type) walls[wall_count++] = &layer->objects[i];
         }
     }
+    qsort(walls, wall_count, sizeof(MapObject *), compare_object_ids);
 
-    /* Step 2: Move Y */
-    body->rect.y += dy;
+    int touched = 0;
     for (int i = 0; i < world->body_count; i++) {
+        if (!(world->flags[i] & BODY_ACTIVE) || world->object_ids[i] == 0) continue;
+        MapObject key = { .id = world->object_ids[i] }, *key_ref = &key;
+        MapObject **found = bsearch(&key_ref, walls, wall_count, sizeof(MapObject *), compare_object_ids);
+        if (!found || matched[found - walls]) {
+            remove_body(world, i);
+            touched++;
+            continue;
+        }
+        matched[found - walls] = true;
+        if (!same_rect(world->rects[i], (*found)->bounds) || world->elevations[i] != (*found)->elevation) {
+            world->rects[i] = (*found)->bounds;
+            world->elevations[i] = (*found)->elevation;
+            update_body(world, i);
+            touched++;
+        }
+    }
+
+    // New objects fill the holes of removed ones first
+    for (int w = 0; w < wall_count; w++) {
+        if (matched[w]) continue;
+        int index = add_body(world, walls[w]->bounds, BODY_STATIC, TAG_WALL, walls[w]->elevation, NULL);
+        if (index < 0) break;
+        world->object_ids[index] = walls[w]->id;
+        touched++;
+    }
+    collision_compact(world);
+    free(walls);
+    free(matched);
+    return touched;
+}
+
+static Rectangle rect_union(Rectangle a, Rectangle b) {
+    float x0 = fminf(a.x, b.x), y0 = fminf(a.y, b.y);
+    float x1 = fmaxf(a.x + a.width, b.x + b.width), y1 = fmaxf(a.y + a.height, b.y + b.height);
+    return (Rectangle){ x0, y0, x1 - x0, y1 - y0 };
+}
+
+static bool rect_contains(Rectangle outer, Rectangle inner) {
+    return inner.x >= outer.x && inner.y >= outer.y && inner.x + inner.width <= outer.x + outer.width &&
+           inner.y + inner.height <= outer.y + outer.height;
+}
+
+// One axis of move-and-slide: the body has moved by `delta` from `start`;
+// push it out of the static bodies it overlaps, in dense order. Candidates
+// come from the cells under the swept rect. A body that started inside a
+// wall can be pushed back past its start, and then the cells it moved into
+// are collected too, so the result is exactly that of testing every body.
+static void slide_axis(CollisionWorld *world, int body_index, Rectangle start, bool x_axis, float delta) {
+    Rectangle *rect = &world->rects[body_index];
+    int elevation = world->elevations[body_index];
+    Rectangle region = rect_union(start, *rect);
+    int count = collect_candidates(world, region, elevation);
+    for (int c = 0; c < count; c++) {
+        int i = world->candidates[c];
         if (i == body_index) continue;
-        CollisionBody *other = &world->bodies[i];
-        if (!other->active || other->type != BODY_STATIC) continue;
-        if (other->elevation != body->elevation) continue;
-        if (CheckCollisionRecs(body->rect, other->rect)) {
-            if (dy > 0) {
-                body->rect.y = other->rect.y - body->rect.height;
-            } else if (dy < 0) {
-                body->rect.y = other->rect.y + other->rect.height;
+        if (!(world->flags[i] & BODY_ACTIVE) || world->types[i] != BODY_STATIC) continue;
+        if (world->elevations[i] != elevation) continue;
+        const Rectangle other = world->rects[i];
+        if (!CheckCollisionRecs(*rect, other)) continue;
+        if (x_axis) {
+            if (delta > 0) {
+                rect->x = other.x - rect->width;
+            } else if (delta < 0) {
+                rect->x = other.x + other.width;
+            }
+        } else {
+            if (delta > 0) {
+                rect->y = other.y - rect->height;
+            } else if (delta < 0) {
+                rect->y = other.y + other.height;
             }
         }
+        if (!rect_contains(region, *rect)) {
+            region = rect_union(region, *rect);
+            count = collect_candidates(world, region, elevation);
+            for (c = 0; c < count && world->candidates[c] <= i; c++) {}
+            c--;
+        }
     }
+}
 
-    return (Vector2){body->rect.x, body->rect.y};
+Vector2 collision_move_and_slide(CollisionWorld *world, CollisionHandle handle, float dx, float dy) {
+    int index = collision_body_index(world, handle);
+    if (index < 0) return (Vector2){0, 0};
+    Rectangle *rect = &world->rects[index];
+
+    /* Step 1: Move X */
+    Rectangle start = *rect;
+    rect->x += dx;
+    slide_axis(world, index, start, true, dx);
+
+    /* Step 2: Move Y */
+    start = *rect;
+    rect->y += dy;
+    slide_axis(world, index, start, false, dy);
+
+    update_body(world, index);
+    return (Vector2){rect->x, rect->y};
 }
 
 int collision_load_ramps_from_tilemap(ElevationRampSet *ramps, TileMap *tilemap, const char *layer_name) {
     if (!tilemap || !tilemap->loaded || !ramps) return 0;
 
     ramps->count = 0;
-    for (int l = 0; l < tilemap->object_layer_count; l++) {
-        ObjectLayer *layer = &tilemap->object_layers[l];
-        if (strcmp(layer->name, layer_name) != 0) continue;
-
-        for (int i = 0; i < layer->object_count; i++) {
-            MapObject *obj = &layer->objects[i];
-            if (strcmp(obj->type, "elevation_ramp") != 0) continue;
-            if (ramps->count >= ELEVATION_MAX_RAMPS) break;
-
-            ElevationRamp *r = &ramps->ramps[ramps->count++];
-            r->rect = (Rectangle){ (float)obj->x, (float)obj->y, (float)obj->width, (float)obj->height };
-            r->from_elevation = obj->from_elevation;
-            r->to_elevation = obj->to_elevation;
-        }
+    int count = 0;
+    MapObject *const *objects = tilemap_objects_of_type(tilemap, layer_name, "elevation_ramp", &count);
+    for (int i = 0; i < count && ramps->count < ELEVATION_MAX_RAMPS; i++) {
+        const MapObject *obj = objects[i];
+        ElevationRamp *r = &ramps->ramps[ramps->count++];
+        r->rect = (Rectangle){ (float)obj->x, (float)obj->y, (float)obj->width, (float)obj->height };
+        r->from_elevation = obj->from_elevation;
+        r->to_elevation = obj->to_elevation;
     }
     return ramps->count;
 }
@@ -148,14 +566,13 @@ int collision_load_ramps_from_tilemap(ElevationRampSet *ramps, TileMap *tilemap,
 void collision_debug_draw(CollisionWorld *world) {
     if (!world || !world->debug_draw) return;
     for (int i = 0; i < world->body_count; i++) {
-        CollisionBody *b = &world->bodies[i];
-        if (!b->active) continue;
+        if (!(world->flags[i] & BODY_ACTIVE)) continue;
         Color c;
-        if (b->elevation == 0) {
-            c = (b->type == BODY_STATIC) ? RED : GREEN;
+        if (world->elevations[i] == 0) {
+            c = (world->types[i] == BODY_STATIC) ? RED : GREEN;
         } else {
-            c = (b->type == BODY_STATIC) ? BLUE : SKYBLUE;
+            c = (world->types[i] == BODY_STATIC) ? BLUE : SKYBLUE;
         }
-        DrawRectangleLinesEx(b->rect, 1.0f, c);
+        DrawRectangleLinesEx(world->rects[i], 1.0f, c);
     }
 }
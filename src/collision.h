@@ -3,8 +3,23 @@
 
 #include "raylib.h"
 #include <stdbool.h>
+#include <stdint.h>
 
-#define COLLISION_MAX_BODIES 256
+// Broadphase cell size in pixels: a body is listed in every cell its rect
+// touches, per elevation
+#define COLLISION_GRID_CELL 64
+
+// A body handle packs a handle slot (low bits) and that slot's generation
+// (high bits, never 0). Removing a body bumps the generation, so stale
+// handles are refused instead of reaching whatever reuses the slot.
+typedef uint32_t CollisionHandle;
+#define COLLISION_HANDLE_NONE 0
+#define COLLISION_HANDLE_SLOT_BITS 20
+#define COLLISION_MAX_HANDLES (1 << COLLISION_HANDLE_SLOT_BITS)
+
+// collision_compact() closes the holes of removed bodies once there are at
+// least this many and they make up a quarter of the storage
+#define COLLISION_COMPACT_MIN_HOLES 64
 
 typedef enum BodyType {
     BODY_STATIC,
@@ -19,19 +34,61 @@ typedef enum BodyTag {
     TAG_DOOR
 } BodyTag;
 
-typedef struct CollisionBody {
-    Rectangle rect;
-    BodyType type;
-    BodyTag tag;
-    bool active;
+// Body flags
+#define BODY_ACTIVE  0x01
+#define BODY_IN_GRID 0x02
+
+// The cells a body is listed in
+typedef struct CollisionGridSpan {
+    int x0, y0, x1, y1;
     int elevation;
-    void *user_data;
-} CollisionBody;
+} CollisionGridSpan;
+
+// Broadphase cell: the bodies whose rects touch it, at one elevation
+typedef struct CollisionCell {
+    int x, y, elevation;
+    bool used;              // cells are never removed, only emptied
+    int *bodies;
+    int count, capacity;
+} CollisionCell;
 
 typedef struct CollisionWorld {
-    CollisionBody bodies[COLLISION_MAX_BODIES];
-    int body_count;
+    // Bodies as parallel arrays, indexed by a dense body index. A removed
+    // body leaves a hole (flags 0) that the next added body fills;
+    // collision_compact() closes them when there are many. Dense indices
+    // change on compaction, handles don't.
+    int body_count;         // dense entries in use, live or holes
+    int live_count;
+    int body_capacity;
+    Rectangle *rects;
+    int *elevations;
+    BodyType *types;
+    BodyTag *tags;
+    uint8_t *flags;         // BODY_ACTIVE, BODY_IN_GRID
+    int *object_ids;        // map object the body was loaded from (0 = none)
+    void **user_data;
+    CollisionHandle *handles;
+    CollisionGridSpan *grid_spans;
+    unsigned *query_marks;  // last query that collected each body
+    int *holes;             // dense indices of removed bodies, reused first
+    int hole_count;
+
+    // Handle slots: dense index (-1 = free) and generation of each
+    int *slot_index;
+    uint32_t *slot_generation;
+    int slot_count, slot_capacity;
+    int *free_slots;
+    int free_slot_count;
+
     bool debug_draw;
+
+    // Spatial hash of (elevation, cell x, cell y), open-addressed
+    CollisionCell *cells;
+    int cell_mask;          // table size - 1 (0 = no table yet)
+    int cells_used;
+    unsigned query_mark;
+    int *candidates;        // scratch list for queries
+    int candidate_capacity;
 } CollisionWorld;
 
 typedef struct TileMap TileMap;
@@ -51,11 +108,36 @@ typedef struct ElevationRampSet {
 
 CollisionWorld *collision_create(void);
 void collision_destroy(CollisionWorld *world);
-int collision_add_body(CollisionWorld *world, Rectangle rect, BodyType type, BodyTag tag, int elevation, void *user_data);
-void collision_remove_body(CollisionWorld *world, int index);
+// Returns COLLISION_HANDLE_NONE if out of memory
+CollisionHandle collision_add_body(CollisionWorld *world, Rectangle rect, BodyType type, BodyTag tag, int elevation,
+                                   void *user_data);
+void collision_remove_body(CollisionWorld *world, CollisionHandle handle);
+// Dense index of a live body, or -1 for a stale or invalid handle. Valid
+// until the next collision_compact().
+int collision_body_index(const CollisionWorld *world, CollisionHandle handle);
+bool collision_body_valid(const CollisionWorld *world, CollisionHandle handle);
+Rectangle collision_body_rect(const CollisionWorld *world, CollisionHandle handle);
+int collision_body_elevation(const CollisionWorld *world, CollisionHandle handle);
+// Move a body or change its level; it is re-listed in the broadphase only
+// if the cells it covers changed
+void collision_set_body_rect(CollisionWorld *world, CollisionHandle handle, Rectangle rect);
+void collision_set_body_elevation(CollisionWorld *world, CollisionHandle handle, int elevation);
+// Close the holes left by removed bodies if there are enough of them,
+// keeping live bodies in order. Call between frames, never while holding
+// dense indices. Returns true if it compacted.
+bool collision_compact(CollisionWorld *world);
+// Active bodies of any type at `elevation` whose rects overlap `rect`, in
+// body order. Stores up to `capacity` handles in `out`, returns how many
+// there are.
+int collision_query_rect(CollisionWorld *world, Rectangle rect, int elevation, CollisionHandle *out, int capacity);
+// Static bodies for the non-ramp objects of every object layer named
+// `layer_name`. Returns the number of bodies added.
 int collision_load_from_tilemap(CollisionWorld *world, TileMap *tilemap, const char *layer_name);
+// After a map reload: update, remove or add only the bodies whose objects in
+// those layers changed, matched by object id. Returns the number of bodies touched.
+int collision_reload_from_tilemap(CollisionWorld *world, TileMap *tilemap, const char *layer_name);
 int collision_load_ramps_from_tilemap(ElevationRampSet *ramps, TileMap *tilemap, const char *layer_name);
-Vector2 collision_move_and_slide(CollisionWorld *world, int body_index, float dx, float dy);
+Vector2 collision_move_and_slide(CollisionWorld *world, CollisionHandle handle, float dx, float dy);
 void collision_debug_draw(CollisionWorld *world);
 
 #endif
@@ -1,10 +1,12 @@
 #include "game.h"
 #include "scene.h"
+#include "assets.h"
 #include "sprite.h"
 #include "event.h"
 #include "audio.h"
 #include "settings.h"
 #include "ui.h"
+#include "tilemap.h"
 #include <math.h>
 #include <stddef.h>
 #include <stdlib.h>
@@ -65,6 +67,10 @@ static void perform_transition(Game *game) {
         }
     }
 
+    // Scenes that load in the background show the loading screen until done
+    game->scene_loading = new_funcs->loading && new_funcs->loading(game);
+    if (game->scene_loading) game->transition_fade = 1.0f;
+
     // Notify listeners (audio etc.) about the scene change
     event_emit(game->events, (Event){
         .type = EVT_SCENE_ENTER,
@@ -74,6 +80,7 @@ static void perform_transition(Game *game) {
 
 void game_init(Game *game) {
     build_scene_table();
+    assets_init();
 
     // Clean up ALL scenes (for F6 reinit)
     for (int i = 0; i < SCENE_COUNT; i++) {
@@ -84,11 +91,13 @@ void game_init(Game *game) {
         game->scene_data[i] = NULL;
     }
 
-    // Clean up existing player sprite on reinit
-    if (game->player_sprite) {
-        sprite_destroy(game->player_sprite);
-        game->player_sprite = NULL;
-    }
+    // On reinit, the old sprite, icon and shaders are released only after the
+    // new ones are acquired, so the asset cache hands back the same resources
+    AnimatedSprite *old_sprite = game->player_sprite;
+    Texture2D old_icon = game->item_icon;
+    Shader old_daynight = game->daynight_shader;
+    Shader old_water = game->water_shader;
+    Shader old_reflection = game->reflection_shader;
 
     // Create fresh event bus (destroy old one on reinit)
     if (game->events) {
@@ -112,6 +121,7 @@ void game_init(Game *game) {
 
     // Global player sprite setup
     game->player_sprite = sprite_create("../assets/player.png", 16, 32);
+    sprite_destroy(old_sprite);
     sprite_add_animation(game->player_sprite, "walk_down",  0, 4, 0, 8.0f, true);
     sprite_add_animation(game->player_sprite, "walk_right", 4, 4, 0, 8.0f, true);
     sprite_add_animation(game->player_sprite, "walk_up",    8, 4, 0, 8.0f, true);
@@ -139,14 +149,14 @@ void game_init(Game *game) {
 
     // Inventory
     inventory_init(&game->inventory);
-    if (game->item_icon.id != 0) UnloadTexture(game->item_icon);
-    game->item_icon = LoadTexture("../assets/sack.png");
+    game->item_icon = assets_acquire_texture("../assets/sack.png");
+    assets_release_texture(old_icon);
 
     // Day/night cycle
     if (game->render_target.id != 0) UnloadRenderTexture(game->render_target);
-    if (game->daynight_shader.id != 0) UnloadShader(game->daynight_shader);
     game->render_target = LoadRenderTexture(GetScreenWidth(), GetScreenHeight());
-    game->daynight_shader = LoadShader(NULL, "../assets/daynight.fs");
+    game->daynight_shader = assets_acquire_shader(NULL, "../assets/daynight.fs");
+    assets_release_shader(old_daynight);
     game->daynight_time_loc = GetShaderLocation(game->daynight_shader, "time_of_day");
     game->light_pos_loc = GetShaderLocation(game->daynight_shader, "light_pos");
     game->light_radius_loc = GetShaderLocation(game->daynight_shader, "light_radius");
@@ -171,21 +181,28 @@ void game_init(Game *game) {
     game->cloud_speed_y = 2.0f + (float)(rand() % 5);     // 2-7 world units/sec
 
     // Water shader
-    if (game->water_shader.id != 0) UnloadShader(game->water_shader);
-    game->water_shader = LoadShader(NULL, "../assets/water.fs");
+    game->water_shader = assets_acquire_shader(NULL, "../assets/water.fs");
+    assets_release_shader(old_water);
     game->water_time_loc = GetShaderLocation(game->water_shader, "time");
     game->water_cam_target_loc = GetShaderLocation(game->water_shader, "camera_target");
     game->water_cam_offset_loc = GetShaderLocation(game->water_shader, "camera_offset");
     game->water_cam_zoom_loc = GetShaderLocation(game->water_shader, "camera_zoom");
     game->water_screen_size_loc = GetShaderLocation(game->water_shader, "screen_size");
+    // The tilemap's GPU layer renderer composes the same effect into its own
+    // shader for layers tagged "water"
+    char *water_source = LoadFileText("../assets/water.fs");
+    tilemap_set_gpu_effect("water", water_source);
+    UnloadFileText(water_source);
 
     // Reflection shader
-    if (game->reflection_shader.id != 0) UnloadShader(game->reflection_shader);
-    game->reflection_shader = LoadShader(NULL, "../assets/reflection.fs");
+    game->reflection_shader = assets_acquire_shader(NULL, "../assets/reflection.fs");
+    assets_release_shader(old_reflection);
     game->reflection_time_loc = GetShaderLocation(game->reflection_shader, "time");
 
     game->current_scene = SCENE_NONE;
     game->next_scene = SCENE_MENU;
+    game->scene_loading = false;
+    game->transition_fade = 0.0f;
     game->initialized = true;
 }
 
@@ -217,6 +234,18 @@ void game_update(Game *game) {
     game->daynight_active = (game->current_scene == SCENE_OVERWORLD ||
                               game->current_scene == SCENE_DUNGEON_1);
 
+    // Background scene load: poll it instead of updating the scene
+    if (game->scene_loading) {
+        game->scene_loading = scene_table[game->current_scene].loading(game);
+        event_flush(game->events);
+        audio_update(game->audio);
+        return;
+    }
+    if (game->transition_fade > 0.0f) {
+        game->transition_fade -= GetFrameTime() * 3.0f;
+        if (game->transition_fade < 0.0f) game->transition_fade = 0.0f;
+    }
+
     // ESC opens pause overlay (skip on menu and settings scenes)
     if (!ui_is_active(&game->ui) && IsKeyPressed(KEY_ESCAPE)
         && game->current_scene != SCENE_MENU
@@ -242,7 +271,22 @@ void game_update(Game *game) {
     audio_update(game->audio);
 }
 
+// Shown while the current scene loads in the background
+static void draw_loading_screen(void) {
+    ClearBackground(BLACK);
+    const char *text = "Loading";
+    int dots = (int)(GetTime() * 3.0) % 4;
+    int w = MeasureText("Loading...", 30);
+    DrawText(TextFormat("%s%.*s", text, dots, "..."),
+             (GetScreenWidth() - w) / 2, GetScreenHeight() / 2 - 15, 30, WHITE);
+}
+
 void game_draw(Game *game) {
+    if (game->scene_loading) {
+        draw_loading_screen();
+        return;
+    }
+
     if (game->daynight_active && game->current_scene >= 0 && game->current_scene < SCENE_COUNT) {
         // Draw scene into render texture, then post-process with shader
         BeginTextureMode(game->render_target);
@@ -293,6 +337,11 @@ void game_draw(Game *game) {
         ClearBackground(BLACK);
     }
 
+    // Fade in from the loading screen
+    if (game->transition_fade > 0.0f) {
+        DrawRectangle(0, 0, GetScreenWidth(), GetScreenHeight(), Fade(BLACK, game->transition_fade));
+    }
+
     // UI overlay always draws on top, unaffected by shader
     if (ui_is_active(&game->ui)) {
         ui_draw(&game->ui, game);
@@ -316,28 +365,21 @@ void game_cleanup(Game *game) {
     }
 
     // Clean up inventory icon (while GL context alive)
-    if (game->item_icon.id != 0) {
-        UnloadTexture(game->item_icon);
-        game->item_icon = (Texture2D){ 0 };
-    }
+    assets_release_texture(game->item_icon);
+    game->item_icon = (Texture2D){ 0 };
 
     // Clean up day/night resources (while GL context alive)
     if (game->render_target.id != 0) {
         UnloadRenderTexture(game->render_target);
         game->render_target = (RenderTexture2D){ 0 };
     }
-    if (game->daynight_shader.id != 0) {
-        UnloadShader(game->daynight_shader);
-        game->daynight_shader = (Shader){ 0 };
-    }
-    if (game->water_shader.id != 0) {
-        UnloadShader(game->water_shader);
-        game->water_shader = (Shader){ 0 };
-    }
-    if (game->reflection_shader.id != 0) {
-        UnloadShader(game->reflection_shader);
-        game->reflection_shader = (Shader){ 0 };
-    }
+    assets_release_shader(game->daynight_shader);
+    game->daynight_shader = (Shader){ 0 };
+    assets_release_shader(game->water_shader);
+    game->water_shader = (Shader){ 0 };
+    tilemap_set_gpu_effect("water", NULL);
+    assets_release_shader(game->reflection_shader);
+    game->reflection_shader = (Shader){ 0 };
 
     // Clean up audio (before event bus, while GL context alive)
     if (game->audio) {
@@ -350,4 +392,7 @@ void game_cleanup(Game *game) {
         event_bus_destroy(game->events);
         game->events = NULL;
     }
+
+    // Anything still cached is a leak; unload it while the GL context is alive
+    assets_shutdown();
 }
@@ -113,6 +113,8 @@ typedef struct Game {
     // Scene management
     SceneID current_scene;
     SceneID next_scene;
+    bool scene_loading;                // current scene's loading() still returns true
+    float transition_fade;             // 1 = black, fades out once loading finishes
     void *scene_data[SCENE_COUNT];
 } Game;
 
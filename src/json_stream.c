@@ -0,0 +1,226 @@
+#include "json_stream.h"
+#include <string.h>
+
+static void skip_ws(JsonStream *js) {
+    while (js->cur < js->end) {
+        char c = *js->cur;
+        if (c != ' ' && c != '\n' && c != '\r' && c != '\t') break;
+        js->cur++;
+    }
+}
+
+static bool fail(JsonStream *js) {
+    js->error = true;
+    return false;
+}
+
+// Consume `c` (after whitespace) if it is next
+static bool accept(JsonStream *js, char c) {
+    skip_ws(js);
+    if (js->cur < js->end && *js->cur == c) {
+        js->cur++;
+        return true;
+    }
+    return false;
+}
+
+void json_stream_init(JsonStream *js, const char *text, size_t length) {
+    js->cur = text;
+    js->end = text + length;
+    js->error = false;
+
+    // Skip a UTF-8 BOM
+    if (length >= 3 && (unsigned char)text[0] == 0xEF &&
+        (unsigned char)text[1] == 0xBB && (unsigned char)text[2] == 0xBF) {
+        js->cur += 3;
+    }
+}
+
+char json_stream_peek(JsonStream *js) {
+    if (js->error) return '\0';
+    skip_ws(js);
+    return js->cur < js->end ? *js->cur : '\0';
+}
+
+bool json_stream_begin_object(JsonStream *js) {
+    if (js->error) return false;
+    return accept(js, '{') || fail(js);
+}
+
+bool json_stream_begin_array(JsonStream *js) {
+    if (js->error) return false;
+    return accept(js, '[') || fail(js);
+}
+
+// Shared by objects and arrays: after an opening bracket or a value, either
+// the closing bracket (returns false) or a separating comma follows. The
+// first element has no comma, which is detected by looking one char back.
+static bool next_member(JsonStream *js, char close, char open) {
+    if (js->error) return false;
+    if (accept(js, close)) return false;
+
+    const char *p = js->cur - 1;
+    while (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t') p--;
+    if (*p == open) return true;
+    return accept(js, ',') || fail(js);
+}
+
+bool json_stream_next_key(JsonStream *js, char *key, size_t key_size) {
+    if (!next_member(js, '}', '{')) return false;
+    if (!accept(js, '"')) return fail(js);
+
+    size_t len = 0;
+    while (js->cur < js->end && *js->cur != '"') {
+        char c = *js->cur++;
+        if (c == '\\' && js->cur < js->end) c = *js->cur++;   // keys are plain ASCII in practice
+        if (len + 1 < key_size) key[len++] = c;
+    }
+    if (js->cur >= js->end) return fail(js);
+    js->cur++;   // closing quote
+    key[len] = '\0';
+
+    return accept(js, ':') || fail(js);
+}
+
+bool json_stream_next_element(JsonStream *js) {
+    return next_member(js, ']', '[');
+}
+
+static bool skip_string(JsonStream *js) {
+    js->cur++;   // opening quote
+    while (js->cur < js->end) {
+        char c = *js->cur++;
+        if (c == '\\') {
+            js->cur++;
+        } else if (c == '"') {
+            return true;
+        }
+    }
+    return fail(js);
+}
+
+bool json_stream_skip_value(JsonStream *js) {
+    if (js->error) return false;
+    skip_ws(js);
+    if (js->cur >= js->end) return fail(js);
+
+    char c = *js->cur;
+    if (c == '"') return skip_string(js);
+
+    if (c == '{' || c == '[') {
+        // Bracket matching; strings may contain brackets so they are skipped whole
+        int depth = 0;
+        while (js->cur < js->end) {
+            c = *js->cur;
+            if (c == '"') {
+                if (!skip_string(js)) return false;
+                continue;
+            }
+            js->cur++;
+            if (c == '{' || c == '[') depth++;
+            else if ((c == '}' || c == ']') && --depth == 0) return true;
+        }
+        return fail(js);
+    }
+
+    // Scalar: number, true, false, null
+    const char *start = js->cur;
+    while (js->cur < js->end) {
+        c = *js->cur;
+        if (c == ',' || c == '}' || c == ']' || c == ' ' || c == '\n' || c == '\r' || c == '\t') break;
+        js->cur++;
+    }
+    return js->cur > start || fail(js);
+}
+
+cJSON *json_stream_parse_value(JsonStream *js) {
+    if (js->error) return NULL;
+    skip_ws(js);
+
+    const char *parse_end = NULL;
+    cJSON *value = cJSON_ParseWithLengthOpts(js->cur, (size_t)(js->end - js->cur), &parse_end, false);
+    if (!value) {
+        fail(js);
+        return NULL;
+    }
+    js->cur = parse_end;
+    return value;
+}
+
+int json_stream_count_flat_array(JsonStream *js) {
+    if (json_stream_peek(js) != '[') return -1;
+
+    const char *close = memchr(js->cur, ']', (size_t)(js->end - js->cur));
+    if (!close) return -1;
+
+    int commas = 0;
+    bool any = false;
+    for (const char *p = js->cur + 1; p < close; p++) {
+        char c = *p;
+        if (c == ',') commas++;
+        else if (c != ' ' && c != '\n' && c != '\r' && c != '\t') any = true;
+    }
+    return any ? commas + 1 : 0;
+}
+
+bool json_stream_skip_flat_array(JsonStream *js) {
+    if (json_stream_peek(js) != '[') return fail(js);
+    const char *close = memchr(js->cur, ']', (size_t)(js->end - js->cur));
+    if (!close) return fail(js);
+    js->cur = close + 1;
+    return true;
+}
+
+int json_stream_read_uint32_array(JsonStream *js, uint32_t *out, int capacity) {
+    if (!json_stream_begin_array(js)) return -1;
+
+    const char *p = js->cur;
+    const char *end = js->end;
+    int count = 0;
+
+    for (;;) {
+        while (p < end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')) p++;
+        if (p >= end) break;
+        if (*p == ']' && count == 0) {
+            js->cur = p + 1;
+            return 0;
+        }
+
+        if (*p < '0' || *p > '9' || count >= capacity) break;
+        uint64_t value = 0;
+        while (p < end && *p >= '0' && *p <= '9') {
+            value = value * 10 + (uint64_t)(*p - '0');
+            p++;
+        }
+        if (value > UINT32_MAX) break;
+        out[count++] = (uint32_t)value;
+
+        while (p < end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')) p++;
+        if (p >= end) break;
+        if (*p == ',') {
+            p++;
+        } else if (*p == ']') {
+            js->cur = p + 1;
+            return count;
+        } else {
+            break;
+        }
+    }
+
+    js->cur = p;
+    js->error = true;
+    return -1;
+}
+
+void json_fix_backslashes(char *text, size_t length) {
+    for (char *p = text; p + 1 < text + length; p++) {
+        if (*p == '\\') {
+            char next = *(p + 1);
+            if (next != '"' && next != '\\' && next != '/' &&
+                next != 'b' && next != 'f' && next != 'n' &&
+                next != 'r' && next != 't' && next != 'u') {
+                *p = '/';
+            }
+        }
+    }
+}
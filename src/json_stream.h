@@ -0,0 +1,55 @@
+#ifndef JSON_STREAM_H
+#define JSON_STREAM_H
+
+#include "cJSON.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Forward-only JSON reader over an in-memory buffer. Large flat number arrays
+// (Tiled layer "data") are read straight into caller arrays; any other value
+// can be skipped or handed to cJSON as a small DOM fragment. Once an error
+// is hit every call fails and `error` stays set.
+
+typedef struct JsonStream {
+    const char *cur;
+    const char *end;
+    bool error;
+} JsonStream;
+
+void json_stream_init(JsonStream *js, const char *text, size_t length);
+
+// Next significant character without consuming it ('\0' at end of input)
+char json_stream_peek(JsonStream *js);
+
+// Objects: call begin, then next_key until it returns false (closing '}' consumed).
+// After each key the caller must consume the value (skip, parse, or read).
+bool json_stream_begin_object(JsonStream *js);
+bool json_stream_next_key(JsonStream *js, char *key, size_t key_size);
+
+// Arrays: call begin, then next_element until it returns false (closing ']' consumed)
+bool json_stream_begin_array(JsonStream *js);
+bool json_stream_next_element(JsonStream *js);
+
+bool json_stream_skip_value(JsonStream *js);
+
+// Parse the next value into a standalone cJSON tree (caller deletes it)
+cJSON *json_stream_parse_value(JsonStream *js);
+
+// Upper bound on the element count of the flat array that starts at the
+// cursor, found by counting commas without parsing. -1 if not an array.
+int json_stream_count_flat_array(JsonStream *js);
+
+// Skip the flat array at the cursor (no nested arrays or strings holding
+// ']') with a single memchr
+bool json_stream_skip_flat_array(JsonStream *js);
+
+// Read a flat array of non-negative integers into `out`. Returns the number
+// of elements read, or -1 on malformed input or more than `capacity` values.
+int json_stream_read_uint32_array(JsonStream *js, uint32_t *out, int capacity);
+
+// Turn the unescaped backslashes Tiled writes into Windows paths into '/' so
+// the first `length` bytes of `text` parse as JSON (done in place)
+void json_fix_backslashes(char *text, size_t length);
+
+#endif
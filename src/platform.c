@@ -0,0 +1,341 @@
+#include "platform.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+bool platform_map_file(const char *path, MappedFile *out) {
+    memset(out, 0, sizeof(*out));
+
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+    CloseHandle(file);
+    if (!mapping) return false;
+
+    void *view = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+    if (!view) {
+        CloseHandle(mapping);
+        return false;
+    }
+
+    out->data = view;
+    out->size = (size_t)size.QuadPart;
+    out->handle = mapping;
+    return true;
+}
+
+void platform_unmap_file(MappedFile *file) {
+    if (!file || !file->data) return;
+    UnmapViewOfFile(file->data);
+    CloseHandle((HANDLE)file->handle);
+    memset(file, 0, sizeof(*file));
+}
+
+double platform_time_seconds(void) {
+    static LARGE_INTEGER freq;
+    if (freq.QuadPart == 0) QueryPerformanceFrequency(&freq);
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    return (double)now.QuadPart / (double)freq.QuadPart;
+}
+
+int platform_cpu_count(void) {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (int)info.dwNumberOfProcessors : 1;
+}
+
+struct PlatformThread {
+    HANDLE handle;
+    PlatformThreadFunc func;
+    void *arg;
+};
+
+static DWORD WINAPI thread_main(LPVOID param) {
+    PlatformThread *thread = (PlatformThread *)param;
+    thread->func(thread->arg);
+    return 0;
+}
+
+PlatformThread *platform_thread_start(PlatformThreadFunc func, void *arg) {
+    PlatformThread *thread = (PlatformThread *)calloc(1, sizeof(PlatformThread));
+    if (!thread) return NULL;
+    thread->func = func;
+    thread->arg = arg;
+    thread->handle = CreateThread(NULL, 0, thread_main, thread, 0, NULL);
+    if (!thread->handle) {
+        free(thread);
+        return NULL;
+    }
+    return thread;
+}
+
+void platform_thread_join(PlatformThread *thread) {
+    if (!thread) return;
+    WaitForSingleObject(thread->handle, INFINITE);
+    CloseHandle(thread->handle);
+    free(thread);
+}
+
+struct PlatformMutex {
+    CRITICAL_SECTION cs;
+};
+
+PlatformMutex *platform_mutex_create(void) {
+    PlatformMutex *mutex = (PlatformMutex *)calloc(1, sizeof(PlatformMutex));
+    if (mutex) InitializeCriticalSection(&mutex->cs);
+    return mutex;
+}
+
+void platform_mutex_destroy(PlatformMutex *mutex) {
+    if (!mutex) return;
+    DeleteCriticalSection(&mutex->cs);
+    free(mutex);
+}
+
+void platform_mutex_lock(PlatformMutex *mutex) {
+    EnterCriticalSection(&mutex->cs);
+}
+
+void platform_mutex_unlock(PlatformMutex *mutex) {
+    LeaveCriticalSection(&mutex->cs);
+}
+
+struct PlatformWatch {
+    char paths[PLATFORM_WATCH_MAX_FILES][512];
+    FILETIME stamps[PLATFORM_WATCH_MAX_FILES];
+    int count;
+};
+
+// Zero if the file doesn't exist (yet)
+static FILETIME last_write_time(const char *path) {
+    WIN32_FILE_ATTRIBUTE_DATA info;
+    if (!GetFileAttributesExA(path, GetFileExInfoStandard, &info)) return (FILETIME){ 0 };
+    return info.ftLastWriteTime;
+}
+
+PlatformWatch *platform_watch_create(void) {
+    return (PlatformWatch *)calloc(1, sizeof(PlatformWatch));
+}
+
+void platform_watch_destroy(PlatformWatch *watch) {
+    free(watch);
+}
+
+bool platform_watch_add(PlatformWatch *watch, const char *path) {
+    if (!watch || watch->count >= PLATFORM_WATCH_MAX_FILES || strlen(path) >= sizeof(watch->paths[0])) return false;
+    strcpy(watch->paths[watch->count], path);
+    watch->stamps[watch->count++] = last_write_time(path);
+    return true;
+}
+
+void platform_watch_clear(PlatformWatch *watch) {
+    if (watch) watch->count = 0;
+}
+
+bool platform_watch_changed(PlatformWatch *watch) {
+    if (!watch) return false;
+    bool changed = false;
+    for (int i = 0; i < watch->count; i++) {
+        FILETIME stamp = last_write_time(watch->paths[i]);
+        if (CompareFileTime(&stamp, &watch->stamps[i]) != 0) {
+            watch->stamps[i] = stamp;
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+#else
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/inotify.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+bool platform_map_file(const char *path, MappedFile *out) {
+    memset(out, 0, sizeof(*out));
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return false;
+    }
+
+    void *view = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (view == MAP_FAILED) return false;
+
+    out->data = view;
+    out->size = (size_t)st.st_size;
+    return true;
+}
+
+void platform_unmap_file(MappedFile *file) {
+    if (!file || !file->data) return;
+    munmap(file->data, file->size);
+    memset(file, 0, sizeof(*file));
+}
+
+double platform_time_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+int platform_cpu_count(void) {
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (int)count : 1;
+}
+
+struct PlatformThread {
+    pthread_t handle;
+    PlatformThreadFunc func;
+    void *arg;
+};
+
+static void *thread_main(void *param) {
+    PlatformThread *thread = (PlatformThread *)param;
+    thread->func(thread->arg);
+    return NULL;
+}
+
+PlatformThread *platform_thread_start(PlatformThreadFunc func, void *arg) {
+    PlatformThread *thread = (PlatformThread *)calloc(1, sizeof(PlatformThread));
+    if (!thread) return NULL;
+    thread->func = func;
+    thread->arg = arg;
+    if (pthread_create(&thread->handle, NULL, thread_main, thread) != 0) {
+        free(thread);
+        return NULL;
+    }
+    return thread;
+}
+
+void platform_thread_join(PlatformThread *thread) {
+    if (!thread) return;
+    pthread_join(thread->handle, NULL);
+    free(thread);
+}
+
+struct PlatformMutex {
+    pthread_mutex_t handle;
+};
+
+PlatformMutex *platform_mutex_create(void) {
+    PlatformMutex *mutex = (PlatformMutex *)calloc(1, sizeof(PlatformMutex));
+    if (mutex && pthread_mutex_init(&mutex->handle, NULL) != 0) {
+        free(mutex);
+        return NULL;
+    }
+    return mutex;
+}
+
+void platform_mutex_destroy(PlatformMutex *mutex) {
+    if (!mutex) return;
+    pthread_mutex_destroy(&mutex->handle);
+    free(mutex);
+}
+
+void platform_mutex_lock(PlatformMutex *mutex) {
+    pthread_mutex_lock(&mutex->handle);
+}
+
+void platform_mutex_unlock(PlatformMutex *mutex) {
+    pthread_mutex_unlock(&mutex->handle);
+}
+
+struct PlatformWatch {
+    int fd;                   // inotify instance, non-blocking
+    char names[PLATFORM_WATCH_MAX_FILES][256];
+    int dirs[PLATFORM_WATCH_MAX_FILES];   // watch descriptor of each file's directory
+    int count;
+};
+
+PlatformWatch *platform_watch_create(void) {
+    PlatformWatch *watch = (PlatformWatch *)calloc(1, sizeof(PlatformWatch));
+    if (!watch) return NULL;
+    watch->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (watch->fd < 0) {
+        free(watch);
+        return NULL;
+    }
+    return watch;
+}
+
+void platform_watch_destroy(PlatformWatch *watch) {
+    if (!watch) return;
+    close(watch->fd);
+    free(watch);
+}
+
+bool platform_watch_add(PlatformWatch *watch, const char *path) {
+    if (!watch || watch->count >= PLATFORM_WATCH_MAX_FILES) return false;
+    const char *slash = strrchr(path, '/');
+    const char *name = slash ? slash + 1 : path;
+    char dir[512];
+    size_t dir_length = slash ? (size_t)(slash - path) : 0;
+    if (dir_length >= sizeof(dir) || strlen(name) >= sizeof(watch->names[0])) return false;
+    if (slash) {
+        memcpy(dir, path, dir_length);
+        dir[dir_length] = '\0';
+        if (dir_length == 0) strcpy(dir, "/");
+    } else {
+        strcpy(dir, ".");
+    }
+    // Watching a directory twice returns the same descriptor
+    int wd = inotify_add_watch(watch->fd, dir, IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+    if (wd < 0) return false;
+    strcpy(watch->names[watch->count], name);
+    watch->dirs[watch->count++] = wd;
+    return true;
+}
+
+void platform_watch_clear(PlatformWatch *watch) {
+    if (!watch) return;
+    for (int i = 0; i < watch->count; i++) {
+        bool removed = false;
+        for (int j = 0; j < i; j++) removed |= watch->dirs[j] == watch->dirs[i];
+        if (!removed) inotify_rm_watch(watch->fd, watch->dirs[i]);
+    }
+    watch->count = 0;
+}
+
+bool platform_watch_changed(PlatformWatch *watch) {
+    if (!watch) return false;
+    bool changed = false;
+    char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    ssize_t length;
+    while ((length = read(watch->fd, buffer, sizeof(buffer))) > 0) {
+        for (char *p = buffer; p < buffer + length;) {
+            const struct inotify_event *event = (const struct inotify_event *)p;
+            // Dropped events may have been ours
+            if (event->mask & IN_Q_OVERFLOW) changed = true;
+            for (int i = 0; event->len > 0 && i < watch->count; i++) {
+                if (watch->dirs[i] == event->wd && strcmp(watch->names[i], event->name) == 0) changed = true;
+            }
+            p += sizeof(struct inotify_event) + event->len;
+        }
+    }
+    return changed;
+}
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef PLATFORM_H
+#define PLATFORM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Thin OS layer for things raylib doesn't provide. Kept in its own
+// translation unit so <windows.h> never meets raylib.h.
+
+typedef struct MappedFile {
+    void *data;
+    size_t size;
+    void *handle;     // Windows mapping handle (unused on POSIX)
+} MappedFile;
+
+// Map a whole file copy-on-write: pages are shared with the page cache until
+// written, and writes never reach the file on disk.
+bool platform_map_file(const char *path, MappedFile *out);
+void platform_unmap_file(MappedFile *file);
+
+// Monotonic high-resolution clock in seconds; usable before InitWindow()
+double platform_time_seconds(void);
+
+// Logical processors currently online (at least 1)
+int platform_cpu_count(void);
+
+// Worker threads (Win32 threads / pthreads)
+typedef struct PlatformThread PlatformThread;
+typedef void (*PlatformThreadFunc)(void *arg);
+
+// Returns NULL if the thread could not be created
+PlatformThread *platform_thread_start(PlatformThreadFunc func, void *arg);
+// Wait for the thread to exit and free the handle
+void platform_thread_join(PlatformThread *thread);
+
+typedef struct PlatformMutex PlatformMutex;
+PlatformMutex *platform_mutex_create(void);
+void platform_mutex_destroy(PlatformMutex *mutex);
+void platform_mutex_lock(PlatformMutex *mutex);
+void platform_mutex_unlock(PlatformMutex *mutex);
+
+// File change notification, polled without blocking: inotify on Linux (one
+// watch per directory, so files an editor replaces by renaming over them are
+// still seen), last-write-time polling on Windows
+#define PLATFORM_WATCH_MAX_FILES 64
+
+typedef struct PlatformWatch PlatformWatch;
+PlatformWatch *platform_watch_create(void);
+void platform_watch_destroy(PlatformWatch *watch);
+// False if the watch is full or the file's directory can't be watched
+bool platform_watch_add(PlatformWatch *watch, const char *path);
+// Stop watching every file
+void platform_watch_clear(PlatformWatch *watch);
+// True if a watched file was written, created or replaced since the last call
+bool platform_watch_changed(PlatformWatch *watch);
+
+#endif
@@ -8,12 +8,16 @@ typedef void (*SceneInitFunc)(Game *game);
 typedef void (*SceneCleanupFunc)(Game *game);
 typedef void (*SceneUpdateFunc)(Game *game);
 typedef void (*SceneDrawFunc)(Game *game);
+// Optional: polled every frame after init while it returns true (assets still
+// loading in the background). Update/draw are not called until it is done.
+typedef bool (*SceneLoadingFunc)(Game *game);
 
 typedef struct SceneFuncs {
     SceneInitFunc init;
     SceneCleanupFunc cleanup;
     SceneUpdateFunc update;
     SceneDrawFunc draw;
+    SceneLoadingFunc loading;
     bool persistent;
 } SceneFuncs;
 
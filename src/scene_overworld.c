@@ -6,16 +6,22 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <math.h>
-#include <string.h>
+
+#define OVERWORLD_MAP_PATH "../assets/overworld.tmj"
 
 typedef struct OverworldData {
+    TileMapLoad *map_load;  // pending background load (NULL once finished)
     TileMap *tilemap;
+    TileMapWatch *map_watch;  // hot reload of the map and its tilesets
     CollisionWorld *collision_world;
-    int player_body;
+    CollisionHandle player_body;
     float pos_x, pos_y;
     ElevationRampSet ramps;
     int player_elevation;
     int last_ramp;          // index of ramp that last fired (-1 = none)
+    RenderLayer *layer_pass;  // render pass of each tile layer, resolved at setup
+    int water_shader;       // interned "water" shader name (-1 = not used)
+    bool show_minimap;
 } OverworldData;
 
 static void overworld_init(Game *game) {
@@ -25,8 +31,29 @@ static void overworld_init(Game *game) {
     // Reset player HP to full when entering overworld
     game->player_hp = game->player_max_hp;
 
-    data->tilemap = tilemap_load("../assets/overworld.tmj");
+    // The rest of the setup runs in overworld_loading() once the map is in
+    tilemap_set_flatten_layers(true);
+    data->map_load = tilemap_load_async(OVERWORLD_MAP_PATH);
+}
+
+// Resolve the layers' interned render_layer/shader strings once per map
+// (again after a hot reload), so drawing only compares ints
+static void overworld_resolve_layers(OverworldData *data) {
+    free(data->layer_pass);
+    data->layer_pass = NULL;
+    data->water_shader = -1;
+    if (data->tilemap && data->tilemap->loaded) {
+        TileMap *map = data->tilemap;
+        data->water_shader = tilemap_string_id(map, "water");
+        data->layer_pass = calloc(map->tile_layer_count > 0 ? map->tile_layer_count : 1, sizeof(RenderLayer));
+        for (int i = 0; data->layer_pass && i < map->tile_layer_count; i++) {
+            data->layer_pass[i] = render_layer_from_name(tilemap_string(map, map->tile_layers[i].render_layer));
+        }
+    }
+}
 
+// Map-dependent setup, after the background load finished
+static void overworld_setup(Game *game, OverworldData *data) {
     // Player start position (from Tiled marker, fallback to center of map)
     data->pos_x = 400.0f;
     data->pos_y = 300.0f;
@@ -36,11 +63,13 @@ static void overworld_init(Game *game) {
             data->pos_x = (float)spawn->x;
             data->pos_y = (float)spawn->y;
         } else {
-            data->pos_x = (data->tilemap->width * data->tilemap->tilewidth) / 2.0f;
-            data->pos_y = (data->tilemap->height * data->tilemap->tileheight) / 2.0f;
+            data->pos_x = (data->tilemap->startx + data->tilemap->width / 2.0f) * data->tilemap->tilewidth;
+            data->pos_y = (data->tilemap->starty + data->tilemap->height / 2.0f) * data->tilemap->tileheight;
         }
     }
 
+    overworld_resolve_layers(data);
+
     // Collision setup
     data->collision_world = collision_create();
     if (data->tilemap && data->tilemap->loaded) {
@@ -55,24 +84,44 @@ static void overworld_init(Game *game) {
     );
     if (data->tilemap && data->tilemap->loaded) {
         collision_load_ramps_from_tilemap(&data->ramps, data->tilemap, "objects_collision");
+        data->map_watch = tilemap_watch(data->tilemap, OVERWORLD_MAP_PATH);
     }
 
     // Point camera at player
     game->camera.target = (Vector2){ data->pos_x, data->pos_y };
     game->camera.offset = (Vector2){ GetScreenWidth() / 2.0f, GetScreenHeight() / 2.0f };
+    tilemap_stream_chunks(data->tilemap, game->camera);
     // BGM is now triggered by EVT_SCENE_ENTER event
 }
 
+static bool overworld_loading(Game *game) {
+    OverworldData *data = game->scene_data[SCENE_OVERWORLD];
+    if (!data || data->collision_world) return false;   // already set up
+
+    if (data->map_load) {
+        if (!tilemap_load_poll(data->map_load)) return true;
+        data->tilemap = tilemap_load_finish(data->map_load);
+        data->map_load = NULL;
+    }
+    overworld_setup(game, data);
+    return false;
+}
+
 static void overworld_cleanup(Game *game) {
     OverworldData *data = game->scene_data[SCENE_OVERWORLD];
     if (!data) return;
 
+    if (data->map_load) {
+        tilemap_load_cancel(data->map_load);
+    }
+    tilemap_watch_stop(data->map_watch);
     if (data->tilemap) {
         tilemap_unload(data->tilemap);
     }
     if (data->collision_world) {
         collision_destroy(data->collision_world);
     }
+    free(data->layer_pass);
     free(data);
     game->scene_data[SCENE_OVERWORLD] = NULL;
 }
@@ -81,6 +130,18 @@ static void overworld_update(Game *game) {
     OverworldData *data = game->scene_data[SCENE_OVERWORLD];
     if (!data) return;
 
+    // Pick up map edits saved from Tiled: only the changed walls are rebuilt
+    TileMapReload reload;
+    if (tilemap_watch_poll(data->map_watch, &data->tilemap, &reload)) {
+        overworld_resolve_layers(data);
+        if (reload.flags & (TILEMAP_RELOAD_OBJECTS | TILEMAP_RELOAD_LAYOUT)) {
+            int bodies = collision_reload_from_tilemap(data->collision_world, data->tilemap, "objects_collision");
+            collision_load_ramps_from_tilemap(&data->ramps, data->tilemap, "objects_collision");
+            data->last_ramp = -1;   // ramp indices may have changed
+            printf("[overworld] Map reloaded: %d collision bodies updated\n", bodies);
+        }
+    }
+
     // Advance tile animations
     tilemap_update(data->tilemap, GetFrameTime());
 
@@ -89,6 +150,11 @@ static void overworld_update(Game *game) {
         data->collision_world->debug_draw = !data->collision_world->debug_draw;
     }
 
+    // Toggle minimap
+    if (IsKeyPressed(KEY_M)) {
+        data->show_minimap = !data->show_minimap;
+    }
+
     // Scene transition: press 1 to enter dungeon
     if (IsKeyPressed(KEY_ONE)) {
         game->next_scene = SCENE_DUNGEON_1;
@@ -130,28 +196,30 @@ static void overworld_update(Game *game) {
     sprite_update(game->player_sprite, GetFrameTime());
 
     // Move with collision
-    collision_move_and_slide(data->collision_world, data->player_body, dx, dy);
-    CollisionBody *pbody = &data->collision_world->bodies[data->player_body];
-    data->pos_x = pbody->rect.x;
-    data->pos_y = pbody->rect.y;
+    Vector2 moved = collision_move_and_slide(data->collision_world, data->player_body, dx, dy);
+    data->pos_x = moved.x;
+    data->pos_y = moved.y;
 
     // Clamp player to map bounds
     if (data->tilemap && data->tilemap->loaded) {
+        float map_x = (float)(data->tilemap->startx * data->tilemap->tilewidth);
+        float map_y = (float)(data->tilemap->starty * data->tilemap->tileheight);
         float map_w = (float)(data->tilemap->width * data->tilemap->tilewidth);
         float map_h = (float)(data->tilemap->height * data->tilemap->tileheight);
-        if (data->pos_x < 0) data->pos_x = 0;
-        if (data->pos_y < 0) data->pos_y = 0;
-        if (data->pos_x > map_w - 16) data->pos_x = map_w - 16;
-        if (data->pos_y > map_h - 16) data->pos_y = map_h - 16;
-        pbody->rect.x = data->pos_x;
-        pbody->rect.y = data->pos_y;
+        if (data->pos_x < map_x) data->pos_x = map_x;
+        if (data->pos_y < map_y) data->pos_y = map_y;
+        if (data->pos_x > map_x + map_w - 16) data->pos_x = map_x + map_w - 16;
+        if (data->pos_y > map_y + map_h - 16) data->pos_y = map_y + map_h - 16;
+        collision_set_body_rect(data->collision_world, data->player_body,
+                                (Rectangle){ data->pos_x, data->pos_y, 16, 16 });
     }
+    Rectangle player_rect = collision_body_rect(data->collision_world, data->player_body);
 
     // Check ramp overlaps for elevation transitions
     // Suppress re-triggering until the player leaves the ramp that last fired
     if (data->last_ramp >= 0) {
         ElevationRamp *lr = &data->ramps.ramps[data->last_ramp];
-        if (!CheckCollisionRecs(pbody->rect, lr->rect)) {
+        if (!CheckCollisionRecs(player_rect, lr->rect)) {
             data->last_ramp = -1;
         }
     }
@@ -159,9 +227,9 @@ static void overworld_update(Game *game) {
         for (int i = 0; i < data->ramps.count; i++) {
             ElevationRamp *ramp = &data->ramps.ramps[i];
             if (data->player_elevation != ramp->from_elevation) continue;
-            if (CheckCollisionRecs(pbody->rect, ramp->rect)) {
+            if (CheckCollisionRecs(player_rect, ramp->rect)) {
                 data->player_elevation = ramp->to_elevation;
-                pbody->elevation = ramp->to_elevation;
+                collision_set_body_elevation(data->collision_world, data->player_body, ramp->to_elevation);
                 data->last_ramp = i;
                 break;
             }
@@ -171,6 +239,42 @@ static void overworld_update(Game *game) {
     // Camera follows player
     game->camera.target = (Vector2){ data->pos_x + 8, data->pos_y + 8 };
     game->camera.offset = (Vector2){ GetScreenWidth() / 2.0f, GetScreenHeight() / 2.0f };
+
+    // Tell the tilemap the pass each layer draws in (see overworld_draw), so
+    // tiles under opaque tiles drawn later are culled. Layers above the
+    // player draw tinted see-through, so they hide nothing.
+    if (data->tilemap && data->layer_pass) {
+        for (int i = 0; i < data->tilemap->tile_layer_count; i++) {
+            bool elevated = data->tilemap->tile_layers[i].elevation > data->player_elevation;
+            tilemap_set_layer_pass(data->tilemap, i, elevated ? RENDER_LAYER_ABOVE_PLAYER : (int)data->layer_pass[i],
+                                   !elevated);
+        }
+    }
+
+    // Keep the chunks around the camera resident (infinite maps only), then
+    // bake the static tiles in view into cached chunk textures
+    tilemap_stream_chunks(data->tilemap, game->camera);
+    tilemap_bake_chunks(data->tilemap, game->camera);
+}
+
+// Feed the water effect's uniforms to `shader` (the water shader itself or a
+// GPU layer shader compiled with the water effect)
+static void set_water_uniforms(Game *game, Shader shader) {
+    float t = (float)GetTime();
+    float screen_size[2] = { (float)GetScreenWidth(), (float)GetScreenHeight() };
+    if (shader.id == game->water_shader.id) {
+        SetShaderValue(shader, game->water_time_loc, &t, SHADER_UNIFORM_FLOAT);
+        SetShaderValue(shader, game->water_cam_target_loc, &game->camera.target, SHADER_UNIFORM_VEC2);
+        SetShaderValue(shader, game->water_cam_offset_loc, &game->camera.offset, SHADER_UNIFORM_VEC2);
+        SetShaderValue(shader, game->water_cam_zoom_loc, &game->camera.zoom, SHADER_UNIFORM_FLOAT);
+        SetShaderValue(shader, game->water_screen_size_loc, screen_size, SHADER_UNIFORM_VEC2);
+        return;
+    }
+    SetShaderValue(shader, GetShaderLocation(shader, "time"), &t, SHADER_UNIFORM_FLOAT);
+    SetShaderValue(shader, GetShaderLocation(shader, "camera_target"), &game->camera.target, SHADER_UNIFORM_VEC2);
+    SetShaderValue(shader, GetShaderLocation(shader, "camera_offset"), &game->camera.offset, SHADER_UNIFORM_VEC2);
+    SetShaderValue(shader, GetShaderLocation(shader, "camera_zoom"), &game->camera.zoom, SHADER_UNIFORM_FLOAT);
+    SetShaderValue(shader, GetShaderLocation(shader, "screen_size"), screen_size, SHADER_UNIFORM_VEC2);
 }
 
 static void overworld_draw(Game *game) {
@@ -187,7 +291,8 @@ static void overworld_draw(Game *game) {
         if (data->tilemap && data->tilemap->loaded) {
             for (int i = 0; i < data->tilemap->tile_layer_count; i++) {
                 TileLayer *layer = &data->tilemap->tile_layers[i];
-                RenderLayer layer_rl = render_layer_from_name(layer->render_layer);
+                RenderLayer layer_rl = data->layer_pass ? data->layer_pass[i] : RENDER_LAYER_GROUND;
+                bool water = layer->shader == data->water_shader;
 
                 // Determine if this layer draws in the current render pass
                 bool should_draw = false;
@@ -204,14 +309,12 @@ static void overworld_draw(Game *game) {
 
                 // Activate per-layer shader if tagged
                 bool shader_active = false;
-                if (layer->shader_name[0] && strcmp(layer->shader_name, "water") == 0) {
-                    float t = (float)GetTime();
-                    float screen_size[2] = { (float)GetScreenWidth(), (float)GetScreenHeight() };
-                    SetShaderValue(game->water_shader, game->water_time_loc, &t, SHADER_UNIFORM_FLOAT);
-                    SetShaderValue(game->water_shader, game->water_cam_target_loc, &game->camera.target, SHADER_UNIFORM_VEC2);
-                    SetShaderValue(game->water_shader, game->water_cam_offset_loc, &game->camera.offset, SHADER_UNIFORM_VEC2);
-                    SetShaderValue(game->water_shader, game->water_cam_zoom_loc, &game->camera.zoom, SHADER_UNIFORM_FLOAT);
-                    SetShaderValue(game->water_shader, game->water_screen_size_loc, screen_size, SHADER_UNIFORM_VEC2);
+                if (water) {
+                    set_water_uniforms(game, game->water_shader);
+                    // GPU-rendered water runs the same effect inside the
+                    // tilemap's lookup shader, which needs the same uniforms
+                    Shader gpu_water = tilemap_layer_gpu_shader(data->tilemap, i);
+                    if (gpu_water.id != 0) set_water_uniforms(game, gpu_water);
                     BeginShaderMode(game->water_shader);
                     shader_active = true;
                 }
@@ -225,8 +328,7 @@ static void overworld_draw(Game *game) {
                 if (shader_active) EndShaderMode();
 
                 // Draw player reflection immediately after water layer (at matching elevation)
-                if (layer->shader_name[0] && strcmp(layer->shader_name, "water") == 0
-                    && game->player_sprite && data->player_elevation == layer->elevation) {
+                if (water && game->player_sprite && data->player_elevation == layer->elevation) {
                     float t = (float)GetTime();
                     SetShaderValue(game->reflection_shader, game->reflection_time_loc, &t, SHADER_UNIFORM_FLOAT);
 
@@ -250,7 +352,7 @@ static void overworld_draw(Game *game) {
     EndMode2D();
 
     // HUD
-    DrawText("Arrows: move | 1: dungeon | 2: battle | F3: collisions | F4: +1hr | F5: torch | F6: reinit", 10, 10, 20, WHITE);
+    DrawText("Arrows: move | 1: dungeon | 2: battle | F3: collisions | F4: +1hr | F5: torch | F6: reinit | M: map", 10, 10, 20, WHITE);
     DrawFPS(10, 40);
 
     char elev_buf[32];
@@ -263,6 +365,21 @@ static void overworld_draw(Game *game) {
     char time_buf[16];
     snprintf(time_buf, sizeof(time_buf), "%02d:%02d", hour, minute);
     DrawText(time_buf, GetScreenWidth() - 80, 10, 20, WHITE);
+
+    // Minimap from the map's overview textures, with the player as a dot
+    if (data->show_minimap && data->tilemap && data->tilemap->loaded &&
+        data->tilemap->width > 0 && data->tilemap->height > 0) {
+        float map_x = (float)(data->tilemap->startx * data->tilemap->tilewidth);
+        float map_y = (float)(data->tilemap->starty * data->tilemap->tileheight);
+        float map_w = (float)(data->tilemap->width * data->tilemap->tilewidth);
+        float map_h = (float)(data->tilemap->height * data->tilemap->tileheight);
+        float scale = 200.0f / (map_w > map_h ? map_w : map_h);
+        Rectangle dest = { GetScreenWidth() - map_w * scale - 10, 40, map_w * scale, map_h * scale };
+        DrawRectangleRec(dest, (Color){ 0, 0, 0, 160 });
+        tilemap_draw_overview(data->tilemap, dest, WHITE);
+        DrawRectangleLinesEx(dest, 1, WHITE);
+        DrawCircleV((Vector2){ dest.x + (data->pos_x - map_x) * scale, dest.y + (data->pos_y - map_y) * scale }, 3, RED);
+    }
 }
 
 SceneFuncs scene_overworld_funcs(void) {
@@ -271,6 +388,7 @@ SceneFuncs scene_overworld_funcs(void) {
         .cleanup = overworld_cleanup,
         .update  = overworld_update,
         .draw    = overworld_draw,
+        .loading = overworld_loading,
         .persistent = true,
     };
 }
@@ -1,4 +1,5 @@
 #include "sprite.h"
+#include "assets.h"
 #include <stdlib.h>
 #include <string.h>
 
@@ -6,7 +7,7 @@ AnimatedSprite *sprite_create(const char *texture_path, int frame_w, int frame_h
     AnimatedSprite *sprite = calloc(1, sizeof(AnimatedSprite));
     if (!sprite) return NULL;
 
-    sprite->texture = LoadTexture(texture_path);
+    sprite->texture = assets_acquire_texture(texture_path);
     sprite->frame_width = frame_w;
     sprite->frame_height = frame_h;
     sprite->columns = sprite->texture.width / frame_w;
@@ -16,7 +17,7 @@ AnimatedSprite *sprite_create(const char *texture_path, int frame_w, int frame_h
 
 void sprite_destroy(AnimatedSprite *sprite) {
     if (!sprite) return;
-    UnloadTexture(sprite->texture);
+    assets_release_texture(sprite->texture);
     free(sprite);
 }
 
@@ -0,0 +1,41 @@
+#include "task_pool.h"
+#include "platform.h"
+#include <stdatomic.h>
+
+typedef struct TaskBatch {
+    atomic_int next;
+    int count;
+    TaskFunc func;
+    void *ctx;
+} TaskBatch;
+
+static void run_batch(void *arg) {
+    TaskBatch *batch = (TaskBatch *)arg;
+    for (;;) {
+        int index = atomic_fetch_add(&batch->next, 1);
+        if (index >= batch->count) break;
+        batch->func(batch->ctx, index);
+    }
+}
+
+void task_pool_run(int count, TaskFunc func, void *ctx, int threads) {
+    if (count <= 0) return;
+    if (threads > TASK_POOL_MAX_THREADS) threads = TASK_POOL_MAX_THREADS;
+    if (threads > count) threads = count;
+
+    TaskBatch batch = { .count = count, .func = func, .ctx = ctx };
+    atomic_init(&batch.next, 0);
+
+    // If a worker fails to start, the remaining threads pick up its share
+    PlatformThread *workers[TASK_POOL_MAX_THREADS];
+    int started = 0;
+    for (int i = 1; i < threads; i++) {
+        PlatformThread *worker = platform_thread_start(run_batch, &batch);
+        if (worker) workers[started++] = worker;
+    }
+
+    run_batch(&batch);
+    for (int i = 0; i < started; i++) {
+        platform_thread_join(workers[i]);
+    }
+}
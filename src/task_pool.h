@@ -0,0 +1,17 @@
+#ifndef TASK_POOL_H
+#define TASK_POOL_H
+
+// Runs a batch of independent tasks on a few worker threads plus the calling
+// thread. Workers only live for one batch. Tasks are handed out in index
+// order, so put the longest ones first.
+
+#define TASK_POOL_MAX_THREADS 16
+
+typedef void (*TaskFunc)(void *ctx, int index);
+
+// Calls func(ctx, i) for every i in [0, count) on up to `threads` threads
+// (the caller included) and returns once all calls have finished.
+// threads <= 1 runs everything inline.
+void task_pool_run(int count, TaskFunc func, void *ctx, int threads);
+
+#endif
@@ -0,0 +1,85 @@
+#include "tile_batch.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define VERTS_PER_QUAD 6
+
+// Quad corners in triangle order (TL, BL, BR, TL, BR, TR, the winding
+// DrawTexturePro uses), as 0/1 offsets into the destination rect
+static const uint8_t corner_x[VERTS_PER_QUAD] = { 0, 0, 1, 0, 1, 1 };
+static const uint8_t corner_y[VERTS_PER_QUAD] = { 0, 1, 1, 0, 1, 0 };
+
+// For each orientation (H, V, D bits) and vertex, the uv entry it samples:
+// 0/2 = u0/u1, 1/3 = v0/v1. Tiled applies the diagonal flip (swap axes)
+// before H and V, so a destination corner is mirrored first and then swapped.
+static const uint8_t corner_u[8][VERTS_PER_QUAD] = {
+    { 0, 0, 2, 0, 2, 2 },   // none
+    { 0, 2, 2, 0, 2, 0 },   // D
+    { 0, 0, 2, 0, 2, 2 },   // V
+    { 2, 0, 0, 2, 0, 2 },   // V + D
+    { 2, 2, 0, 2, 0, 0 },   // H
+    { 0, 2, 2, 0, 2, 0 },   // H + D
+    { 2, 2, 0, 2, 0, 0 },   // H + V
+    { 2, 0, 0, 2, 0, 2 },   // H + V + D
+};
+static const uint8_t corner_v[8][VERTS_PER_QUAD] = {
+    { 1, 3, 3, 1, 3, 1 },   // none
+    { 1, 1, 3, 1, 3, 3 },   // D
+    { 3, 1, 1, 3, 1, 3 },   // V
+    { 1, 1, 3, 1, 3, 3 },   // V + D
+    { 1, 3, 3, 1, 3, 1 },   // H
+    { 3, 3, 1, 3, 1, 1 },   // H + D
+    { 3, 1, 1, 3, 1, 3 },   // H + V
+    { 3, 3, 1, 3, 1, 1 },   // H + V + D
+};
+
+bool tile_batch_reserve(TileBatch *batch, int quads) {
+    if (quads <= batch->quad_capacity) return true;
+
+    int capacity = batch->quad_capacity ? batch->quad_capacity : 1024;
+    while (capacity < quads) capacity *= 2;
+    size_t verts = (size_t)capacity * VERTS_PER_QUAD;
+    float *vertices = (float *)realloc(batch->vertices, verts * 3 * sizeof(float));
+    if (!vertices) return false;
+    batch->vertices = vertices;
+    float *texcoords = (float *)realloc(batch->texcoords, verts * 2 * sizeof(float));
+    if (!texcoords) return false;
+    batch->texcoords = texcoords;
+    unsigned char *colors = (unsigned char *)realloc(batch->colors, verts * 4);
+    if (!colors) return false;
+    batch->colors = colors;
+    batch->quad_capacity = capacity;
+    return true;
+}
+
+void tile_batch_free(TileBatch *batch) {
+    free(batch->vertices);
+    free(batch->texcoords);
+    free(batch->colors);
+    memset(batch, 0, sizeof(*batch));
+}
+
+void tile_batch_add(TileBatch *batch, float x, float y, float w, float h,
+                    const float uv[4], int orientation, const unsigned char color[4]) {
+    size_t base = (size_t)batch->quad_count++ * VERTS_PER_QUAD;
+    float *restrict pos = batch->vertices + base * 3;
+    float *restrict tex = batch->texcoords + base * 2;
+    unsigned char *restrict col = batch->colors + base * 4;
+    const uint8_t *cu = corner_u[orientation & 7];
+    const uint8_t *cv = corner_v[orientation & 7];
+
+    // Fixed trip count, table lookups and no branches: the compiler unrolls
+    // this into straight-line stores
+    const float xs[2] = { x, x + w };
+    const float ys[2] = { y, y + h };
+    uint32_t rgba;
+    memcpy(&rgba, color, sizeof(rgba));
+    for (int k = 0; k < VERTS_PER_QUAD; k++) {
+        pos[k * 3 + 0] = xs[corner_x[k]];
+        pos[k * 3 + 1] = ys[corner_y[k]];
+        pos[k * 3 + 2] = 0.0f;
+        tex[k * 2 + 0] = uv[cu[k]];
+        tex[k * 2 + 1] = uv[cv[k]];
+        memcpy(col + k * 4, &rgba, sizeof(rgba));
+    }
+}
@@ -0,0 +1,31 @@
+#ifndef TILE_BATCH_H
+#define TILE_BATCH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// CPU-side quad buffer for drawing many tiles of one texture in a single mesh
+// draw. Quads are stored as two triangles (6 vertices, no index buffer) in
+// the array layout of raylib's Mesh, so the arrays can be uploaded as is.
+// Nothing here touches the GPU.
+
+typedef struct TileBatch {
+    float *vertices;          // x, y, z per vertex
+    float *texcoords;         // u, v per vertex
+    unsigned char *colors;    // r, g, b, a per vertex
+    int quad_count;
+    int quad_capacity;
+} TileBatch;
+
+// Grow the buffers to hold at least `quads` quads (contents are kept)
+bool tile_batch_reserve(TileBatch *batch, int quads);
+void tile_batch_free(TileBatch *batch);
+
+// Append one quad covering [x, x + w) x [y, y + h). `uv` is the source rect
+// (u0, v0, u1, v1) and `orientation` the Tiled flip bits as in a draw
+// descriptor (H = 4, V = 2, D = 1); flips only permute the UVs. The caller
+// reserves room first.
+void tile_batch_add(TileBatch *batch, float x, float y, float w, float h,
+                    const float uv[4], int orientation, const unsigned char color[4]);
+
+#endif
@@ -0,0 +1,224 @@
+#include "tile_codec.h"
+#include "raylib.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(TILEMAP_ZSTD)
+#include <zstd.h>
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define TILE_CODEC_SSSE3 1
+#include <tmmintrin.h>
+#endif
+
+// Character -> 6-bit value; 0xFF marks characters outside the base64 alphabet
+static const uint8_t base64_table[256] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x3E, 0xFF, 0xFF, 0xFF, 0x3F,
+    0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B, 0x3C, 0x3D, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E,
+    0x0F, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F, 0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28,
+    0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F, 0x30, 0x31, 0x32, 0x33, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+};
+
+static bool simd_enabled = true;
+
+long base64_decoded_size(const char *text, size_t len) {
+    if (len % 4 != 0) return -1;
+    if (len == 0) return 0;
+    size_t padding = 0;
+    if (text[len - 1] == '=') padding++;
+    if (text[len - 2] == '=') padding++;
+    return (long)(len / 4 * 3 - padding);
+}
+
+#if TILE_CODEC_SSSE3
+// 16 characters -> 12 bytes per step (Mula/Lemire range-classification
+// decoder). Stops at the first block holding anything outside the alphabet,
+// including '=' padding, and leaves the rest to the scalar loop. Every store
+// writes 16 bytes, so it also stops while fewer than 16 bytes of output remain.
+__attribute__((target("ssse3")))
+static size_t base64_decode_ssse3(const char *text, size_t len, uint8_t *out, size_t out_cap,
+                                  size_t *out_written) {
+    const __m128i lut_lo = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                                         0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+    const __m128i lut_hi = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+                                         0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+    const __m128i lut_roll = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71,
+                                           0, 0, 0, 0, 0, 0, 0, 0);
+    const __m128i mask_2f = _mm_set1_epi8(0x2F);
+    const __m128i pack_ab = _mm_set1_epi32(0x01400140);
+    const __m128i pack_abc = _mm_set1_epi32(0x00011000);
+    const __m128i reorder = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+
+    size_t in_pos = 0, out_pos = 0;
+    while (in_pos + 16 <= len && out_pos + 16 <= out_cap) {
+        __m128i str = _mm_loadu_si128((const __m128i *)(text + in_pos));
+
+        __m128i hi_nibbles = _mm_and_si128(_mm_srli_epi32(str, 4), mask_2f);
+        __m128i lo_nibbles = _mm_and_si128(str, mask_2f);
+        __m128i hi = _mm_shuffle_epi8(lut_hi, hi_nibbles);
+        __m128i lo = _mm_shuffle_epi8(lut_lo, lo_nibbles);
+        if (_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_and_si128(lo, hi), _mm_setzero_si128())) != 0) break;
+
+        __m128i eq_2f = _mm_cmpeq_epi8(str, mask_2f);
+        __m128i roll = _mm_shuffle_epi8(lut_roll, _mm_add_epi8(eq_2f, hi_nibbles));
+        str = _mm_add_epi8(str, roll);
+
+        __m128i merged = _mm_maddubs_epi16(str, pack_ab);
+        merged = _mm_madd_epi16(merged, pack_abc);
+        _mm_storeu_si128((__m128i *)(out + out_pos), _mm_shuffle_epi8(merged, reorder));
+
+        in_pos += 16;
+        out_pos += 12;
+    }
+    *out_written = out_pos;
+    return in_pos;
+}
+#endif
+
+bool tile_codec_set_simd(bool enabled) {
+    simd_enabled = enabled;
+#if TILE_CODEC_SSSE3
+    return enabled && __builtin_cpu_supports("ssse3");
+#else
+    return false;
+#endif
+}
+
+long base64_decode(const char *text, size_t len, uint8_t *out, size_t out_cap) {
+    long decoded = base64_decoded_size(text, len);
+    if (decoded < 0 || (size_t)decoded > out_cap) return -1;
+
+    const unsigned char *in = (const unsigned char *)text;
+    size_t in_pos = 0, out_pos = 0;
+
+#if TILE_CODEC_SSSE3
+    if (simd_enabled && __builtin_cpu_supports("ssse3")) {
+        in_pos = base64_decode_ssse3(text, len, out, (size_t)decoded, &out_pos);
+    }
+#endif
+
+    // Whole quanta; the final one may be padded
+    size_t body_end = len > 0 ? len - 4 : 0;
+    for (; in_pos < body_end; in_pos += 4) {
+        uint32_t a = base64_table[in[in_pos]], b = base64_table[in[in_pos + 1]];
+        uint32_t c = base64_table[in[in_pos + 2]], d = base64_table[in[in_pos + 3]];
+        if ((a | b | c | d) & 0x80) return -1;
+        uint32_t v = (a << 18) | (b << 12) | (c << 6) | d;
+        out[out_pos++] = (uint8_t)(v >> 16);
+        out[out_pos++] = (uint8_t)(v >> 8);
+        out[out_pos++] = (uint8_t)v;
+    }
+
+    if (in_pos < len) {
+        uint32_t a = base64_table[in[in_pos]], b = base64_table[in[in_pos + 1]];
+        uint32_t c = in[in_pos + 2] == '=' ? 0 : base64_table[in[in_pos + 2]];
+        uint32_t d = in[in_pos + 3] == '=' ? 0 : base64_table[in[in_pos + 3]];
+        if ((a | b | c | d) & 0x80) return -1;
+        if (in[in_pos + 2] == '=' && in[in_pos + 3] != '=') return -1;
+        uint32_t v = (a << 18) | (b << 12) | (c << 6) | d;
+        out[out_pos++] = (uint8_t)(v >> 16);
+        if (in[in_pos + 2] != '=') out[out_pos++] = (uint8_t)(v >> 8);
+        if (in[in_pos + 3] != '=') out[out_pos++] = (uint8_t)v;
+    }
+
+    return (long)out_pos;
+}
+
+// Locate the raw DEFLATE stream inside a zlib (RFC 1950) or gzip (RFC 1952)
+// wrapper. Trailing checksums are left in place; the inflater stops at the
+// final block.
+static const uint8_t *zlib_payload(const uint8_t *data, size_t size, size_t *payload_size) {
+    if (size < 2) return NULL;
+    uint8_t cmf = data[0], flg = data[1];
+    if ((cmf & 0x0F) != 8 || ((cmf << 8) | flg) % 31 != 0 || (flg & 0x20)) return NULL;
+    *payload_size = size - 2;
+    return data + 2;
+}
+
+static const uint8_t *gzip_payload(const uint8_t *data, size_t size, size_t *payload_size) {
+    if (size < 18 || data[0] != 0x1F || data[1] != 0x8B || data[2] != 8) return NULL;
+    uint8_t flags = data[3];
+    size_t pos = 10;
+    if (flags & 0x04) {                       // FEXTRA
+        if (pos + 2 > size) return NULL;
+        pos += 2 + (size_t)(data[pos] | (data[pos + 1] << 8));
+    }
+    if (flags & 0x08) {                       // FNAME
+        while (pos < size && data[pos]) pos++;
+        pos++;
+    }
+    if (flags & 0x10) {                       // FCOMMENT
+        while (pos < size && data[pos]) pos++;
+        pos++;
+    }
+    if (flags & 0x02) pos += 2;               // FHCRC
+    if (pos >= size) return NULL;
+    *payload_size = size - pos;
+    return data + pos;
+}
+
+static bool inflate_into(const uint8_t *payload, size_t payload_size, uint8_t *out, size_t out_size) {
+    int inflated_size = 0;
+    unsigned char *inflated = DecompressData(payload, (int)payload_size, &inflated_size);
+    if (!inflated) return false;
+    bool ok = (size_t)inflated_size == out_size;
+    if (ok) memcpy(out, inflated, out_size);
+    MemFree(inflated);
+    return ok;
+}
+
+bool tile_codec_decode_layer(const char *text, size_t len, const char *compression,
+                             uint32_t *out, int count) {
+    size_t out_size = (size_t)count * sizeof(uint32_t);
+    bool compressed = compression && compression[0];
+
+    // Uncompressed base64 decodes straight into the GID array
+    if (!compressed) {
+        return base64_decoded_size(text, len) == (long)out_size &&
+               base64_decode(text, len, (uint8_t *)out, out_size) == (long)out_size;
+    }
+
+    long packed_size = base64_decoded_size(text, len);
+    if (packed_size <= 0) return false;
+    uint8_t *packed = (uint8_t *)malloc((size_t)packed_size);
+    if (!packed) return false;
+
+    bool ok = false;
+    if (base64_decode(text, len, packed, (size_t)packed_size) == packed_size) {
+        size_t payload_size = 0;
+        const uint8_t *payload = NULL;
+        if (strcmp(compression, "zlib") == 0) {
+            payload = zlib_payload(packed, (size_t)packed_size, &payload_size);
+            ok = payload && inflate_into(payload, payload_size, (uint8_t *)out, out_size);
+        } else if (strcmp(compression, "gzip") == 0) {
+            payload = gzip_payload(packed, (size_t)packed_size, &payload_size);
+            ok = payload && inflate_into(payload, payload_size, (uint8_t *)out, out_size);
+        } else if (strcmp(compression, "zstd") == 0) {
+#if defined(TILEMAP_ZSTD)
+            size_t written = ZSTD_decompress(out, out_size, packed, (size_t)packed_size);
+            ok = !ZSTD_isError(written) && written == out_size;
+#else
+            printf("[tilemap] WARNING: zstd layer data needs a TILEMAP_ZSTD=1 build\n");
+#endif
+        } else {
+            printf("[tilemap] WARNING: Unsupported layer compression: %s\n", compression);
+        }
+    }
+
+    free(packed);
+    return ok;
+}
@@ -0,0 +1,29 @@
+#ifndef TILE_CODEC_H
+#define TILE_CODEC_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Decoders for Tiled's encoded layer data ("encoding": "base64" with
+// "compression": "", "zlib", "gzip" or "zstd").
+
+// Exact decoded size of padded base64 text, or -1 if the length is invalid
+long base64_decoded_size(const char *text, size_t len);
+
+// Decode padded base64 into `out` (capacity `out_cap`). Uses SSSE3 when the
+// CPU has it. Returns the number of bytes written, or -1 on invalid input.
+long base64_decode(const char *text, size_t len, uint8_t *out, size_t out_cap);
+
+// Let base64_decode() use SSSE3 (the default) or force the scalar loop, so
+// the two can be compared. Returns whether SSSE3 will be used, which also
+// needs a CPU that has it.
+bool tile_codec_set_simd(bool enabled);
+
+// Decode a layer "data" string into exactly `count` GIDs written to `out`.
+// `compression` may be NULL or "" for plain base64. zstd support is only
+// compiled in with TILEMAP_ZSTD (see build.sh).
+bool tile_codec_decode_layer(const char *text, size_t len, const char *compression,
+                             uint32_t *out, int count);
+
+#endif
@@ -0,0 +1,213 @@
+#include "tile_palette.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define CHUNK_CELLS (TILE_PALETTE_CHUNK * TILE_PALETTE_CHUNK)
+// Power of two above CHUNK_CELLS, so the palette lookup table never fills
+#define PALETTE_SLOTS (CHUNK_CELLS * 2)
+
+static size_t index_words(int cells, int bits) {
+    return ((size_t)cells * bits + 63) / 64;
+}
+
+static size_t chunk_bytes(const TilePaletteChunk *chunk, int cells) {
+    return chunk->palette_count * sizeof(uint32_t) + index_words(cells, chunk->bits) * sizeof(uint64_t) +
+           chunk->flip_count * (sizeof(uint16_t) + sizeof(uint8_t));
+}
+
+static int chunk_height(const TilePaletteGrid *grid, int cy) {
+    int h = grid->height - cy * TILE_PALETTE_CHUNK;
+    return h < TILE_PALETTE_CHUNK ? h : TILE_PALETTE_CHUNK;
+}
+
+static uint32_t read_index(const uint64_t *words, int bits, size_t cell) {
+    size_t bit = cell * bits;
+    size_t word = bit >> 6;
+    int shift = (int)(bit & 63);
+    uint64_t value = words[word] >> shift;
+    if (shift + bits > 64) value |= words[word + 1] << (64 - shift);
+    return (uint32_t)(value & ((1u << bits) - 1));
+}
+
+// Pack `cells` values (chunk rows of `width` cells) into a new chunk
+static bool pack_chunk(TilePaletteChunk *chunk, const uint32_t *values, int cells, int width) {
+    // Palette indices through a small open-addressed table
+    static const int empty = -1;
+    int slots[PALETTE_SLOTS];
+    memset(slots, 0xff, sizeof(slots));
+    uint32_t palette[CHUNK_CELLS];
+    uint16_t index[CHUNK_CELLS];
+    int palette_count = 0, flip_count = 0;
+    for (int i = 0; i < cells; i++) {
+        uint32_t value = values[i] & ~TILE_PALETTE_FLIP_MASK;
+        uint32_t slot = (value * 2654435761u) & (PALETTE_SLOTS - 1);
+        while (slots[slot] != empty && palette[slots[slot]] != value) slot = (slot + 1) & (PALETTE_SLOTS - 1);
+        if (slots[slot] == empty) {
+            slots[slot] = palette_count;
+            palette[palette_count++] = value;
+        }
+        index[i] = (uint16_t)slots[slot];
+        if (values[i] & TILE_PALETTE_FLIP_MASK) flip_count++;
+    }
+
+    int bits = 0;
+    while ((1 << bits) < palette_count) bits++;
+    size_t words = index_words(cells, bits);
+    size_t size = words * sizeof(uint64_t) + palette_count * sizeof(uint32_t) +
+                  flip_count * (sizeof(uint16_t) + sizeof(uint8_t));
+    // Index words first, so they stay 8-byte aligned
+    uint8_t *memory = (uint8_t *)calloc(1, size > 0 ? size : 1);
+    if (!memory) return false;
+
+    memset(chunk, 0, sizeof(*chunk));
+    chunk->indices = (uint64_t *)memory;
+    chunk->palette = (uint32_t *)(memory + words * sizeof(uint64_t));
+    chunk->flip_cells = (uint16_t *)(chunk->palette + palette_count);
+    chunk->flips = (uint8_t *)(chunk->flip_cells + flip_count);
+    chunk->palette_count = palette_count;
+    chunk->bits = (uint8_t)bits;
+    chunk->width = (uint8_t)width;
+    memcpy(chunk->palette, palette, palette_count * sizeof(uint32_t));
+
+    for (int i = 0; i < cells; i++) {
+        if (bits > 0) {
+            size_t bit = (size_t)i * bits;
+            int shift = (int)(bit & 63);
+            chunk->indices[bit >> 6] |= (uint64_t)index[i] << shift;
+            if (shift + bits > 64) chunk->indices[(bit >> 6) + 1] |= (uint64_t)index[i] >> (64 - shift);
+        }
+        if (values[i] & TILE_PALETTE_FLIP_MASK) {
+            chunk->flip_cells[chunk->flip_count] = (uint16_t)i;
+            chunk->flips[chunk->flip_count++] = (uint8_t)(values[i] >> TILE_PALETTE_FLIP_SHIFT);
+        }
+    }
+    return true;
+}
+
+// First flip entry at or after `cell`
+static int first_flip(const TilePaletteChunk *chunk, int cell) {
+    int lo = 0, hi = chunk->flip_count;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (chunk->flip_cells[mid] < cell) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+static void decode_chunk_run(const TilePaletteChunk *chunk, int first, int count, uint32_t *out) {
+    if (chunk->bits == 0) {
+        for (int i = 0; i < count; i++) out[i] = chunk->palette[0];
+    } else {
+        int bits = chunk->bits;
+        uint64_t mask = (1u << bits) - 1;
+        size_t bit = (size_t)first * bits;
+        const uint64_t *word = chunk->indices + (bit >> 6);
+        int shift = (int)(bit & 63);
+        for (int i = 0; i < count; i++) {
+            uint64_t value = *word >> shift;
+            if (shift + bits > 64) value |= word[1] << (64 - shift);
+            out[i] = chunk->palette[value & mask];
+            shift += bits;
+            if (shift >= 64) {
+                shift -= 64;
+                word++;
+            }
+        }
+    }
+    for (int f = chunk->flip_count ? first_flip(chunk, first) : 0;
+         f < chunk->flip_count && chunk->flip_cells[f] < first + count; f++) {
+        out[chunk->flip_cells[f] - first] |= (uint32_t)chunk->flips[f] << TILE_PALETTE_FLIP_SHIFT;
+    }
+}
+
+bool tile_palette_build(TilePaletteGrid *grid, const uint32_t *values, int width, int height) {
+    memset(grid, 0, sizeof(*grid));
+    if (width <= 0 || height <= 0) return false;
+    int cols = (width + TILE_PALETTE_CHUNK - 1) / TILE_PALETTE_CHUNK;
+    int rows = (height + TILE_PALETTE_CHUNK - 1) / TILE_PALETTE_CHUNK;
+    grid->chunks = (TilePaletteChunk *)calloc((size_t)cols * rows, sizeof(TilePaletteChunk));
+    if (!grid->chunks) return false;
+    grid->width = width;
+    grid->height = height;
+    grid->cols = cols;
+    grid->rows = rows;
+    grid->bytes = (size_t)cols * rows * sizeof(TilePaletteChunk);
+
+    uint32_t cells[CHUNK_CELLS];
+    for (int cy = 0; cy < rows; cy++) {
+        int h = chunk_height(grid, cy);
+        for (int cx = 0; cx < cols; cx++) {
+            int w = width - cx * TILE_PALETTE_CHUNK;
+            if (w > TILE_PALETTE_CHUNK) w = TILE_PALETTE_CHUNK;
+            for (int y = 0; y < h; y++) {
+                memcpy(cells + y * w, values + (size_t)(cy * TILE_PALETTE_CHUNK + y) * width + cx * TILE_PALETTE_CHUNK,
+                       w * sizeof(uint32_t));
+            }
+            TilePaletteChunk *chunk = &grid->chunks[cy * cols + cx];
+            if (!pack_chunk(chunk, cells, w * h, w)) {
+                tile_palette_free(grid);
+                return false;
+            }
+            grid->bytes += chunk_bytes(chunk, w * h);
+        }
+    }
+    return true;
+}
+
+void tile_palette_free(TilePaletteGrid *grid) {
+    if (grid->chunks) {
+        for (int i = 0; i < grid->cols * grid->rows; i++) free(grid->chunks[i].indices);
+        free(grid->chunks);
+    }
+    memset(grid, 0, sizeof(*grid));
+}
+
+uint32_t tile_palette_get(const TilePaletteGrid *grid, int x, int y) {
+    const TilePaletteChunk *chunk =
+        &grid->chunks[(y / TILE_PALETTE_CHUNK) * grid->cols + x / TILE_PALETTE_CHUNK];
+    int cell = (y % TILE_PALETTE_CHUNK) * chunk->width + x % TILE_PALETTE_CHUNK;
+    uint32_t value = chunk->palette[chunk->bits ? read_index(chunk->indices, chunk->bits, cell) : 0];
+    if (chunk->flip_count) {
+        int f = first_flip(chunk, cell);
+        if (f < chunk->flip_count && chunk->flip_cells[f] == cell) {
+            value |= (uint32_t)chunk->flips[f] << TILE_PALETTE_FLIP_SHIFT;
+        }
+    }
+    return value;
+}
+
+void tile_palette_decode_run(const TilePaletteGrid *grid, int y, int x0, int x1, uint32_t *out) {
+    const TilePaletteChunk *row = &grid->chunks[(y / TILE_PALETTE_CHUNK) * grid->cols];
+    int row_in_chunk = y % TILE_PALETTE_CHUNK;
+    for (int x = x0; x < x1;) {
+        const TilePaletteChunk *chunk = &row[x / TILE_PALETTE_CHUNK];
+        int local_x = x % TILE_PALETTE_CHUNK;
+        int count = chunk->width - local_x;
+        if (count > x1 - x) count = x1 - x;
+        decode_chunk_run(chunk, row_in_chunk * chunk->width + local_x, count, out);
+        out += count;
+        x += count;
+    }
+}
+
+bool tile_palette_set(TilePaletteGrid *grid, int x, int y, uint32_t value) {
+    if (!grid->chunks || x < 0 || y < 0 || x >= grid->width || y >= grid->height) return false;
+    int cy = y / TILE_PALETTE_CHUNK;
+    TilePaletteChunk *chunk = &grid->chunks[cy * grid->cols + x / TILE_PALETTE_CHUNK];
+    int cells_count = chunk->width * chunk_height(grid, cy);
+
+    uint32_t cells[CHUNK_CELLS];
+    decode_chunk_run(chunk, 0, cells_count, cells);
+    int cell = (y % TILE_PALETTE_CHUNK) * chunk->width + x % TILE_PALETTE_CHUNK;
+    if (cells[cell] == value) return true;
+    cells[cell] = value;
+
+    TilePaletteChunk packed;
+    if (!pack_chunk(&packed, cells, cells_count, chunk->width)) return false;
+    grid->bytes -= chunk_bytes(chunk, cells_count);
+    grid->bytes += chunk_bytes(&packed, cells_count);
+    free(chunk->indices);
+    *chunk = packed;
+    return true;
+}
@@ -0,0 +1,52 @@
+#ifndef TILE_PALETTE_H
+#define TILE_PALETTE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Compact storage for a grid of tile values (GIDs or draw descriptors). The
+// grid is split into TILE_PALETTE_CHUNK-square chunks; each keeps a palette
+// of its distinct values and one bit-packed palette index per cell, as few
+// bits as the palette needs (0 for a chunk holding a single value). Flip
+// bits (the top three, TILE_PALETTE_FLIP_MASK) are rare, so they are kept
+// out of the palette in a sparse per-chunk list of (cell, flips).
+
+#define TILE_PALETTE_CHUNK 32
+#define TILE_PALETTE_FLIP_MASK 0xE0000000u
+#define TILE_PALETTE_FLIP_SHIFT 29
+
+typedef struct TilePaletteChunk {
+    uint64_t *indices;        // `bits` per cell, row-major, may straddle words;
+                              // owns the chunk's single allocation
+    uint32_t *palette;        // distinct values, flip bits cleared
+    uint16_t *flip_cells;     // cells with flip bits, ascending
+    uint8_t *flips;           // their flip bits (value >> TILE_PALETTE_FLIP_SHIFT)
+    int palette_count;
+    int flip_count;
+    uint8_t bits;
+    uint8_t width;            // cells per row (less at the grid's right edge)
+} TilePaletteChunk;
+
+typedef struct TilePaletteGrid {
+    TilePaletteChunk *chunks; // row-major, cols x rows; NULL when not built
+    int width, height;
+    int cols, rows;
+    size_t bytes;             // everything allocated, chunk table included
+} TilePaletteGrid;
+
+// Pack a width x height array of values. False (grid left empty) if out of
+// memory.
+bool tile_palette_build(TilePaletteGrid *grid, const uint32_t *values, int width, int height);
+void tile_palette_free(TilePaletteGrid *grid);
+
+uint32_t tile_palette_get(const TilePaletteGrid *grid, int x, int y);
+
+// Decode cells [x0, x1) of row y into out[0 .. x1 - x0)
+void tile_palette_decode_run(const TilePaletteGrid *grid, int y, int x0, int x1, uint32_t *out);
+
+// Change one cell. The chunk is repacked, which is cheap next to a full
+// rebuild but far from free: meant for occasional edits.
+bool tile_palette_set(TilePaletteGrid *grid, int x, int y, uint32_t value);
+
+#endif
@@ -1,22 +1,26 @@
 #include "tilemap.h"
+#include "assets.h"
+#include "tilemap_format.h"
 #include "cJSON.h"
+#include "json_stream.h"
+#include "tile_codec.h"
+#include "arena.h"
+#include "rlgl.h"
+#include "raymath.h"
+#include "task_pool.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
+#include <stdatomic.h>
+#include <limits.h>
 
-// Fix unescaped backslashes in JSON text (Tiled Windows path quirk)
-static void fix_json_backslashes(char *text) {
-    for (char *p = text; *p; p++) {
-        if (*p == '\\') {
-            char next = *(p + 1);
-            if (next != '"' && next != '\\' && next != '/' &&
-                next != 'b' && next != 'f' && next != 'n' &&
-                next != 'r' && next != 't' && next != 'u') {
-                *p = '/';
-            }
-        }
-    }
+// Progress output; warnings and errors are always printed
+static bool tilemap_log_enabled = true;
+#define TILEMAP_LOG(...) do { if (tilemap_log_enabled) printf(__VA_ARGS__); } while (0)
+
+void tilemap_set_logging(bool enabled) {
+    tilemap_log_enabled = enabled;
 }
 
 static void strncpy_safe(char *dst, const char *src, size_t n) {
@@ -48,22 +52,19 @@ static const char *get_filename(const char *path) {
     return last ? last + 1 : path;
 }
 
-// Try to load a texture, with fallback to just the filename in base_dir
-static Texture2D load_texture_with_fallback(const char *image_path, const char *base_dir) {
+// Resolve a tileset image path, with fallback to just the filename in base_dir
+static bool resolve_image_path(const char *image_path, const char *base_dir,
+                               char *resolved, size_t resolved_size) {
     // First try: resolve relative to base_dir
-    char resolved[512];
-    snprintf(resolved, sizeof(resolved), "%s%s", base_dir, image_path);
-    if (FileExists(resolved)) {
-        printf("[tilemap] Loading texture: %s\n", resolved);
-        return LoadTexture(resolved);
-    }
+    snprintf(resolved, resolved_size, "%s%s", base_dir, image_path);
+    if (FileExists(resolved)) return true;
 
     // Second try: just the filename in base_dir
     const char *fname = get_filename(image_path);
-    snprintf(resolved, sizeof(resolved), "%s%s", base_dir, fname);
+    snprintf(resolved, resolved_size, "%s%s", base_dir, fname);
     if (FileExists(resolved)) {
-        printf("[tilemap] Loading texture (fallback): %s\n", resolved);
-        return LoadTexture(resolved);
+        TILEMAP_LOG("[tilemap] Image path fallback: %s\n", resolved);
+        return true;
     }
 
     // Third try: lowercase filename in base_dir
@@ -72,17 +73,18 @@ static Texture2D load_texture_with_fallback(const char *image_path, const char *
     for (char *p = lower_fname; *p; p++) {
         if (*p >= 'A' && *p <= 'Z') *p += 32;
     }
-    snprintf(resolved, sizeof(resolved), "%s%s", base_dir, lower_fname);
+    snprintf(resolved, resolved_size, "%s%s", base_dir, lower_fname);
     if (FileExists(resolved)) {
-        printf("[tilemap] Loading texture (lowercase fallback): %s\n", resolved);
-        return LoadTexture(resolved);
+        TILEMAP_LOG("[tilemap] Image path fallback (lowercase): %s\n", resolved);
+        return true;
     }
 
     printf("[tilemap] WARNING: Could not find texture: %s\n", image_path);
-    return (Texture2D){0};
+    resolved[0] = '\0';
+    return false;
 }
 
-static bool parse_tileset_json(cJSON *ts_json, TilesetInfo *ts, const char *base_dir) {
+static bool parse_tileset_json(cJSON *ts_json, TilesetInfo *ts, const char *base_dir, Arena *arena) {
     cJSON *item;
 
     item = cJSON_GetObjectItem(ts_json, "firstgid");
@@ -114,14 +116,14 @@ static bool parse_tileset_json(cJSON *ts_json, TilesetInfo *ts, const char *base
 
     item = cJSON_GetObjectItem(ts_json, "image");
     if (item && item->valuestring) {
-        ts->texture = load_texture_with_fallback(item->valuestring, base_dir);
+        resolve_image_path(item->valuestring, base_dir, ts->image_path, sizeof(ts->image_path));
     }
 
     // Parse tile animations
     if (ts->tilecount > 0) {
-        ts->anim_lookup = (TileAnim *)calloc(ts->tilecount, sizeof(TileAnim));
+        ts->anim_lookup = (TileAnim *)arena_alloc_array(arena, ts->tilecount, sizeof(TileAnim));
         cJSON *tiles_arr = cJSON_GetObjectItem(ts_json, "tiles");
-        if (tiles_arr && cJSON_IsArray(tiles_arr)) {
+        if (ts->anim_lookup && tiles_arr && cJSON_IsArray(tiles_arr)) {
             cJSON *tile_entry;
             cJSON_ArrayForEach(tile_entry, tiles_arr) {
                 cJSON *id_item = cJSON_GetObjectItem(tile_entry, "id");
@@ -135,8 +137,9 @@ static bool parse_tileset_json(cJSON *ts_json, TilesetInfo *ts, const char *base
                 if (frame_count <= 0) continue;
 
                 TileAnim *anim = &ts->anim_lookup[local_id];
+                anim->frames = (TileAnimFrame *)arena_alloc_array(arena, frame_count, sizeof(TileAnimFrame));
+                if (!anim->frames) continue;
                 anim->frame_count = frame_count;
-                anim->frames = (TileAnimFrame *)malloc(frame_count * sizeof(TileAnimFrame));
                 anim->total_duration = 0;
 
                 int f = 0;
@@ -150,7 +153,7 @@ static bool parse_tileset_json(cJSON *ts_json, TilesetInfo *ts, const char *base
                     f++;
                 }
 
-                printf("[tilemap] Animated tile %d: %d frames, %d ms total\n",
+                TILEMAP_LOG("[tilemap] Animated tile %d: %d frames, %d ms total\n",
                        local_id, anim->frame_count, anim->total_duration);
             }
         }
@@ -159,11 +162,25 @@ static bool parse_tileset_json(cJSON *ts_json, TilesetInfo *ts, const char *base
     return ts->columns > 0 && ts->tilecount > 0;
 }
 
-static void parse_tile_layer(cJSON *layer_json, TileLayer *layer) {
+// A layer read by the streaming parser: every member except "data" is kept
+// as a small cJSON object. "data" (number array or base64 string) is only
+// located, and decoded later by parse_tile_layer() on a load task. Chunks of
+// infinite maps likewise only record where their "data" sits in the file.
+typedef struct StreamedLayer {
+    cJSON *json;
+    size_t data_offset;
+    size_t data_length;     // 0 if the layer has no "data"
+    TileChunk *chunks;
+    int chunk_count;
+} StreamedLayer;
+
+static void parse_tile_layer(cJSON *layer_json, TileLayer *layer, StreamedLayer *streamed,
+                             const char *text, Arena *arena) {
     cJSON *item;
 
     item = cJSON_GetObjectItem(layer_json, "name");
     strncpy_safe(layer->name, item ? item->valuestring : "", sizeof(layer->name));
+    layer->planes = 1;
 
     item = cJSON_GetObjectItem(layer_json, "width");
     if (item) layer->width = item->valueint;
@@ -177,48 +194,604 @@ static void parse_tile_layer(cJSON *layer_json, TileLayer *layer) {
     item = cJSON_GetObjectItem(layer_json, "opacity");
     layer->opacity = item ? (float)item->valuedouble : 1.0f;
 
-    // Parse custom properties from Tiled
-    layer->render_layer[0] = '\0';
+    // Parse custom properties from Tiled. The string ones (render_layer,
+    // shader) are interned by intern_parsed_strings() after the parallel parse.
     layer->elevation = 0;
-    layer->shader_name[0] = '\0';
     cJSON *props = cJSON_GetObjectItem(layer_json, "properties");
     if (props && cJSON_IsArray(props)) {
         cJSON *prop;
         cJSON_ArrayForEach(prop, props) {
             cJSON *pname = cJSON_GetObjectItem(prop, "name");
             if (!pname || !pname->valuestring) continue;
-            if (strcmp(pname->valuestring, "render_layer") == 0) {
-                cJSON *pval = cJSON_GetObjectItem(prop, "value");
-                if (pval && pval->valuestring) {
-                    strncpy_safe(layer->render_layer, pval->valuestring, sizeof(layer->render_layer));
-                }
-            } else if (strcmp(pname->valuestring, "elevation") == 0) {
+            if (strcmp(pname->valuestring, "elevation") == 0) {
                 cJSON *pval = cJSON_GetObjectItem(prop, "value");
                 if (pval) layer->elevation = pval->valueint;
-            } else if (strcmp(pname->valuestring, "shader") == 0) {
-                cJSON *pval = cJSON_GetObjectItem(prop, "value");
-                if (pval && pval->valuestring) {
-                    strncpy_safe(layer->shader_name, pval->valuestring, sizeof(layer->shader_name));
+            }
+        }
+    }
+
+    // Infinite map layers: chunk data stays in the file until streamed in
+    if (streamed->chunks) {
+        layer->chunks = (TileChunk *)arena_alloc_array(arena, streamed->chunk_count, sizeof(TileChunk));
+        if (!layer->chunks) return;
+        memcpy(layer->chunks, streamed->chunks, streamed->chunk_count * sizeof(TileChunk));
+        layer->chunk_count = streamed->chunk_count;
+
+        cJSON *encoding = cJSON_GetObjectItem(layer_json, "encoding");
+        cJSON *compression = cJSON_GetObjectItem(layer_json, "compression");
+        layer->chunk_base64 = cJSON_IsString(encoding) && strcmp(encoding->valuestring, "base64") == 0;
+        strncpy_safe(layer->chunk_compression, cJSON_IsString(compression) ? compression->valuestring : "",
+                     sizeof(layer->chunk_compression));
+        return;
+    }
+
+    if (streamed->data_length == 0) return;
+    const char *span = text + streamed->data_offset;
+    int cells = layer->width * layer->height;
+    if (cells <= 0) return;
+
+    // CSV layers: a flat number array, tokenized straight into the GIDs
+    if (span[0] == '[') {
+        JsonStream js;
+        json_stream_init(&js, span, streamed->data_length);
+        int count = json_stream_count_flat_array(&js);
+        if (count != cells) {
+            printf("[tilemap] WARNING: Layer \"%s\" has %d tiles, expected %d\n",
+                   layer->name, count, cells);
+            return;
+        }
+        // On failure the block is simply left unused in the arena
+        uint32_t *gids = (uint32_t *)arena_alloc_array(arena, cells, sizeof(uint32_t));
+        if (gids && json_stream_read_uint32_array(&js, gids, cells) == cells) {
+            layer->data = gids;
+        } else {
+            printf("[tilemap] WARNING: Malformed tile data in layer \"%s\"\n", layer->name);
+        }
+        return;
+    }
+
+    // Encoded layers ("encoding": "base64", optional "compression"): "data"
+    // is a string; skip its quotes
+    cJSON *encoding = cJSON_GetObjectItem(layer_json, "encoding");
+    if (span[0] == '"' && cJSON_IsString(encoding) && strcmp(encoding->valuestring, "base64") == 0) {
+        cJSON *compression = cJSON_GetObjectItem(layer_json, "compression");
+        uint32_t *gids = (uint32_t *)arena_alloc_array(arena, cells, sizeof(uint32_t));
+        if (gids && streamed->data_length >= 2 &&
+            tile_codec_decode_layer(span + 1, streamed->data_length - 2,
+                                    cJSON_IsString(compression) ? compression->valuestring : NULL,
+                                    gids, cells)) {
+            layer->data = gids;
+        } else {
+            printf("[tilemap] WARNING: Failed to decode %s layer data for \"%s\"\n",
+                   cJSON_IsString(compression) && compression->valuestring[0] ? compression->valuestring : "base64",
+                   layer->name);
+        }
+    } else if (cJSON_IsString(encoding) && strcmp(encoding->valuestring, "csv") != 0) {
+        printf("[tilemap] WARNING: Unsupported layer encoding \"%s\" for \"%s\"\n",
+               encoding->valuestring, layer->name);
+    }
+}
+
+// Floor division, so negative chunk positions land in the right grid cell
+static int floor_div(int a, int b) {
+    int q = a / b;
+    return (a % b != 0 && (a < 0) != (b < 0)) ? q - 1 : q;
+}
+
+static uint32_t chunk_hash(int cx, int cy) {
+    return ((uint32_t)cx * 73856093u) ^ ((uint32_t)cy * 19349663u);
+}
+
+static TileChunk *find_chunk(const TileMap *map, const TileLayer *layer, int cx, int cy) {
+    if (!layer->chunk_slots) return NULL;
+    uint32_t slot = chunk_hash(cx, cy) & (uint32_t)layer->chunk_slot_mask;
+    while (layer->chunk_slots[slot]) {
+        TileChunk *chunk = &layer->chunks[layer->chunk_slots[slot] - 1];
+        if (floor_div(chunk->x, map->chunk_width) == cx && floor_div(chunk->y, map->chunk_height) == cy) {
+            return chunk;
+        }
+        slot = (slot + 1) & (uint32_t)layer->chunk_slot_mask;
+    }
+    return NULL;
+}
+
+static void build_chunk_table(TileMap *map, TileLayer *layer) {
+    int slots = 16;
+    while (slots < layer->chunk_count * 2) slots *= 2;
+    layer->chunk_slots = (int *)arena_alloc_array(map->arena, slots, sizeof(int));
+    if (!layer->chunk_slots) return;
+    layer->chunk_slot_mask = slots - 1;
+
+    for (int i = 0; i < layer->chunk_count; i++) {
+        TileChunk *chunk = &layer->chunks[i];
+        int cx = floor_div(chunk->x, map->chunk_width);
+        int cy = floor_div(chunk->y, map->chunk_height);
+        if (find_chunk(map, layer, cx, cy)) {
+            printf("[tilemap] WARNING: Layer \"%s\" has two chunks at (%d, %d), ignoring one\n",
+                   layer->name, chunk->x, chunk->y);
+            continue;
+        }
+        uint32_t slot = chunk_hash(cx, cy) & (uint32_t)layer->chunk_slot_mask;
+        while (layer->chunk_slots[slot]) slot = (slot + 1) & (uint32_t)layer->chunk_slot_mask;
+        layer->chunk_slots[slot] = i + 1;
+    }
+}
+
+// Infinite maps: the chunk grid size comes from the first chunk (Tiled writes
+// them all the same size) and the map bounds become the union of all chunks.
+static void setup_chunks(TileMap *map) {
+    int min_x = 0, min_y = 0, max_x = 0, max_y = 0;
+    bool any = false;
+    for (int l = 0; l < map->tile_layer_count; l++) {
+        TileLayer *layer = &map->tile_layers[l];
+        for (int i = 0; i < layer->chunk_count; i++) {
+            TileChunk *chunk = &layer->chunks[i];
+            if (chunk->width <= 0 || chunk->height <= 0) {
+                chunk->source_length = 0;
+                continue;
+            }
+            if (!any) {
+                map->chunk_width = chunk->width;
+                map->chunk_height = chunk->height;
+                min_x = chunk->x;
+                min_y = chunk->y;
+                max_x = chunk->x + chunk->width;
+                max_y = chunk->y + chunk->height;
+                any = true;
+            }
+            if (chunk->x < min_x) min_x = chunk->x;
+            if (chunk->y < min_y) min_y = chunk->y;
+            if (chunk->x + chunk->width > max_x) max_x = chunk->x + chunk->width;
+            if (chunk->y + chunk->height > max_y) max_y = chunk->y + chunk->height;
+        }
+    }
+    if (!any) {
+        map->chunk_width = 16;
+        map->chunk_height = 16;
+    }
+
+    map->startx = min_x;
+    map->starty = min_y;
+    map->width = max_x - min_x;
+    map->height = max_y - min_y;
+    map->chunk_budget = TILEMAP_CHUNK_BUDGET_DEFAULT;
+
+    for (int l = 0; l < map->tile_layer_count; l++) {
+        if (map->tile_layers[l].chunk_count > 0) build_chunk_table(map, &map->tile_layers[l]);
+    }
+}
+
+// Resolve every animated GID to its frame at map->anim_time
+static void advance_animations(TileMap *map) {
+    bool changed = false;
+    for (int i = 0; i < map->anim_count; i++) {
+        uint32_t gid = map->anim_gids[i];
+        const TileSource *source = &map->tile_sources[gid];
+        const TileAnim *anim = source->anim;
+        int t = (int)fmod(map->anim_time, (double)anim->total_duration);
+        int acc = 0;
+        uint32_t current = gid;
+        for (int f = 0; f < anim->frame_count; f++) {
+            acc += anim->frames[f].duration;
+            if (t < acc) {
+                int frame_gid = map->tilesets[source->tileset].firstgid + anim->frames[f].tileid;
+                if (frame_gid > 0 && frame_gid < map->tile_source_count &&
+                    map->tile_sources[frame_gid].tileset >= 0) {
+                    current = (uint32_t)frame_gid;
                 }
+                break;
             }
         }
+        if (map->anim_current[i] != current) changed = true;
+        map->anim_current[i] = current;
     }
+    if (changed) map->anim_version++;
+}
 
-    cJSON *data = cJSON_GetObjectItem(layer_json, "data");
-    if (data && cJSON_IsArray(data)) {
-        int count = cJSON_GetArraySize(data);
-        layer->data = (uint32_t *)malloc(count * sizeof(uint32_t));
-        if (layer->data) {
-            int i = 0;
-            cJSON *gid;
-            cJSON_ArrayForEach(gid, data) {
-                layer->data[i++] = (uint32_t)gid->valuedouble;
+// Source rects of a tileset's tiles normalized to its image size, for the
+// quad batches
+static void set_tileset_uvs(TileMap *map, int tileset) {
+    const TilesetInfo *ts = &map->tilesets[tileset];
+    if (ts->imagewidth <= 0 || ts->imageheight <= 0) return;
+    for (int gid = ts->firstgid; gid < ts->firstgid + ts->tilecount && gid < map->tile_source_count; gid++) {
+        TileSource *source = &map->tile_sources[gid];
+        if (gid <= 0 || source->tileset != tileset) continue;
+        source->uv[0] = source->src.x / ts->imagewidth;
+        source->uv[1] = source->src.y / ts->imageheight;
+        source->uv[2] = (source->src.x + source->src.width) / ts->imagewidth;
+        source->uv[3] = (source->src.y + source->src.height) / ts->imageheight;
+    }
+}
+
+// One TileSource per GID, so drawing never searches the tilesets or works out
+// a source rect. Tiles of a tileset without a usable grid get no source and
+// are never drawn. Tilesets are in firstgid order; a later one wins overlaps.
+static void build_tile_sources(TileMap *map) {
+    int count = 1;
+    for (int t = 0; t < map->tileset_count; t++) {
+        const TilesetInfo *ts = &map->tilesets[t];
+        if (ts->columns > 0 && ts->tilecount > 0 && ts->firstgid > 0 &&
+            ts->firstgid + ts->tilecount > count) {
+            count = ts->firstgid + ts->tilecount;
+        }
+    }
+    if (count > (int)TILE_DESC_SOURCE_MASK) count = (int)TILE_DESC_SOURCE_MASK;
+
+    map->tile_sources = (TileSource *)arena_alloc_array(map->arena, count, sizeof(TileSource));
+    if (!map->tile_sources) return;
+    map->tile_source_count = count;
+    for (int gid = 0; gid < count; gid++) map->tile_sources[gid].tileset = -1;
+
+    for (int t = 0; t < map->tileset_count; t++) {
+        const TilesetInfo *ts = &map->tilesets[t];
+        if (ts->columns <= 0 || ts->tilecount <= 0 || ts->firstgid <= 0) continue;
+        for (int local_id = 0; local_id < ts->tilecount && ts->firstgid + local_id < count; local_id++) {
+            TileSource *source = &map->tile_sources[ts->firstgid + local_id];
+            int col = local_id % ts->columns;
+            int row = local_id / ts->columns;
+            source->src = (Rectangle){
+                (float)(ts->margin + col * (ts->tilewidth + ts->spacing)),
+                (float)(ts->margin + row * (ts->tileheight + ts->spacing)),
+                (float)ts->tilewidth,
+                (float)ts->tileheight
+            };
+            source->tileset = t;
+            source->anim = ts->anim_lookup && ts->anim_lookup[local_id].frame_count > 0 &&
+                           ts->anim_lookup[local_id].total_duration > 0
+                ? &ts->anim_lookup[local_id] : NULL;
+        }
+        set_tileset_uvs(map, t);
+    }
+
+    // Compact slots for the animated GIDs, so tilemap_update() only visits those
+    int anim_count = 0;
+    for (int gid = 0; gid < count; gid++) {
+        if (map->tile_sources[gid].anim) anim_count++;
+    }
+    if (anim_count == 0) return;
+    map->anim_gids = (uint32_t *)arena_alloc_array(map->arena, anim_count, sizeof(uint32_t));
+    map->anim_current = (uint32_t *)arena_alloc_array(map->arena, anim_count, sizeof(uint32_t));
+    if (!map->anim_gids || !map->anim_current) {
+        // Drawn as static tiles
+        for (int gid = 0; gid < count; gid++) map->tile_sources[gid].anim = NULL;
+        return;
+    }
+    for (int gid = 0; gid < count; gid++) {
+        TileSource *source = &map->tile_sources[gid];
+        if (!source->anim) continue;
+        source->anim_slot = map->anim_count;
+        map->anim_gids[map->anim_count++] = (uint32_t)gid;
+    }
+    advance_animations(map);
+}
+
+static void fill_descriptors(const TileMap *map, const uint32_t *data, uint32_t *desc, int cells) {
+    for (int i = 0; i < cells; i++) {
+        uint32_t gid = data[i] & GID_MASK;
+        const TileSource *source = gid < (uint32_t)map->tile_source_count ? &map->tile_sources[gid] : NULL;
+        if (gid == 0 || !source || source->tileset < 0) {
+            desc[i] = 0;
+            continue;
+        }
+        uint32_t flips = data[i] & (FLIPPED_H_FLAG | FLIPPED_V_FLAG | FLIPPED_D_FLAG);
+        desc[i] = source->anim ? flips | TILE_DESC_ANIMATED | (uint32_t)source->anim_slot : flips | gid;
+    }
+}
+
+static bool compact_enabled = false;
+
+void tilemap_set_compact_layers(bool enabled) {
+    compact_enabled = enabled;
+}
+
+// Descriptors of a compact layer, packed from a temporary full array. False
+// leaves the layer to a plain descriptor array.
+static bool pack_descriptors(TileMap *map, TileLayer *layer, int cells) {
+    if (!map->desc_run) {
+        int widest = 0;
+        for (int l = 0; l < map->tile_layer_count; l++) {
+            if (map->tile_layers[l].width > widest) widest = map->tile_layers[l].width;
+        }
+        map->desc_run = (uint32_t *)arena_alloc_array(map->arena, widest, sizeof(uint32_t));
+        if (!map->desc_run) return false;
+    }
+    uint32_t *desc = (uint32_t *)malloc(cells * sizeof(uint32_t));
+    if (!desc) return false;
+    fill_descriptors(map, layer->data, desc, cells);
+    bool packed = tile_palette_build(&layer->packed, desc, layer->width, layer->height * layer->planes);
+    free(desc);
+    return packed;
+}
+
+// Tile sources plus a descriptor array for every finite layer (packed, with
+// tilemap_set_compact_layers()); chunks get theirs when they are decoded
+static void build_draw_descriptors(TileMap *map) {
+    double start = platform_time_seconds();
+    build_tile_sources(map);
+    size_t plain_bytes = 0, packed_bytes = 0;
+    for (int l = 0; l < map->tile_layer_count; l++) {
+        TileLayer *layer = &map->tile_layers[l];
+        int cells = layer->width * layer->height * layer->planes;
+        if (!layer->data || cells <= 0) continue;
+        if (compact_enabled && pack_descriptors(map, layer, cells)) {
+            plain_bytes += cells * sizeof(uint32_t);
+            packed_bytes += layer->packed.bytes;
+            continue;
+        }
+        layer->desc = (uint32_t *)arena_alloc_array(map->arena, cells, sizeof(uint32_t));
+        if (layer->desc) fill_descriptors(map, layer->data, layer->desc, cells);
+    }
+    map->load_stats.desc_ms = (platform_time_seconds() - start) * 1000.0;
+    if (packed_bytes > 0) {
+        TILEMAP_LOG("[tilemap] Compact layers: descriptors in %.1f KB instead of %.1f KB\n",
+                    packed_bytes / 1024.0, plain_bytes / 1024.0);
+    }
+}
+
+// Finite layer with tiles, as plain or packed descriptors
+static bool layer_has_cells(const TileLayer *layer) {
+    return layer->desc || layer->packed.chunks;
+}
+
+// Descriptors of cells [x0, x1) of row y of one plane of a finite layer: the
+// descriptor array itself, or a compact layer's run decoded into a scratch
+// row (valid until the next call)
+static const uint32_t *layer_desc_run(const TileMap *map, const TileLayer *layer, int plane, int y,
+                                      int x0, int x1) {
+    if (layer->desc) return layer->desc + ((size_t)plane * layer->height + y) * layer->width + x0;
+    tile_palette_decode_run(&layer->packed, plane * layer->height + y, x0, x1, map->desc_run);
+    return map->desc_run;
+}
+
+static uint32_t string_hash(const char *string) {
+    uint32_t hash = 2166136261u;
+    for (const unsigned char *c = (const unsigned char *)string; *c; c++) hash = (hash ^ *c) * 16777619u;
+    return hash;
+}
+
+static int find_string(const StringTable *table, const char *string, uint32_t *slot_out) {
+    if (!table->slots) return -1;
+    uint32_t slot = string_hash(string) & (uint32_t)table->slot_mask;
+    while (table->slots[slot]) {
+        int id = table->slots[slot] - 1;
+        if (strcmp(table->strings[id], string) == 0) return id;
+        slot = (slot + 1) & (uint32_t)table->slot_mask;
+    }
+    if (slot_out) *slot_out = slot;
+    return -1;
+}
+
+// Room for `extra` more strings. Outgrown arrays stay in the arena.
+static bool reserve_strings(TileMap *map, int extra) {
+    StringTable *table = &map->strings;
+    if (table->count + extra <= table->capacity) return true;
+    int capacity = table->capacity ? table->capacity : 64;
+    while (capacity < table->count + extra) capacity *= 2;
+    int slot_count = capacity * 2;
+    const char **strings = (const char **)arena_alloc_array(map->arena, capacity, sizeof(const char *));
+    int *slots = (int *)arena_alloc_array(map->arena, slot_count, sizeof(int));
+    if (!strings || !slots) return false;
+    if (table->count > 0) memcpy(strings, table->strings, table->count * sizeof(const char *));
+    for (int id = 0; id < table->count; id++) {
+        uint32_t slot = string_hash(strings[id]) & (uint32_t)(slot_count - 1);
+        while (slots[slot]) slot = (slot + 1) & (uint32_t)(slot_count - 1);
+        slots[slot] = id + 1;
+    }
+    table->strings = strings;
+    table->slots = slots;
+    table->capacity = capacity;
+    table->slot_mask = slot_count - 1;
+    return true;
+}
+
+// Id of `string`, added (copied into the arena) if new; 0 ("") on failure
+static int intern(TileMap *map, const char *string) {
+    StringTable *table = &map->strings;
+    if (!string || !string[0] || !reserve_strings(map, 1)) return 0;
+    if (table->count == 0) {
+        // Id 0 is always ""
+        table->strings[0] = "";
+        table->slots[string_hash("") & (uint32_t)table->slot_mask] = 1;
+        table->count = 1;
+    }
+    uint32_t slot = 0;
+    int id = find_string(table, string, &slot);
+    if (id >= 0) return id;
+
+    size_t length = strlen(string);
+    char *copy = (char *)arena_alloc(map->arena, length + 1);
+    if (!copy) return 0;
+    memcpy(copy, string, length + 1);
+    table->strings[table->count] = copy;
+    table->slots[slot] = table->count + 1;
+    return table->count++;
+}
+
+const char *tilemap_string(const TileMap *map, int id) {
+    if (!map || id <= 0 || id >= map->strings.count) return "";
+    return map->strings.strings[id];
+}
+
+int tilemap_string_id(const TileMap *map, const char *string) {
+    if (!map || !string) return -1;
+    if (!string[0]) return 0;
+    return find_string(&map->strings, string, NULL);
+}
+
+// Tiled rotates objects around their top-left corner
+static Rectangle object_bounds(const MapObject *obj) {
+    float ox = (float)obj->x, oy = (float)obj->y;
+    float ow = (float)obj->width, oh = (float)obj->height;
+    if (obj->rotation == 0.0) return (Rectangle){ ox, oy, ow, oh };
+
+    float rad = (float)(obj->rotation * (3.14159265358979323846 / 180.0));
+    float cos_r = cosf(rad), sin_r = sinf(rad);
+    float cx[4] = { 0, ow, ow, 0 };
+    float cy[4] = { 0, 0, oh, oh };
+    float min_x = ox, max_x = ox, min_y = oy, max_y = oy;
+    for (int c = 0; c < 4; c++) {
+        float rx = ox + cx[c] * cos_r - cy[c] * sin_r;
+        float ry = oy + cx[c] * sin_r + cy[c] * cos_r;
+        if (rx < min_x) min_x = rx;
+        if (rx > max_x) max_x = rx;
+        if (ry < min_y) min_y = ry;
+        if (ry > max_y) max_y = ry;
+    }
+    return (Rectangle){ min_x, min_y, max_x - min_x, max_y - min_y };
+}
+
+#define OBJECT_KEY_TYPE 0
+#define OBJECT_KEY_NAME 1
+
+static uint32_t object_key_hash(int kind, int layer, int key) {
+    return ((uint32_t)kind * 2654435761u) ^ ((uint32_t)layer * 73856093u) ^ ((uint32_t)key * 19349663u);
+}
+
+static const ObjectKeyRange *find_object_key(const TileMap *map, int kind, int layer, int key) {
+    if (!map->object_keys || key < 0) return NULL;
+    uint32_t slot = object_key_hash(kind, layer, key) & (uint32_t)map->object_key_mask;
+    while (map->object_keys[slot].count > 0) {
+        const ObjectKeyRange *range = &map->object_keys[slot];
+        if (range->kind == kind && range->layer == layer && range->key == key) return range;
+        slot = (slot + 1) & (uint32_t)map->object_key_mask;
+    }
+    return NULL;
+}
+
+// One (kind, layer, key) entry per object and index key, sorted into ranges
+typedef struct ObjectKeyEntry {
+    int kind, layer, key;
+    int order;                // position in map order, keeps sorts stable
+    MapObject *object;
+} ObjectKeyEntry;
+
+static int compare_object_keys(const void *a, const void *b) {
+    const ObjectKeyEntry *x = (const ObjectKeyEntry *)a, *y = (const ObjectKeyEntry *)b;
+    if (x->kind != y->kind) return x->kind - y->kind;
+    if (x->layer != y->layer) return x->layer - y->layer;
+    if (x->key != y->key) return x->key - y->key;
+    return x->order - y->order;
+}
+
+static bool same_object_key(const ObjectKeyEntry *a, const ObjectKeyEntry *b) {
+    return a->kind == b->kind && a->layer == b->layer && a->key == b->key;
+}
+
+// Grid cell of a world position along one axis, clamped to the grid
+static int object_cell(float position, float origin, float cell_size, int cells) {
+    int cell = (int)floorf((position - origin) / cell_size);
+    return cell < 0 ? 0 : cell >= cells ? cells - 1 : cell;
+}
+
+static void object_grid_origin(const TileMap *map, float *x, float *y, float *cell_w, float *cell_h) {
+    *x = (float)(map->startx * map->tilewidth);
+    *y = (float)(map->starty * map->tileheight);
+    *cell_w = (float)(TILEMAP_OBJECT_CELL * (map->tilewidth > 0 ? map->tilewidth : 1));
+    *cell_h = (float)(TILEMAP_OBJECT_CELL * (map->tileheight > 0 ? map->tileheight : 1));
+}
+
+static void build_object_grid(TileMap *map, ObjectLayer *layer) {
+    float ox, oy, cw, ch;
+    object_grid_origin(map, &ox, &oy, &cw, &ch);
+    int cols = (map->width + TILEMAP_OBJECT_CELL - 1) / TILEMAP_OBJECT_CELL;
+    int rows = (map->height + TILEMAP_OBJECT_CELL - 1) / TILEMAP_OBJECT_CELL;
+    if (cols < 1) cols = 1;
+    if (rows < 1) rows = 1;
+
+    // Counting pass, prefix sums, then the fill pass (grid_start doubles as
+    // the write cursor and is shifted back afterwards)
+    int *start = (int *)arena_alloc_array(map->arena, (size_t)cols * rows + 1, sizeof(int));
+    if (!start) return;
+    size_t total = 0;
+    for (int i = 0; i < layer->object_count; i++) {
+        Rectangle b = layer->objects[i].bounds;
+        int x0 = object_cell(b.x, ox, cw, cols), x1 = object_cell(b.x + b.width, ox, cw, cols);
+        int y0 = object_cell(b.y, oy, ch, rows), y1 = object_cell(b.y + b.height, oy, ch, rows);
+        for (int y = y0; y <= y1; y++) {
+            for (int x = x0; x <= x1; x++) start[y * cols + x + 1]++;
+        }
+        total += (size_t)(x1 - x0 + 1) * (y1 - y0 + 1);
+    }
+    for (int c = 0; c < cols * rows; c++) start[c + 1] += start[c];
+    int *objects = (int *)arena_alloc_array(map->arena, total > 0 ? total : 1, sizeof(int));
+    if (!objects) return;
+    for (int i = 0; i < layer->object_count; i++) {
+        Rectangle b = layer->objects[i].bounds;
+        int x0 = object_cell(b.x, ox, cw, cols), x1 = object_cell(b.x + b.width, ox, cw, cols);
+        int y0 = object_cell(b.y, oy, ch, rows), y1 = object_cell(b.y + b.height, oy, ch, rows);
+        for (int y = y0; y <= y1; y++) {
+            for (int x = x0; x <= x1; x++) objects[start[y * cols + x]++] = i;
+        }
+    }
+    for (int c = cols * rows; c > 0; c--) start[c] = start[c - 1];
+    start[0] = 0;
+
+    layer->grid_cols = cols;
+    layer->grid_rows = rows;
+    layer->grid_start = start;
+    layer->grid_objects = objects;
+}
+
+// Intern object layer names; compute object bounds; build the (kind, layer,
+// key) ranges and each layer's grid
+static void build_object_index(TileMap *map) {
+    double start = platform_time_seconds();
+    int object_count = 0;
+    for (int l = 0; l < map->object_layer_count; l++) object_count += map->object_layers[l].object_count;
+    reserve_strings(map, map->object_layer_count);
+
+    // Each object is listed under its type and name, in its layer and in "any layer"
+    ObjectKeyEntry *entries = object_count > 0
+        ? (ObjectKeyEntry *)malloc((size_t)object_count * 4 * sizeof(ObjectKeyEntry)) : NULL;
+    int entry_count = 0, order = 0;
+    for (int l = 0; l < map->object_layer_count; l++) {
+        ObjectLayer *layer = &map->object_layers[l];
+        layer->name_id = intern(map, layer->name);
+        for (int i = 0; i < layer->object_count; i++, order++) {
+            MapObject *obj = &layer->objects[i];
+            obj->bounds = object_bounds(obj);
+            if (!entries) continue;
+            entries[entry_count++] = (ObjectKeyEntry){ OBJECT_KEY_TYPE, l, obj->type_id, order, obj };
+            entries[entry_count++] = (ObjectKeyEntry){ OBJECT_KEY_TYPE, -1, obj->type_id, order, obj };
+            entries[entry_count++] = (ObjectKeyEntry){ OBJECT_KEY_NAME, l, obj->name_id, order, obj };
+            entries[entry_count++] = (ObjectKeyEntry){ OBJECT_KEY_NAME, -1, obj->name_id, order, obj };
+        }
+        build_object_grid(map, layer);
+    }
+
+    if (entry_count > 0) {
+        qsort(entries, entry_count, sizeof(ObjectKeyEntry), compare_object_keys);
+        int range_count = 0;
+        for (int i = 0; i < entry_count; i++) {
+            if (i == 0 || !same_object_key(&entries[i - 1], &entries[i])) range_count++;
+        }
+        int slot_count = 16;
+        while (slot_count < range_count * 2) slot_count *= 2;
+        map->object_refs = (MapObject **)arena_alloc_array(map->arena, entry_count, sizeof(MapObject *));
+        map->object_keys = (ObjectKeyRange *)arena_alloc_array(map->arena, slot_count, sizeof(ObjectKeyRange));
+        if (map->object_refs && map->object_keys) {
+            map->object_key_mask = slot_count - 1;
+            for (int i = 0; i < entry_count;) {
+                const ObjectKeyEntry *first = &entries[i];
+                int count = 0;
+                while (i + count < entry_count && same_object_key(first, &entries[i + count])) {
+                    map->object_refs[i + count] = entries[i + count].object;
+                    count++;
+                }
+                uint32_t slot = object_key_hash(first->kind, first->layer, first->key) & (uint32_t)map->object_key_mask;
+                while (map->object_keys[slot].count > 0) slot = (slot + 1) & (uint32_t)map->object_key_mask;
+                map->object_keys[slot] = (ObjectKeyRange){ first->kind, first->layer, first->key, i, count };
+                i += count;
             }
+        } else {
+            map->object_keys = NULL;
         }
     }
+    free(entries);
+    map->load_stats.index_ms = (platform_time_seconds() - start) * 1000.0;
 }
 
-static void parse_object_layer(cJSON *layer_json, ObjectLayer *layer) {
+static void parse_object_layer(cJSON *layer_json, ObjectLayer *layer, Arena *arena) {
     cJSON *item;
 
     item = cJSON_GetObjectItem(layer_json, "name");
@@ -229,24 +802,18 @@ static void parse_object_layer(cJSON *layer_json, ObjectLayer *layer) {
 
     cJSON *objects = cJSON_GetObjectItem(layer_json, "objects");
     if (objects && cJSON_IsArray(objects)) {
-        layer->object_count = cJSON_GetArraySize(objects);
-        layer->objects = (MapObject *)calloc(layer->object_count, sizeof(MapObject));
+        layer->objects = (MapObject *)arena_alloc_array(arena, cJSON_GetArraySize(objects), sizeof(MapObject));
         if (layer->objects) {
+            layer->object_count = cJSON_GetArraySize(objects);
             int i = 0;
             cJSON *obj;
             cJSON_ArrayForEach(obj, objects) {
                 MapObject *mo = &layer->objects[i++];
 
+                // name and type are interned by intern_parsed_strings()
                 item = cJSON_GetObjectItem(obj, "id");
                 if (item) mo->id = item->valueint;
 
-                item = cJSON_GetObjectItem(obj, "name");
-                strncpy_safe(mo->name, item ? item->valuestring : "", sizeof(mo->name));
-
-                item = cJSON_GetObjectItem(obj, "type");
-                if (!item) item = cJSON_GetObjectItem(obj, "class");
-                strncpy_safe(mo->type, item ? item->valuestring : "", sizeof(mo->type));
-
                 item = cJSON_GetObjectItem(obj, "x");
                 if (item) mo->x = item->valuedouble;
 
@@ -291,309 +858,3054 @@ static void parse_object_layer(cJSON *layer_json, ObjectLayer *layer) {
     }
 }
 
-TileMap *tilemap_load(const char *path) {
-    char *text = LoadFileText(path);
-    if (!text) {
-        printf("[tilemap] ERROR: Could not read file: %s\n", path);
-        return NULL;
+// Infinite map chunk: position and size are read, the "data" value is only
+// located (offsets relative to `base`) and skipped
+static bool stream_chunk(JsonStream *js, const char *base, TileChunk *out) {
+    if (!json_stream_begin_object(js)) return false;
+
+    char key[16];
+    while (json_stream_next_key(js, key, sizeof(key))) {
+        if (strcmp(key, "data") == 0) {
+            json_stream_peek(js);
+            out->source_offset = (size_t)(js->cur - base);
+            if (!json_stream_skip_value(js)) return false;
+            out->source_length = (size_t)(js->cur - base) - out->source_offset;
+            continue;
+        }
+
+        cJSON *value = json_stream_parse_value(js);
+        if (!value) return false;
+        if (strcmp(key, "x") == 0) out->x = value->valueint;
+        else if (strcmp(key, "y") == 0) out->y = value->valueint;
+        else if (strcmp(key, "width") == 0) out->width = value->valueint;
+        else if (strcmp(key, "height") == 0) out->height = value->valueint;
+        cJSON_Delete(value);
     }
+    return !js->error;
+}
 
-    fix_json_backslashes(text);
-    cJSON *root = cJSON_Parse(text);
-    UnloadFileText(text);
-    if (!root) {
-        printf("[tilemap] ERROR: JSON parse failed for: %s\n", path);
-        return NULL;
+static bool stream_chunks(JsonStream *js, const char *base, StreamedLayer *out) {
+    int capacity = 0;
+    if (!json_stream_begin_array(js)) return false;
+    while (json_stream_next_element(js)) {
+        if (out->chunk_count == capacity) {
+            capacity = capacity ? capacity * 2 : 64;
+            TileChunk *grown = (TileChunk *)realloc(out->chunks, capacity * sizeof(TileChunk));
+            if (!grown) return false;
+            out->chunks = grown;
+        }
+        TileChunk *chunk = &out->chunks[out->chunk_count++];
+        memset(chunk, 0, sizeof(*chunk));
+        if (!stream_chunk(js, base, chunk)) return false;
     }
+    return !js->error;
+}
 
-    TileMap *map = (TileMap *)calloc(1, sizeof(TileMap));
-    if (!map) {
-        cJSON_Delete(root);
-        return NULL;
+static bool stream_layer(JsonStream *js, const char *base, StreamedLayer *out) {
+    out->json = cJSON_CreateObject();
+    if (!out->json || !json_stream_begin_object(js)) return false;
+
+    char key[64];
+    while (json_stream_next_key(js, key, sizeof(key))) {
+        if (strcmp(key, "chunks") == 0 && json_stream_peek(js) == '[') {
+            if (!stream_chunks(js, base, out)) return false;
+        } else if (strcmp(key, "data") == 0 && (json_stream_peek(js) == '[' || json_stream_peek(js) == '"')) {
+            out->data_offset = (size_t)(js->cur - base);
+            bool skipped = *js->cur == '[' ? json_stream_skip_flat_array(js) : json_stream_skip_value(js);
+            if (!skipped) return false;
+            out->data_length = (size_t)(js->cur - base) - out->data_offset;
+        } else {
+            cJSON *value = json_stream_parse_value(js);
+            if (!value) return false;
+            cJSON_AddItemToObject(out->json, key, value);
+        }
     }
+    return !js->error;
+}
 
-    // Get base directory for resolving relative paths
-    char base_dir[512];
-    get_directory(path, base_dir, sizeof(base_dir));
+static void free_streamed_layers(StreamedLayer *layers, int count) {
+    for (int i = 0; i < count; i++) {
+        cJSON_Delete(layers[i].json);
+        free(layers[i].chunks);
+    }
+    free(layers);
+}
 
-    // Map dimensions
-    cJSON *item;
-    item = cJSON_GetObjectItem(root, "width");
-    if (item) map->width = item->valueint;
+// Stream the top-level map object. "layers" entries go through stream_layer();
+// every other member (sizes, tilesets, properties) becomes a small cJSON tree.
+static cJSON *stream_map(JsonStream *js, const char *base, StreamedLayer **out_layers, int *out_count) {
+    StreamedLayer *layers = NULL;
+    int count = 0, capacity = 0;
 
-    item = cJSON_GetObjectItem(root, "height");
-    if (item) map->height = item->valueint;
+    cJSON *root = cJSON_CreateObject();
+    if (!root || !json_stream_begin_object(js)) goto fail;
 
-    item = cJSON_GetObjectItem(root, "tilewidth");
-    if (item) map->tilewidth = item->valueint;
+    char key[64];
+    while (json_stream_next_key(js, key, sizeof(key))) {
+        if (strcmp(key, "layers") == 0 && json_stream_peek(js) == '[') {
+            json_stream_begin_array(js);
+            while (json_stream_next_element(js)) {
+                if (count == capacity) {
+                    capacity = capacity ? capacity * 2 : 8;
+                    StreamedLayer *grown = (StreamedLayer *)realloc(layers, capacity * sizeof(StreamedLayer));
+                    if (!grown) goto fail;
+                    layers = grown;
+                }
+                StreamedLayer *layer = &layers[count++];
+                memset(layer, 0, sizeof(*layer));
+                if (!stream_layer(js, base, layer)) goto fail;
+            }
+        } else {
+            cJSON *value = json_stream_parse_value(js);
+            if (!value) goto fail;
+            cJSON_AddItemToObject(root, key, value);
+        }
+    }
+    if (js->error) goto fail;
 
-    item = cJSON_GetObjectItem(root, "tileheight");
-    if (item) map->tileheight = item->valueint;
+    *out_layers = layers;
+    *out_count = count;
+    return root;
 
-    printf("[tilemap] Map: %dx%d tiles, %dx%d px/tile\n",
-           map->width, map->height, map->tilewidth, map->tileheight);
+fail:
+    free_streamed_layers(layers, count);
+    cJSON_Delete(root);
+    return NULL;
+}
 
-    // Parse tilesets
-    cJSON *tilesets = cJSON_GetObjectItem(root, "tilesets");
-    if (tilesets && cJSON_IsArray(tilesets)) {
-        map->tileset_count = cJSON_GetArraySize(tilesets);
-        map->tilesets = (TilesetInfo *)calloc(map->tileset_count, sizeof(TilesetInfo));
+// One tileset entry of the map: embedded, or an external .tsj to read
+static void parse_tileset_entry(cJSON *ts_entry, TilesetInfo *ts, const char *base_dir, Arena *arena) {
+    // Get firstgid from the map entry (always present)
+    cJSON *item = cJSON_GetObjectItem(ts_entry, "firstgid");
+    if (item) ts->firstgid = item->valueint;
 
-        int i = 0;
-        cJSON *ts_entry;
-        cJSON_ArrayForEach(ts_entry, tilesets) {
-            TilesetInfo *ts = &map->tilesets[i++];
-
-            // Get firstgid from the map entry (always present)
-            item = cJSON_GetObjectItem(ts_entry, "firstgid");
-            if (item) ts->firstgid = item->valueint;
-
-            // Check if this is an external tileset reference
-            item = cJSON_GetObjectItem(ts_entry, "source");
-            if (item && item->valuestring) {
-                // External tileset — load from file
-                char ts_path[512] = {0};
-                char source[256];
-                strncpy_safe(source, item->valuestring, sizeof(source));
-
-                // Normalize backslashes and strip leading ./
-                for (char *p = source; *p; p++) {
-                    if (*p == '\\') *p = '/';
-                }
-                char *src = source;
-                if (src[0] == '.' && src[1] == '/') src += 2;
+    // Check if this is an external tileset reference
+    item = cJSON_GetObjectItem(ts_entry, "source");
+    if (!item || !item->valuestring) {
+        // Embedded tileset
+        parse_tileset_json(ts_entry, ts, base_dir, arena);
+        return;
+    }
 
-                // Try the source path as-is first
-                snprintf(ts_path, sizeof(ts_path), "%s%s", base_dir, src);
+    // External tileset — load from file
+    char ts_path[512] = {0};
+    char source[256];
+    strncpy_safe(source, item->valuestring, sizeof(source));
 
-                // If it's a .tsx reference, try .tsj instead
-                char *ext = strrchr(ts_path, '.');
-                if (ext && strcmp(ext, ".tsx") == 0) {
-                    strcpy(ext, ".tsj");
-                }
+    // Normalize backslashes and strip leading ./
+    for (char *p = source; *p; p++) {
+        if (*p == '\\') *p = '/';
+    }
+    char *src = source;
+    if (src[0] == '.' && src[1] == '/') src += 2;
 
-                printf("[tilemap] Loading external tileset: %s\n", ts_path);
-                char *ts_text = LoadFileText(ts_path);
-                if (ts_text) {
-                    fix_json_backslashes(ts_text);
-                    cJSON *ts_root = cJSON_Parse(ts_text);
-                    UnloadFileText(ts_text);
-                    if (ts_root) {
-                        int saved_firstgid = ts->firstgid;
-                        // Get tileset base dir for resolving image path
-                        char ts_base_dir[512];
-                        get_directory(ts_path, ts_base_dir, sizeof(ts_base_dir));
-                        parse_tileset_json(ts_root, ts, ts_base_dir);
-                        ts->firstgid = saved_firstgid;
-                        cJSON_Delete(ts_root);
-                    } else {
-                        printf("[tilemap] WARNING: Failed to parse tileset JSON: %s\n", ts_path);
-                    }
-                } else {
-                    printf("[tilemap] WARNING: Could not read tileset file: %s\n", ts_path);
-                }
-            } else {
-                // Embedded tileset
-                parse_tileset_json(ts_entry, ts, base_dir);
-            }
+    // Try the source path as-is first
+    snprintf(ts_path, sizeof(ts_path), "%s%s", base_dir, src);
 
-            printf("[tilemap] Tileset: firstgid=%d, %dx%d tiles, %d columns, texture=%dx%d\n",
-                   ts->firstgid, ts->tilewidth, ts->tileheight, ts->columns,
-                   ts->texture.width, ts->texture.height);
-        }
+    // If it's a .tsx reference, try .tsj instead
+    char *ext = strrchr(ts_path, '.');
+    if (ext && strcmp(ext, ".tsx") == 0) {
+        strcpy(ext, ".tsj");
     }
 
-    // Count layers by type
-    cJSON *layers = cJSON_GetObjectItem(root, "layers");
-    if (layers && cJSON_IsArray(layers)) {
-        int tile_count = 0, obj_count = 0;
-        cJSON *layer;
-        cJSON_ArrayForEach(layer, layers) {
-            item = cJSON_GetObjectItem(layer, "type");
-            if (item && item->valuestring) {
-                if (strcmp(item->valuestring, "tilelayer") == 0) tile_count++;
-                else if (strcmp(item->valuestring, "objectgroup") == 0) obj_count++;
-            }
-        }
+    TILEMAP_LOG("[tilemap] Loading external tileset: %s\n", ts_path);
+    memcpy(ts->source_path, ts_path, sizeof(ts->source_path));
+    char *ts_text = LoadFileText(ts_path);
+    if (!ts_text) {
+        printf("[tilemap] WARNING: Could not read tileset file: %s\n", ts_path);
+        return;
+    }
+    json_fix_backslashes(ts_text, strlen(ts_text));
+    // Runs on load tasks: cJSON_Parse is reentrant apart from the global
+    // cJSON_GetErrorPtr() position, which is never read here
+    cJSON *ts_root = cJSON_Parse(ts_text);
+    UnloadFileText(ts_text);
+    if (!ts_root) {
+        printf("[tilemap] WARNING: Failed to parse tileset JSON: %s\n", ts_path);
+        return;
+    }
+    int saved_firstgid = ts->firstgid;
+    // Get tileset base dir for resolving image path
+    char ts_base_dir[512];
+    get_directory(ts_path, ts_base_dir, sizeof(ts_base_dir));
+    parse_tileset_json(ts_root, ts, ts_base_dir, arena);
+    ts->firstgid = saved_firstgid;
+    cJSON_Delete(ts_root);
+}
 
-        map->tile_layer_count = tile_count;
-        map->object_layer_count = obj_count;
-        if (tile_count > 0)
-            map->tile_layers = (TileLayer *)calloc(tile_count, sizeof(TileLayer));
-        if (obj_count > 0)
-            map->object_layers = (ObjectLayer *)calloc(obj_count, sizeof(ObjectLayer));
+static int load_threads = TILEMAP_LOAD_THREADS_AUTO;
+static bool flatten_enabled = false;
 
-        int ti = 0, oi = 0;
-        cJSON_ArrayForEach(layer, layers) {
-            item = cJSON_GetObjectItem(layer, "type");
-            if (!item || !item->valuestring) continue;
+void tilemap_set_load_threads(int threads) {
+    if (threads != TILEMAP_LOAD_THREADS_AUTO) {
+        if (threads < 1) threads = 1;
+        if (threads > TASK_POOL_MAX_THREADS) threads = TASK_POOL_MAX_THREADS;
+    }
+    load_threads = threads;
+}
+
+// Threads for a parallel step of `tasks` load tasks
+static int load_thread_count(int tasks) {
+    int threads = load_threads == TILEMAP_LOAD_THREADS_AUTO ? platform_cpu_count() : load_threads;
+    if (threads > TASK_POOL_MAX_THREADS) threads = TASK_POOL_MAX_THREADS;
+    if (threads > tasks) threads = tasks;
+    return threads > 1 ? threads : 1;
+}
 
-            if (strcmp(item->valuestring, "tilelayer") == 0 && ti < tile_count) {
-                parse_tile_layer(layer, &map->tile_layers[ti]);
-                printf("[tilemap] Tile layer %d: \"%s\" (%dx%d)\n",
-                       ti, map->tile_layers[ti].name,
-                       map->tile_layers[ti].width, map->tile_layers[ti].height);
-                ti++;
-            } else if (strcmp(item->valuestring, "objectgroup") == 0 && oi < obj_count) {
-                parse_object_layer(layer, &map->object_layers[oi]);
-                printf("[tilemap] Object layer %d: \"%s\" (%d objects)\n",
-                       oi, map->object_layers[oi].name,
-                       map->object_layers[oi].object_count);
-                oi++;
+void tilemap_set_flatten_layers(bool enabled) {
+    flatten_enabled = enabled;
+}
+
+static bool layers_draw_alike(const TileLayer *a, const TileLayer *b) {
+    return a->data && b->data && a->width == b->width && a->height == b->height &&
+           a->visible == b->visible && a->opacity == b->opacity && a->elevation == b->elevation &&
+           a->render_layer == b->render_layer && a->shader == b->shader;
+}
+
+// Stack the tiles of `count` layers into the first one: each cell's tiles
+// are packed into planes 0, 1, ... in layer order, so there are only as many
+// planes as the deepest cell needs
+static bool merge_layers(TileMap *map, TileLayer *layers, int count) {
+    int cells = layers[0].width * layers[0].height;
+    int planes = 1;
+    for (int i = 0; i < cells; i++) {
+        int depth = 0;
+        for (int l = 0; l < count; l++) {
+            for (int p = 0; p < layers[l].planes; p++) depth += layers[l].data[p * cells + i] != 0;
+        }
+        if (depth > planes) planes = depth;
+    }
+
+    uint32_t *data = (uint32_t *)arena_alloc_array(map->arena, (size_t)cells * planes, sizeof(uint32_t));
+    uint8_t *sources = (uint8_t *)arena_alloc_array(map->arena, (size_t)cells * planes, 1);
+    char (*names)[64] = (char (*)[64])arena_alloc_array(map->arena, count, sizeof(*names));
+    if (!data || !sources || !names) return false;
+    for (int i = 0; i < cells; i++) {
+        int depth = 0;
+        for (int l = 0; l < count; l++) {
+            for (int p = 0; p < layers[l].planes; p++) {
+                uint32_t gid = layers[l].data[p * cells + i];
+                if (!gid) continue;
+                sources[depth * cells + i] = (uint8_t)l;
+                data[depth++ * cells + i] = gid;
             }
         }
     }
 
-    map->loaded = true;
-    cJSON_Delete(root);
-    printf("[tilemap] Loaded successfully: %d tile layers, %d object layers\n",
-           map->tile_layer_count, map->object_layer_count);
-    return map;
+    for (int l = 0; l < count; l++) strncpy_safe(names[l], layers[l].name, sizeof(names[l]));
+    for (int l = 1; l < count; l++) {
+        size_t len = strlen(layers[0].name);
+        snprintf(layers[0].name + len, sizeof(layers[0].name) - len, "+%s", layers[l].name);
+    }
+    layers[0].data = data;
+    layers[0].plane_sources = sources;
+    layers[0].source_names = names;
+    layers[0].source_count = count;
+    layers[0].planes = planes;
+    return true;
 }
 
-void tilemap_unload(TileMap *map) {
-    if (!map) return;
+// Runs before draw descriptors are built. Packing moves tiles between
+// planes, which could only reorder draws between cells if tiles were larger
+// than a map cell, so maps with such tilesets are left alone.
+static void flatten_layers(TileMap *map) {
+    if (!flatten_enabled || map->infinite) return;
+    for (int t = 0; t < map->tileset_count; t++) {
+        if (map->tilesets[t].tilewidth != map->tilewidth || map->tilesets[t].tileheight != map->tileheight) return;
+    }
 
-    for (int i = 0; i < map->tileset_count; i++) {
-        if (map->tilesets[i].anim_lookup) {
-            for (int j = 0; j < map->tilesets[i].tilecount; j++) {
-                free(map->tilesets[i].anim_lookup[j].frames);
-            }
-            free(map->tilesets[i].anim_lookup);
+    int before = map->tile_layer_count;
+    int out = 0;
+    for (int i = 0; i < map->tile_layer_count;) {
+        int run = 1;
+        while (i + run < map->tile_layer_count && run < 256 &&
+               layers_draw_alike(&map->tile_layers[i], &map->tile_layers[i + run])) {
+            run++;
         }
-        if (map->tilesets[i].texture.id > 0) {
-            UnloadTexture(map->tilesets[i].texture);
+        if (run > 1 && !merge_layers(map, &map->tile_layers[i], run)) {
+            run = 1;
         }
+        map->tile_layers[out++] = map->tile_layers[i];
+        i += run;
     }
-    free(map->tilesets);
+    map->tile_layer_count = out;
+    if (out != before) TILEMAP_LOG("[tilemap] Flattened %d tile layers into %d\n", before, out);
+}
 
-    for (int i = 0; i < map->tile_layer_count; i++) {
-        free(map->tile_layers[i].data);
+// Work for the load task pool. Task i is tileset i, then each tile layer,
+// then each object layer; every task writes only its own slot of the map.
+typedef struct ParseJob {
+    TileMap *map;
+    const char *text;
+    const char *base_dir;
+    cJSON **tileset_json;
+    StreamedLayer **tile_src;
+    StreamedLayer **object_src;
+    Image *images;          // decoded alongside the tilesets (may be NULL)
+    bool *image_claimed;    // tileset i decodes its image (under image_mutex)
+    PlatformMutex *image_mutex;
+    double *task_ms;        // per-task time, for TileMapLoadStats (may be NULL)
+    double *image_ms;       // per-tileset image decode time
+} ParseJob;
+
+static const char *property_string(cJSON *json, const char *name) {
+    cJSON *props = cJSON_GetObjectItem(json, "properties");
+    cJSON *prop;
+    cJSON_ArrayForEach(prop, props) {
+        cJSON *pname = cJSON_GetObjectItem(prop, "name");
+        if (!pname || !pname->valuestring || strcmp(pname->valuestring, name) != 0) continue;
+        cJSON *pval = cJSON_GetObjectItem(prop, "value");
+        return pval ? pval->valuestring : NULL;
     }
-    free(map->tile_layers);
+    return NULL;
+}
 
-    for (int i = 0; i < map->object_layer_count; i++) {
-        free(map->object_layers[i].objects);
+// String properties of the parsed layers, interned on the loading thread
+// once the parse tasks are done (the string table is not thread-safe)
+static void intern_parsed_strings(ParseJob *job) {
+    TileMap *map = job->map;
+    for (int l = 0; l < map->tile_layer_count; l++) {
+        cJSON *json = job->tile_src[l]->json;
+        map->tile_layers[l].render_layer = intern(map, property_string(json, "render_layer"));
+        map->tile_layers[l].shader = intern(map, property_string(json, "shader"));
     }
-    free(map->object_layers);
+    for (int l = 0; l < map->object_layer_count; l++) {
+        ObjectLayer *layer = &map->object_layers[l];
+        if (!layer->objects) continue;
+        int i = 0;
+        cJSON *obj;
+        cJSON_ArrayForEach(obj, cJSON_GetObjectItem(job->object_src[l]->json, "objects")) {
+            if (i >= layer->object_count) break;
+            MapObject *mo = &layer->objects[i++];
+            cJSON *item = cJSON_GetObjectItem(obj, "name");
+            mo->name_id = intern(map, item ? item->valuestring : NULL);
+            item = cJSON_GetObjectItem(obj, "type");
+            if (!item) item = cJSON_GetObjectItem(obj, "class");
+            mo->type_id = intern(map, item ? item->valuestring : NULL);
+        }
+    }
+}
 
-    free(map);
+static double elapsed_ms(double start) {
+    return (platform_time_seconds() - start) * 1000.0;
 }
 
-void tilemap_update(TileMap *map, float dt) {
-    if (!map) return;
-    map->anim_time += (double)(dt * 1000.0f);
+static double sum_ms(const double *times, int first, int count) {
+    double total = 0.0;
+    for (int i = 0; times && i < count; i++) total += times[first + i];
+    return total;
 }
 
-void tilemap_draw_layer_tinted(TileMap *map, int layer_index, Camera2D camera, Color tint) {
-    if (!map || !map->loaded) return;
-    if (layer_index < 0 || layer_index >= map->tile_layer_count) return;
+static bool begin_image_decode(ParseJob *job) {
+    int count = job->map->tileset_count;
+    job->images = (Image *)calloc(count, sizeof(Image));
+    job->image_claimed = (bool *)calloc(count, sizeof(bool));
+    job->image_ms = (double *)calloc(count, sizeof(double));
+    job->image_mutex = platform_mutex_create();
+    return job->images && job->image_claimed && job->image_ms && job->image_mutex;
+}
 
-    TileLayer *layer = &map->tile_layers[layer_index];
-    if (!layer->visible || !layer->data) return;
+static void end_image_decode(ParseJob *job) {
+    if (job->image_ms) job->map->load_stats.images_ms = sum_ms(job->image_ms, 0, job->map->tileset_count);
+    free(job->image_claimed);
+    free(job->image_ms);
+    job->image_claimed = NULL;
+    job->image_ms = NULL;
+    if (job->image_mutex) platform_mutex_destroy(job->image_mutex);
+    job->image_mutex = NULL;
+}
 
-    // Calculate visible tile range from camera
-    float cam_x = camera.target.x - camera.offset.x / camera.zoom;
-    float cam_y = camera.target.y - camera.offset.y / camera.zoom;
+// Decode a tileset image on the CPU; safe to call off the main thread.
+// Images whose texture is already in the asset cache are skipped, and
+// tilesets sharing an image file decode it once.
+static void decode_tileset_image(ParseJob *job, int index) {
+    const TilesetInfo *ts = &job->map->tilesets[index];
+    if (!ts->image_path[0] || assets_texture_cached(ts->image_path)) return;
+
+    bool first = true;
+    platform_mutex_lock(job->image_mutex);
+    for (int i = 0; i < job->map->tileset_count && first; i++) {
+        first = !(job->image_claimed[i] && strcmp(job->map->tilesets[i].image_path, ts->image_path) == 0);
+    }
+    job->image_claimed[index] = first;
+    platform_mutex_unlock(job->image_mutex);
+    if (!first) return;
+
+    TILEMAP_LOG("[tilemap] Loading texture: %s\n", ts->image_path);
+    double start = platform_time_seconds();
+    job->images[index] = assets_acquire_image(ts->image_path);
+    job->image_ms[index] = elapsed_ms(start);
+}
+
+static void run_parse_task(ParseJob *job, int index) {
+    TileMap *map = job->map;
+
+    if (index < map->tileset_count) {
+        parse_tileset_entry(job->tileset_json[index], &map->tilesets[index], job->base_dir, map->arena);
+        return;
+    }
+    index -= map->tileset_count;
+
+    if (index < map->tile_layer_count) {
+        StreamedLayer *src = job->tile_src[index];
+        parse_tile_layer(src->json, &map->tile_layers[index], src, job->text, map->arena);
+        return;
+    }
+    index -= map->tile_layer_count;
+
+    parse_object_layer(job->object_src[index]->json, &map->object_layers[index], map->arena);
+}
+
+static void parse_task(void *ctx, int index) {
+    ParseJob *job = (ParseJob *)ctx;
+    double start = platform_time_seconds();
+    run_parse_task(job, index);
+    if (job->task_ms) job->task_ms[index] = elapsed_ms(start);
+
+    // The image is known once its tileset is parsed
+    if (index < job->map->tileset_count && job->images) decode_tileset_image(job, index);
+}
+
+// First arena block for a JSON map: everything the parse allocates that can
+// be sized from the streamed top level. Animation frames of external
+// tilesets are not known yet and go to a chained block.
+static size_t estimate_json_map_bytes(cJSON *root, StreamedLayer *layers, int layer_count) {
+    size_t bytes = sizeof(TileMap) + sizeof(TileSource) + 2 * ARENA_ALIGN;
+
+    cJSON *tilesets = cJSON_GetObjectItem(root, "tilesets");
+    cJSON *ts;
+    cJSON_ArrayForEach(ts, tilesets) {
+        bytes += sizeof(TilesetInfo) + ARENA_ALIGN;
+        cJSON *tilecount = cJSON_GetObjectItem(ts, "tilecount");
+        if (cJSON_IsNumber(tilecount) && tilecount->valueint > 0) {
+            bytes += (size_t)tilecount->valueint * (sizeof(TileAnim) + sizeof(TileSource)) + ARENA_ALIGN;
+            bytes += (size_t)cJSON_GetArraySize(cJSON_GetObjectItem(ts, "tiles")) * 2 * sizeof(uint32_t);
+        }
+        cJSON *tiles = cJSON_GetObjectItem(ts, "tiles");
+        cJSON *tile;
+        cJSON_ArrayForEach(tile, tiles) {
+            int frames = cJSON_GetArraySize(cJSON_GetObjectItem(tile, "animation"));
+            if (frames > 0) bytes += frames * sizeof(TileAnimFrame) + ARENA_ALIGN;
+        }
+    }
+
+    for (int l = 0; l < layer_count; l++) {
+        cJSON *json = layers[l].json;
+        cJSON *width = cJSON_GetObjectItem(json, "width");
+        cJSON *height = cJSON_GetObjectItem(json, "height");
+        if (layers[l].chunks) {
+            int slots = 16;
+            while (slots < layers[l].chunk_count * 2) slots *= 2;
+            bytes += layers[l].chunk_count * sizeof(TileChunk) + slots * sizeof(int) + 2 * ARENA_ALIGN;
+        } else if (layers[l].data_length > 0 && cJSON_IsNumber(width) && cJSON_IsNumber(height) &&
+                   width->valueint > 0 && height->valueint > 0) {
+            // GIDs plus draw descriptors
+            bytes += 2 * ((size_t)width->valueint * height->valueint * sizeof(uint32_t) + ARENA_ALIGN);
+        }
+        bytes += sizeof(TileLayer) + sizeof(ObjectLayer) + 2 * ARENA_ALIGN;
+        int objects = cJSON_GetArraySize(cJSON_GetObjectItem(json, "objects"));
+        if (objects > 0) bytes += objects * sizeof(MapObject) + ARENA_ALIGN;
+    }
+    return bytes;
+}
+
+// JSON parse. If images_out is set, the tileset images are decoded on the
+// same tasks and returned as an array (one per tileset) for upload.
+static TileMap *parse_json_map(const char *path, Image **images_out) {
+    // Parsed straight from a copy-on-write mapping of the file. Infinite maps
+    // keep the mapping to decode chunks from later.
+    TileMapLoadStats stats = { .threads = 1 };
+    double load_start = platform_time_seconds();
+    MappedFile file;
+    if (!platform_map_file(path, &file)) {
+        printf("[tilemap] ERROR: Could not read file: %s\n", path);
+        return NULL;
+    }
+    stats.read_ms = elapsed_ms(load_start);
+
+    // The top level is read sequentially, only locating the layer data.
+    // Decoding it is the expensive part and runs on the task pool below.
+    double start = platform_time_seconds();
+    char *text = (char *)file.data;
+    json_fix_backslashes(text, file.size);
+    stats.fix_ms = elapsed_ms(start);
+
+    start = platform_time_seconds();
+    JsonStream js;
+    json_stream_init(&js, text, file.size);
+    StreamedLayer *layers = NULL;
+    int layer_count = 0;
+    cJSON *root = stream_map(&js, text, &layers, &layer_count);
+    stats.stream_ms = elapsed_ms(start);
+    if (!root) {
+        printf("[tilemap] ERROR: JSON parse failed for: %s\n", path);
+        platform_unmap_file(&file);
+        return NULL;
+    }
+
+    // Parse tasks allocate from the arena concurrently
+    Arena *arena = arena_create(estimate_json_map_bytes(root, layers, layer_count), true);
+    TileMap *map = arena ? (TileMap *)arena_alloc(arena, sizeof(TileMap)) : NULL;
+    if (!map) {
+        arena_destroy(arena);
+        free_streamed_layers(layers, layer_count);
+        cJSON_Delete(root);
+        platform_unmap_file(&file);
+        return NULL;
+    }
+    map->arena = arena;
+    map->load_stats = stats;
+
+    // Get base directory for resolving relative paths
+    char base_dir[512];
+    get_directory(path, base_dir, sizeof(base_dir));
+
+    // Map dimensions
+    cJSON *item;
+    item = cJSON_GetObjectItem(root, "width");
+    if (item) map->width = item->valueint;
+
+    item = cJSON_GetObjectItem(root, "height");
+    if (item) map->height = item->valueint;
+
+    item = cJSON_GetObjectItem(root, "tilewidth");
+    if (item) map->tilewidth = item->valueint;
+
+    item = cJSON_GetObjectItem(root, "tileheight");
+    if (item) map->tileheight = item->valueint;
+
+    map->infinite = cJSON_IsTrue(cJSON_GetObjectItem(root, "infinite"));
+
+    TILEMAP_LOG("[tilemap] Map: %dx%d tiles, %dx%d px/tile\n",
+           map->width, map->height, map->tilewidth, map->tileheight);
+
+    ParseJob job = { .map = map, .text = text, .base_dir = base_dir };
+
+    // Allocate every tileset and layer slot up front so the tasks never touch
+    // shared state
+    cJSON *tilesets = cJSON_GetObjectItem(root, "tilesets");
+    if (tilesets && cJSON_IsArray(tilesets) && cJSON_GetArraySize(tilesets) > 0) {
+        map->tileset_count = cJSON_GetArraySize(tilesets);
+        map->tilesets = (TilesetInfo *)arena_alloc_array(arena, map->tileset_count, sizeof(TilesetInfo));
+        job.tileset_json = (cJSON **)calloc(map->tileset_count, sizeof(cJSON *));
+        if (images_out && !begin_image_decode(&job)) {
+            // Without them the textures are simply read on upload
+            free(job.images);
+            job.images = NULL;
+            end_image_decode(&job);
+        }
+
+        int i = 0;
+        cJSON *ts_entry;
+        cJSON_ArrayForEach(ts_entry, tilesets) {
+            if (job.tileset_json) job.tileset_json[i] = ts_entry;
+            i++;
+        }
+    }
+
+    int tile_count = 0, obj_count = 0;
+    for (int l = 0; l < layer_count; l++) {
+        item = cJSON_GetObjectItem(layers[l].json, "type");
+        if (item && item->valuestring) {
+            if (strcmp(item->valuestring, "tilelayer") == 0) tile_count++;
+            else if (strcmp(item->valuestring, "objectgroup") == 0) obj_count++;
+        }
+    }
+    if (tile_count > 0) {
+        map->tile_layers = (TileLayer *)arena_alloc_array(arena, tile_count, sizeof(TileLayer));
+        job.tile_src = (StreamedLayer **)calloc(tile_count, sizeof(StreamedLayer *));
+    }
+    if (obj_count > 0) {
+        map->object_layers = (ObjectLayer *)arena_alloc_array(arena, obj_count, sizeof(ObjectLayer));
+        job.object_src = (StreamedLayer **)calloc(obj_count, sizeof(StreamedLayer *));
+    }
+
+    bool allocated = (map->tileset_count == 0 || (map->tilesets && job.tileset_json)) &&
+                     (tile_count == 0 || (map->tile_layers && job.tile_src)) &&
+                     (obj_count == 0 || (map->object_layers && job.object_src));
+    if (allocated) {
+        int ti = 0, oi = 0;
+        for (int l = 0; l < layer_count; l++) {
+            item = cJSON_GetObjectItem(layers[l].json, "type");
+            if (!item || !item->valuestring) continue;
+            if (strcmp(item->valuestring, "tilelayer") == 0) job.tile_src[ti++] = &layers[l];
+            else if (strcmp(item->valuestring, "objectgroup") == 0) job.object_src[oi++] = &layers[l];
+        }
+        map->tile_layer_count = tile_count;
+        map->object_layer_count = obj_count;
+
+        int task_count = map->tileset_count + tile_count + obj_count;
+        job.task_ms = (double *)calloc(task_count > 0 ? task_count : 1, sizeof(double));
+        start = platform_time_seconds();
+        map->load_stats.threads = load_thread_count(task_count);
+        task_pool_run(task_count, parse_task, &job, map->load_stats.threads);
+        map->load_stats.parallel_ms = elapsed_ms(start);
+
+        map->load_stats.tilesets_ms = sum_ms(job.task_ms, 0, map->tileset_count);
+        map->load_stats.layers_ms = sum_ms(job.task_ms, map->tileset_count, tile_count);
+        map->load_stats.objects_ms = sum_ms(job.task_ms, map->tileset_count + tile_count, obj_count);
+        free(job.task_ms);
+        intern_parsed_strings(&job);
+    } else {
+        printf("[tilemap] ERROR: Out of memory parsing %s\n", path);
+        map->tileset_count = 0;
+    }
+    flatten_layers(map);
+    build_draw_descriptors(map);
+
+    for (int i = 0; i < map->tile_layer_count; i++) {
+        TILEMAP_LOG("[tilemap] Tile layer %d: \"%s\" (%dx%d)\n",
+               i, map->tile_layers[i].name,
+               map->tile_layers[i].width, map->tile_layers[i].height);
+    }
+    for (int i = 0; i < map->object_layer_count; i++) {
+        TILEMAP_LOG("[tilemap] Object layer %d: \"%s\" (%d objects)\n",
+               i, map->object_layers[i].name,
+               map->object_layers[i].object_count);
+    }
+
+    end_image_decode(&job);
+    free(job.tileset_json);
+    free(job.tile_src);
+    free(job.object_src);
+    free_streamed_layers(layers, layer_count);
+    cJSON_Delete(root);
+
+    if (map->infinite) {
+        map->source = file;
+        setup_chunks(map);
+        TILEMAP_LOG("[tilemap] Infinite map: %dx%d tiles from (%d, %d), %dx%d chunks\n",
+               map->width, map->height, map->startx, map->starty,
+               map->chunk_width, map->chunk_height);
+    } else {
+        platform_unmap_file(&file);
+    }
+    // After setup_chunks(): the object grids cover the chunk bounds
+    build_object_index(map);
+
+    if (images_out) *images_out = job.images;
+    else free(job.images);
+    map->load_stats.total_ms = elapsed_ms(load_start);
+    map->load_stats.arena_bytes = arena_used(arena);
+    map->load_stats.arena_blocks = arena_block_count(arena);
+    return map;
+}
+
+TileMap *tilemap_parse_json(const char *path) {
+    return parse_json_map(path, NULL);
+}
+
+// Cooked animation frames are used in place as TileAnimFrame
+_Static_assert(sizeof(TileAnimFrame) == 2 * sizeof(int32_t), "TileAnimFrame must match the .tmb layout");
+
+// Bounds check for a table of `count` elements at `offset` inside a cooked file
+static bool cooked_range_ok(const MappedFile *file, uint32_t offset, uint64_t count, size_t elem_size) {
+    if (offset % TMB_ALIGN != 0) return false;
+    return (uint64_t)offset + count * elem_size <= file->size;
+}
+
+static const char *cooked_string(const MappedFile *file, const TmbHeader *hdr, uint32_t offset) {
+    if (offset >= hdr->strings_size) return "";
+    return (const char *)file->data + hdr->strings_offset + offset;
+}
+
+// Check every table in a cooked file before anything points into it
+static bool cooked_validate(const MappedFile *file) {
+    if (file->size < sizeof(TmbHeader)) return false;
+    const TmbHeader *hdr = (const TmbHeader *)file->data;
+    const uint8_t *base = (const uint8_t *)file->data;
+
+    if (hdr->magic != TMB_MAGIC || hdr->version != TMB_VERSION) return false;
+    if (hdr->file_size != file->size) return false;
+    if (hdr->strings_size == 0 || !cooked_range_ok(file, hdr->strings_offset, hdr->strings_size, 1)) return false;
+    if (base[hdr->strings_offset + hdr->strings_size - 1] != '\0') return false;
+
+    if (!cooked_range_ok(file, hdr->tilesets_offset, hdr->tileset_count, sizeof(TmbTileset))) return false;
+    if (!cooked_range_ok(file, hdr->tile_layers_offset, hdr->tile_layer_count, sizeof(TmbTileLayer))) return false;
+    if (!cooked_range_ok(file, hdr->object_layers_offset, hdr->object_layer_count, sizeof(TmbObjectLayer))) return false;
+
+    const TmbTileset *tilesets = (const TmbTileset *)(base + hdr->tilesets_offset);
+    for (uint32_t i = 0; i < hdr->tileset_count; i++) {
+        if (!cooked_range_ok(file, tilesets[i].anims_offset, tilesets[i].anim_count, sizeof(TmbTileAnim))) return false;
+        const TmbTileAnim *anims = (const TmbTileAnim *)(base + tilesets[i].anims_offset);
+        for (uint32_t a = 0; a < tilesets[i].anim_count; a++) {
+            if (anims[a].frame_count < 0) return false;
+            if (!cooked_range_ok(file, anims[a].frames_offset, (uint64_t)anims[a].frame_count, sizeof(TileAnimFrame))) return false;
+        }
+    }
+
+    const TmbTileLayer *layers = (const TmbTileLayer *)(base + hdr->tile_layers_offset);
+    for (uint32_t i = 0; i < hdr->tile_layer_count; i++) {
+        if (layers[i].width < 0 || layers[i].height < 0) return false;
+        uint64_t cells = (uint64_t)layers[i].width * (uint64_t)layers[i].height;
+        if (!cooked_range_ok(file, layers[i].data_offset, cells, sizeof(uint32_t))) return false;
+    }
+
+    const TmbObjectLayer *obj_layers = (const TmbObjectLayer *)(base + hdr->object_layers_offset);
+    for (uint32_t i = 0; i < hdr->object_layer_count; i++) {
+        if (!cooked_range_ok(file, obj_layers[i].objects_offset, obj_layers[i].object_count, sizeof(TmbObject))) return false;
+    }
+    return true;
+}
+
+// Map a cooked .tmb. Layer GIDs and animation frames are used in place; only
+// the small per-map tables are copied out. Returns NULL if the file is
+// missing, invalid, or older than one of the tilesets it was cooked from.
+static TileMap *load_cooked(const char *path) {
+    double load_start = platform_time_seconds();
+    MappedFile file;
+    if (!platform_map_file(path, &file)) {
+        printf("[tilemap] WARNING: Could not map cooked map: %s\n", path);
+        return NULL;
+    }
+    if (!cooked_validate(&file)) {
+        printf("[tilemap] WARNING: %s is not a valid version %d cooked map, ignoring\n", path, TMB_VERSION);
+        platform_unmap_file(&file);
+        return NULL;
+    }
+
+    const uint8_t *base = (const uint8_t *)file.data;
+    const TmbHeader *hdr = (const TmbHeader *)base;
+
+    char base_dir[512];
+    get_directory(path, base_dir, sizeof(base_dir));
+
+    // Cooked data goes stale when an external tileset is edited after cooking
+    const TmbTileset *src_tilesets = (const TmbTileset *)(base + hdr->tilesets_offset);
+    long cooked_time = GetFileModTime(path);
+    for (uint32_t i = 0; i < hdr->tileset_count; i++) {
+        const char *source = cooked_string(&file, hdr, src_tilesets[i].source);
+        if (!source[0]) continue;
+        char source_path[512];
+        snprintf(source_path, sizeof(source_path), "%s%s", base_dir, source);
+        if (FileExists(source_path) && GetFileModTime(source_path) > cooked_time) {
+            TILEMAP_LOG("[tilemap] Cooked map is older than %s, ignoring\n", source_path);
+            platform_unmap_file(&file);
+            return NULL;
+        }
+    }
+
+    // Everything but the mapping is known from the header: one exact block
+    size_t bytes = sizeof(TileMap) + hdr->tileset_count * sizeof(TilesetInfo) +
+                   hdr->tile_layer_count * sizeof(TileLayer) +
+                   hdr->object_layer_count * sizeof(ObjectLayer) + 4 * ARENA_ALIGN;
+    int source_count = 1;
+    for (uint32_t i = 0; i < hdr->tileset_count; i++) {
+        const TmbTileset *ts = &src_tilesets[i];
+        if (ts->tilecount > 0) bytes += ts->tilecount * sizeof(TileAnim) + ARENA_ALIGN;
+        bytes += (size_t)ts->anim_count * 2 * sizeof(uint32_t) + 2 * ARENA_ALIGN;   // anim_gids/current
+        if (ts->tilecount > 0 && ts->firstgid > 0 && ts->firstgid + ts->tilecount > source_count) {
+            source_count = ts->firstgid + ts->tilecount;
+        }
+    }
+    bytes += (size_t)source_count * sizeof(TileSource) + ARENA_ALIGN;
+    const TmbTileLayer *layer_table = (const TmbTileLayer *)(base + hdr->tile_layers_offset);
+    for (uint32_t i = 0; i < hdr->tile_layer_count; i++) {
+        bytes += (size_t)layer_table[i].width * layer_table[i].height * sizeof(uint32_t) + ARENA_ALIGN;
+    }
+    const TmbObjectLayer *src_obj_layers = (const TmbObjectLayer *)(base + hdr->object_layers_offset);
+    for (uint32_t i = 0; i < hdr->object_layer_count; i++) {
+        bytes += src_obj_layers[i].object_count * sizeof(MapObject) + ARENA_ALIGN;
+    }
+
+    Arena *arena = arena_create(bytes, false);
+    TileMap *map = arena ? (TileMap *)arena_alloc(arena, sizeof(TileMap)) : NULL;
+    if (!map) {
+        arena_destroy(arena);
+        platform_unmap_file(&file);
+        return NULL;
+    }
+    map->arena = arena;
+    map->cooked = file;
+    map->width = hdr->width;
+    map->height = hdr->height;
+    map->tilewidth = hdr->tilewidth;
+    map->tileheight = hdr->tileheight;
+
+    TILEMAP_LOG("[tilemap] Cooked map: %s (%dx%d tiles, %dx%d px/tile)\n",
+           path, map->width, map->height, map->tilewidth, map->tileheight);
+
+    map->tileset_count = (int)hdr->tileset_count;
+    if (map->tileset_count > 0)
+        map->tilesets = (TilesetInfo *)arena_alloc_array(arena, map->tileset_count, sizeof(TilesetInfo));
+    for (int i = 0; i < map->tileset_count; i++) {
+        const TmbTileset *src = &src_tilesets[i];
+        TilesetInfo *ts = &map->tilesets[i];
+        ts->firstgid = src->firstgid;
+        ts->tilewidth = src->tilewidth;
+        ts->tileheight = src->tileheight;
+        ts->columns = src->columns;
+        ts->tilecount = src->tilecount;
+        ts->margin = src->margin;
+        ts->spacing = src->spacing;
+        ts->imagewidth = src->imagewidth;
+        ts->imageheight = src->imageheight;
+
+        const char *image = cooked_string(&file, hdr, src->image);
+        if (image[0]) snprintf(ts->image_path, sizeof(ts->image_path), "%s%s", base_dir, image);
+        const char *source = cooked_string(&file, hdr, src->source);
+        if (source[0]) snprintf(ts->source_path, sizeof(ts->source_path), "%s%s", base_dir, source);
+
+        if (ts->tilecount > 0) {
+            ts->anim_lookup = (TileAnim *)arena_alloc_array(arena, ts->tilecount, sizeof(TileAnim));
+            const TmbTileAnim *anims = (const TmbTileAnim *)(base + src->anims_offset);
+            for (uint32_t a = 0; a < src->anim_count; a++) {
+                int local_id = anims[a].tileid;
+                if (local_id < 0 || local_id >= ts->tilecount || anims[a].frame_count <= 0) continue;
+                TileAnim *anim = &ts->anim_lookup[local_id];
+                anim->frames = (TileAnimFrame *)(base + anims[a].frames_offset);
+                anim->frame_count = anims[a].frame_count;
+                anim->total_duration = anims[a].total_duration;
+            }
+        }
+    }
+
+    map->tile_layer_count = (int)hdr->tile_layer_count;
+    if (map->tile_layer_count > 0)
+        map->tile_layers = (TileLayer *)arena_alloc_array(arena, map->tile_layer_count, sizeof(TileLayer));
+    const TmbTileLayer *src_layers = (const TmbTileLayer *)(base + hdr->tile_layers_offset);
+    for (int i = 0; i < map->tile_layer_count; i++) {
+        const TmbTileLayer *src = &src_layers[i];
+        TileLayer *layer = &map->tile_layers[i];
+        strncpy_safe(layer->name, cooked_string(&file, hdr, src->name), sizeof(layer->name));
+        layer->render_layer = intern(map, cooked_string(&file, hdr, src->render_layer));
+        layer->shader = intern(map, cooked_string(&file, hdr, src->shader));
+        layer->width = src->width;
+        layer->height = src->height;
+        layer->planes = 1;
+        layer->visible = src->visible != 0;
+        layer->opacity = src->opacity;
+        layer->elevation = src->elevation;
+        layer->data = (uint32_t *)(base + src->data_offset);
+    }
+
+    map->object_layer_count = (int)hdr->object_layer_count;
+    if (map->object_layer_count > 0)
+        map->object_layers = (ObjectLayer *)arena_alloc_array(arena, map->object_layer_count, sizeof(ObjectLayer));
+    for (int i = 0; i < map->object_layer_count; i++) {
+        const TmbObjectLayer *src = &src_obj_layers[i];
+        ObjectLayer *layer = &map->object_layers[i];
+        strncpy_safe(layer->name, cooked_string(&file, hdr, src->name), sizeof(layer->name));
+        layer->visible = src->visible != 0;
+        layer->object_count = (int)src->object_count;
+        if (layer->object_count == 0) continue;
+
+        layer->objects = (MapObject *)arena_alloc_array(arena, layer->object_count, sizeof(MapObject));
+        const TmbObject *src_objects = (const TmbObject *)(base + src->objects_offset);
+        for (int j = 0; j < layer->object_count; j++) {
+            const TmbObject *so = &src_objects[j];
+            MapObject *mo = &layer->objects[j];
+            mo->id = so->id;
+            mo->name_id = intern(map, cooked_string(&file, hdr, so->name));
+            mo->type_id = intern(map, cooked_string(&file, hdr, so->type));
+            mo->x = so->x;
+            mo->y = so->y;
+            mo->width = so->width;
+            mo->height = so->height;
+            mo->rotation = so->rotation;
+            mo->visible = so->visible != 0;
+            mo->elevation = so->elevation;
+            mo->from_elevation = so->from_elevation;
+            mo->to_elevation = so->to_elevation;
+        }
+    }
+
+    flatten_layers(map);
+    build_draw_descriptors(map);
+    build_object_index(map);
+
+    map->load_stats.cooked = true;
+    map->load_stats.threads = 1;
+    map->load_stats.read_ms = elapsed_ms(load_start);
+    map->load_stats.total_ms = map->load_stats.read_ms;
+    map->load_stats.arena_bytes = arena_used(arena);
+    map->load_stats.arena_blocks = arena_block_count(arena);
+    return map;
+}
+
+// Find the cooked .tmb for a map path. A .tmb next to the .tmj is only used
+// while it is at least as new as the JSON it was cooked from.
+static bool find_cooked_path(const char *path, char *cooked_path, size_t cooked_size) {
+    const char *ext = strrchr(path, '.');
+    if (ext && strcmp(ext, ".tmb") == 0) {
+        strncpy_safe(cooked_path, path, cooked_size);
+        return FileExists(cooked_path);
+    }
+
+    int stem_len = ext ? (int)(ext - path) : (int)strlen(path);
+    snprintf(cooked_path, cooked_size, "%.*s.tmb", stem_len, path);
+    if (!FileExists(cooked_path)) return false;
+
+    if (FileExists(path) && GetFileModTime(path) > GetFileModTime(cooked_path)) {
+        TILEMAP_LOG("[tilemap] Cooked map is older than %s, ignoring\n", path);
+        return false;
+    }
+    return true;
+}
+
+static void decode_image_task(void *ctx, int index) {
+    decode_tileset_image((ParseJob *)ctx, index);
+}
+
+// TileAlpha of every tile of a tileset, from its decoded image
+static void classify_tileset(TileMap *map, TilesetInfo *ts, Image image) {
+    if (!image.data || ts->columns <= 0 || ts->tilecount <= 0) return;
+    int bytes, alpha_offset;
+    switch (image.format) {
+        case PIXELFORMAT_UNCOMPRESSED_R8G8B8A8: bytes = 4; alpha_offset = 3; break;
+        case PIXELFORMAT_UNCOMPRESSED_GRAY_ALPHA: bytes = 2; alpha_offset = 1; break;
+        case PIXELFORMAT_UNCOMPRESSED_R8G8B8:
+        case PIXELFORMAT_UNCOMPRESSED_GRAYSCALE:
+        case PIXELFORMAT_UNCOMPRESSED_R5G6B5: bytes = 0; alpha_offset = 0; break;
+        default: return;
+    }
+    uint8_t *alpha = (uint8_t *)arena_alloc(map->arena, (size_t)ts->tilecount);
+    if (!alpha) return;
+
+    for (int id = 0; id < ts->tilecount; id++) {
+        int x0 = ts->margin + (id % ts->columns) * (ts->tilewidth + ts->spacing);
+        int y0 = ts->margin + (id / ts->columns) * (ts->tileheight + ts->spacing);
+        if (x0 + ts->tilewidth > image.width || y0 + ts->tileheight > image.height) {
+            alpha[id] = TILE_ALPHA_PARTIAL;
+            continue;
+        }
+        if (bytes == 0) {
+            alpha[id] = TILE_ALPHA_OPAQUE;
+            continue;
+        }
+        bool opaque = true, empty = true;
+        for (int y = y0; y < y0 + ts->tileheight && (opaque || empty); y++) {
+            const unsigned char *pixel = (const unsigned char *)image.data +
+                                         ((size_t)y * image.width + x0) * bytes + alpha_offset;
+            for (int x = 0; x < ts->tilewidth; x++, pixel += bytes) {
+                opaque &= *pixel == 255;
+                empty &= *pixel == 0;
+            }
+        }
+        alpha[id] = opaque ? TILE_ALPHA_OPAQUE : empty ? TILE_ALPHA_EMPTY : TILE_ALPHA_PARTIAL;
+    }
+    ts->tile_alpha = alpha;
+}
+
+// One pixel as RGBA8 (transparent for formats the overviews don't read)
+static void image_texel(Image image, int x, int y, unsigned char out[4]) {
+    const unsigned char *data = (const unsigned char *)image.data;
+    size_t i = (size_t)y * image.width + x;
+    switch (image.format) {
+        case PIXELFORMAT_UNCOMPRESSED_R8G8B8A8: memcpy(out, data + i * 4, 4); break;
+        case PIXELFORMAT_UNCOMPRESSED_R8G8B8:
+            memcpy(out, data + i * 3, 3);
+            out[3] = 255;
+            break;
+        case PIXELFORMAT_UNCOMPRESSED_GRAY_ALPHA:
+            out[0] = out[1] = out[2] = data[i * 2];
+            out[3] = data[i * 2 + 1];
+            break;
+        case PIXELFORMAT_UNCOMPRESSED_GRAYSCALE:
+            out[0] = out[1] = out[2] = data[i];
+            out[3] = 255;
+            break;
+        default: memset(out, 0, 4); break;
+    }
+}
+
+// Box-filter every tile of a tileset down to 4x4 premultiplied texels, and
+// those down to the tile's average color
+static void sample_tile_colors(TileMap *map, const TilesetInfo *ts, Image image) {
+    if (!map->tile_colors || !map->tile_average || !image.data || ts->columns <= 0) return;
+    for (int id = 0; id < ts->tilecount && ts->firstgid + id < map->tile_source_count; id++) {
+        int x0 = ts->margin + (id % ts->columns) * (ts->tilewidth + ts->spacing);
+        int y0 = ts->margin + (id / ts->columns) * (ts->tileheight + ts->spacing);
+        if (x0 + ts->tilewidth > image.width || y0 + ts->tileheight > image.height) continue;
+        unsigned char *texel = map->tile_colors + (size_t)(ts->firstgid + id) * 64;
+        for (int by = 0; by < 4; by++) {
+            int sy0 = y0 + by * ts->tileheight / 4, sy1 = y0 + (by + 1) * ts->tileheight / 4;
+            if (sy1 <= sy0) sy1 = sy0 + 1;
+            for (int bx = 0; bx < 4; bx++, texel += 4) {
+                int sx0 = x0 + bx * ts->tilewidth / 4, sx1 = x0 + (bx + 1) * ts->tilewidth / 4;
+                if (sx1 <= sx0) sx1 = sx0 + 1;
+                uint32_t sum[4] = { 0 }, count = 0;
+                for (int y = sy0; y < sy1; y++) {
+                    for (int x = sx0; x < sx1; x++, count++) {
+                        unsigned char pixel[4];
+                        image_texel(image, x, y, pixel);
+                        for (int c = 0; c < 3; c++) sum[c] += pixel[c] * pixel[3];
+                        sum[3] += pixel[3];
+                    }
+                }
+                for (int c = 0; c < 3; c++) texel[c] = (unsigned char)(sum[c] / (255 * count));
+                texel[3] = (unsigned char)(sum[3] / count);
+            }
+        }
+        texel -= 64;  // back to this tile's first texel
+        uint32_t sum[4] = { 0 };
+        for (int i = 0; i < 64; i++) sum[i & 3] += texel[i];
+        unsigned char *average = map->tile_average + (size_t)(ts->firstgid + id) * 4;
+        for (int c = 0; c < 4; c++) average[c] = (unsigned char)(sum[c] / 16);
+    }
+}
+
+// A tileset's per-tile analysis is kept with its cached texture under the
+// tile grid it was taken over: TileAlpha per tile, then the 4x4 colors, then
+// the average colors
+#define TILE_ANALYSIS_BYTES (1 + 64 + 4)
+static void tile_analysis_tag(const TilesetInfo *ts, char *tag, size_t tag_size) {
+    snprintf(tag, tag_size, "tiles %dx%d+%d+%d %dx%d", ts->tilewidth, ts->tileheight,
+             ts->margin, ts->spacing, ts->columns, ts->tilecount);
+}
+
+static bool tile_analysis_fits(const TileMap *map, const TilesetInfo *ts) {
+    return map->tile_colors && map->tile_average && ts->tilecount > 0 &&
+           ts->firstgid + ts->tilecount <= map->tile_source_count;
+}
+
+// Attach a tileset's analysis to its texture's cache entry (main thread,
+// once the texture is acquired)
+static void store_tile_analysis(const TileMap *map, const TilesetInfo *ts) {
+    if (!ts->tile_alpha || !tile_analysis_fits(map, ts)) return;
+    size_t tiles = (size_t)ts->tilecount;
+    uint8_t *blob = (uint8_t *)malloc(tiles * TILE_ANALYSIS_BYTES);
+    if (!blob) return;
+    memcpy(blob, ts->tile_alpha, tiles);
+    memcpy(blob + tiles, map->tile_colors + (size_t)ts->firstgid * 64, tiles * 64);
+    memcpy(blob + tiles * 65, map->tile_average + (size_t)ts->firstgid * 4, tiles * 4);
+    char tag[64];
+    tile_analysis_tag(ts, tag, sizeof(tag));
+    assets_set_texture_data(ts->image_path, tag, blob, tiles * TILE_ANALYSIS_BYTES);
+    free(blob);
+}
+
+// A tileset's analysis from its cached texture instead of its image. False
+// if the texture was not cached with one for the same tile grid.
+static bool restore_tile_analysis(TileMap *map, TilesetInfo *ts) {
+    if (!tile_analysis_fits(map, ts)) return false;
+    size_t tiles = (size_t)ts->tilecount;
+    uint8_t *blob = (uint8_t *)malloc(tiles * TILE_ANALYSIS_BYTES);
+    uint8_t *alpha = blob ? (uint8_t *)arena_alloc(map->arena, tiles) : NULL;
+    char tag[64];
+    tile_analysis_tag(ts, tag, sizeof(tag));
+    bool found = alpha && assets_texture_data(ts->image_path, tag, blob, tiles * TILE_ANALYSIS_BYTES);
+    if (found) {
+        memcpy(alpha, blob, tiles);
+        memcpy(map->tile_colors + (size_t)ts->firstgid * 64, blob + tiles, tiles * 64);
+        memcpy(map->tile_average + (size_t)ts->firstgid * 4, blob + tiles * 65, tiles * 4);
+        ts->tile_alpha = alpha;
+    }
+    free(blob);
+    return found;
+}
+
+static uint8_t local_tile_alpha(const TilesetInfo *ts, int local_id) {
+    return local_id >= 0 && local_id < ts->tilecount ? ts->tile_alpha[local_id] : TILE_ALPHA_PARTIAL;
+}
+
+// Classify every tileset's tiles and sample their overview colors (loader
+// thread), then give each tile source its TileAlpha. Tilesets whose texture
+// was already cached were not decoded for upload: their analysis comes with
+// the texture, and only a texture cached without one (loaded by other code,
+// or for another tile grid) has its image decoded here.
+static void analyze_tileset_images(TileMap *map, Image *images) {
+    map->tile_colors = (unsigned char *)arena_alloc_array(map->arena, map->tile_source_count, 64);
+    map->tile_average = (unsigned char *)arena_alloc_array(map->arena, map->tile_source_count, 4);
+    for (int t = 0; t < map->tileset_count; t++) {
+        TilesetInfo *ts = &map->tilesets[t];
+        if (!ts->image_path[0]) continue;
+        Image image = images ? images[t] : (Image){ 0 };
+        for (int j = 0; !image.data && images && j < map->tileset_count; j++) {
+            if (images[j].data && strcmp(map->tilesets[j].image_path, ts->image_path) == 0) image = images[j];
+        }
+        if (!image.data && restore_tile_analysis(map, ts)) continue;
+        bool acquired = !image.data;
+        if (acquired) image = assets_acquire_image(ts->image_path);
+        classify_tileset(map, ts, image);
+        sample_tile_colors(map, ts, image);
+        if (acquired) assets_release_image(image);
+    }
+
+    for (int gid = 0; gid < map->tile_source_count; gid++) {
+        TileSource *source = &map->tile_sources[gid];
+        if (source->tileset < 0) continue;
+        const TilesetInfo *ts = &map->tilesets[source->tileset];
+        if (!ts->tile_alpha) continue;
+        uint8_t alpha = local_tile_alpha(ts, gid - ts->firstgid);
+        for (int f = 0; source->anim && f < source->anim->frame_count; f++) {
+            if (local_tile_alpha(ts, source->anim->frames[f].tileid) != alpha) alpha = TILE_ALPHA_PARTIAL;
+        }
+        // A larger tile spills into the neighbouring cells, so it can't be
+        // culled against a single cell's coverage
+        if (alpha == TILE_ALPHA_OPAQUE &&
+            (ts->tilewidth != map->tilewidth || ts->tileheight != map->tileheight)) alpha = TILE_ALPHA_PARTIAL;
+        source->alpha = alpha;
+    }
+}
+
+// Tileset of a draw descriptor's tile (animation frames stay in theirs)
+static int desc_tileset(const TileMap *map, uint32_t cell) {
+    uint32_t index = cell & TILE_DESC_SOURCE_MASK;
+    if (cell & TILE_DESC_ANIMATED) index = map->anim_gids[index];
+    return map->tile_sources[index].tileset;
+}
+
+// Rebuild a finite layer's span index and occupancy from its descriptors.
+// The index lives in the arena and is rebuilt in place; spans that outgrow
+// it move to a block twice the size. Without memory for it, the whole layer
+// counts as one span per row.
+static void build_layer_spans(const TileMap *map, TileLayer *layer) {
+    layer->spans_dirty = false;
+    layer->planes_cross_tilesets = false;
+    int *span_rows = layer->span_rows;
+    layer->span_rows = NULL;
+    layer->span_count = 0;
+    layer->occupied_cells = 0;
+    layer->occupied[0] = 0, layer->occupied[1] = 0;
+    layer->occupied[2] = layer->width, layer->occupied[3] = layer->height;
+    if (!layer_has_cells(layer) || layer->chunk_slots) return;
+
+    // Occupancy of every cell (a tile in any plane), one row at a time. With
+    // several planes, also whether a cell's tilesets ever go backwards
+    uint8_t *occupied = (uint8_t *)calloc((size_t)layer->width * layer->height, 1);
+    int *last_tileset = layer->planes > 1 ? (int *)malloc(layer->width * sizeof(int)) : NULL;
+    if (!occupied || (layer->planes > 1 && !last_tileset)) {
+        free(occupied);
+        free(last_tileset);
+        layer->planes_cross_tilesets = layer->planes > 1;
+        return;
+    }
+    int count = 0;
+    for (int y = 0; y < layer->height; y++) {
+        uint8_t *row = occupied + (size_t)y * layer->width;
+        for (int x = 0; last_tileset && x < layer->width; x++) last_tileset[x] = -1;
+        for (int p = 0; p < layer->planes; p++) {
+            const uint32_t *desc = layer_desc_run(map, layer, p, y, 0, layer->width);
+            for (int x = 0; x < layer->width; x++) {
+                row[x] |= desc[x] != 0;
+                if (!last_tileset || !desc[x]) continue;
+                int tileset = desc_tileset(map, desc[x]);
+                if (tileset < last_tileset[x]) layer->planes_cross_tilesets = true;
+                last_tileset[x] = tileset;
+            }
+        }
+        for (int x = 0; x < layer->width; x++) count += row[x] && (x == 0 || !row[x - 1]);
+    }
+    free(last_tileset);
+    if (!span_rows) span_rows = (int *)arena_alloc_array(map->arena, layer->height + 1, sizeof(int));
+    if (!layer->spans || count > layer->span_capacity) {
+        int capacity = layer->span_capacity * 2;
+        if (capacity < count) capacity = count;
+        if (capacity < 1) capacity = 1;
+        TileSpan *spans = (TileSpan *)arena_alloc_array(map->arena, capacity, sizeof(TileSpan));
+        if (spans) {
+            layer->spans = spans;
+            layer->span_capacity = capacity;
+        }
+    }
+    if (!span_rows || !layer->spans || count > layer->span_capacity) {
+        free(occupied);
+        return;
+    }
+    layer->span_rows = span_rows;
+
+    int x0 = layer->width, y0 = layer->height, x1 = 0, y1 = 0;
+    for (int y = 0; y < layer->height; y++) {
+        const uint8_t *row = occupied + (size_t)y * layer->width;
+        layer->span_rows[y] = layer->span_count;
+        for (int x = 0; x < layer->width; x++) {
+            if (!row[x]) continue;
+            int start = x;
+            while (x < layer->width && row[x]) x++;
+            layer->spans[layer->span_count++] = (TileSpan){ start, x };
+            layer->occupied_cells += x - start;
+            if (start < x0) x0 = start;
+            if (x > x1) x1 = x;
+            if (y < y0) y0 = y;
+            y1 = y + 1;
+        }
+    }
+    layer->span_rows[layer->height] = layer->span_count;
+    free(occupied);
+    layer->occupied[0] = x0, layer->occupied[1] = y0;
+    layer->occupied[2] = x1, layer->occupied[3] = y1;
+}
+
+// Span index and occupancy of every finite layer, logged per layer
+static void build_span_index(TileMap *map) {
+    for (int l = 0; l < map->tile_layer_count; l++) {
+        TileLayer *layer = &map->tile_layers[l];
+        if (!layer_has_cells(layer) || layer->chunk_slots) continue;
+        build_layer_spans(map, layer);
+        long cells = (long)layer->width * layer->height;
+        TILEMAP_LOG("[tilemap] Tile layer \"%s\": %d of %ld cells occupied (%.1f%%) in %d row spans\n",
+                    layer->name, layer->occupied_cells, cells,
+                    cells > 0 ? 100.0 * layer->occupied_cells / cells : 0.0, layer->span_count);
+    }
+}
+
+static const int overview_scale[TILEMAP_OVERVIEW_LEVELS] = { 4, 1 };
+
+// Render tiles [x0, x1) x [y0, y1) of a finite layer at an overview level
+// into `out` (premultiplied RGBA, rect-sized rows): each cell's tiles from
+// the bottom plane up, flips applied to their 4x4 texels (the 1-pixel level
+// takes each tile's average color)
+static void render_overview(const TileMap *map, const TileLayer *layer, int level,
+                            int x0, int y0, int x1, int y1, unsigned char *out) {
+    int scale = overview_scale[level];
+    int stride = (x1 - x0) * scale * 4;
+    memset(out, 0, (size_t)stride * (y1 - y0) * scale);
+    for (int p = 0; p < layer->planes; p++) {
+        for (int y = y0; y < y1; y++) {
+            const uint32_t *row = layer_desc_run(map, layer, p, y, x0, x1);
+            for (int x = x0; x < x1; x++) {
+                uint32_t desc = row[x - x0];
+                if (!desc) continue;
+                uint32_t index = desc & TILE_DESC_SOURCE_MASK;
+                if (desc & TILE_DESC_ANIMATED) index = map->anim_gids[index];
+                const unsigned char *tile = map->tile_colors + (size_t)index * 64;
+                const unsigned char *average = map->tile_average + (size_t)index * 4;
+                int orientation = (int)(desc >> TILE_DESC_ORIENT_SHIFT);
+                unsigned char *cell = out + (size_t)(y - y0) * scale * stride + (x - x0) * scale * 4;
+                for (int ty = 0; ty < scale; ty++) {
+                    for (int tx = 0; tx < scale; tx++) {
+                        const unsigned char *src = average;
+                        if (scale > 1) {
+                            // Mirror, then swap: Tiled's order undone
+                            int sx = orientation & 4 ? 3 - tx : tx;
+                            int sy = orientation & 2 ? 3 - ty : ty;
+                            if (orientation & 1) {
+                                int t = sx;
+                                sx = sy;
+                                sy = t;
+                            }
+                            src = tile + (sy * 4 + sx) * 4;
+                        }
+                        unsigned char *dst = cell + (size_t)ty * stride + tx * 4;
+                        for (int c = 0; c < 4; c++) dst[c] = (unsigned char)(src[c] + dst[c] * (255 - src[3]) / 255);
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Everything but the GPU work: cooked map or JSON parse, plus the tileset
+// images decoded for upload_tileset_textures()
+static TileMap *load_map_data(const char *path, Image **images) {
+    *images = NULL;
+
+    TileMap *map = NULL;
+    char cooked_path[512];
+    if (find_cooked_path(path, cooked_path, sizeof(cooked_path))) map = load_cooked(cooked_path);
+    if (map) {
+        // Nothing left to parse; the images are the whole job
+        ParseJob job = { .map = map };
+        if (map->tileset_count > 0 && begin_image_decode(&job)) {
+            double start = platform_time_seconds();
+            map->load_stats.threads = load_thread_count(map->tileset_count);
+            task_pool_run(map->tileset_count, decode_image_task, &job, map->load_stats.threads);
+            map->load_stats.parallel_ms = elapsed_ms(start);
+            map->load_stats.total_ms += map->load_stats.parallel_ms;
+            *images = job.images;
+        } else {
+            free(job.images);
+        }
+        end_image_decode(&job);
+    } else {
+        map = parse_json_map(path, images);
+    }
+    if (map) {
+        TileMapLoadStats *st = &map->load_stats;
+        double start = platform_time_seconds();
+        analyze_tileset_images(map, *images);
+        st->analyze_ms = elapsed_ms(start);
+        start = platform_time_seconds();
+        build_span_index(map);
+        st->spans_ms = elapsed_ms(start);
+        st->total_ms += st->analyze_ms + st->spans_ms;
+    }
+    return map;
+}
+
+// RGBA8 texture from a caller-filled pixel buffer
+static Texture2D load_rgba_texture(const unsigned char *pixels, int width, int height) {
+    Image image = { (void *)pixels, width, height, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 };
+    return LoadTextureFromImage(image);
+}
+
+// load_rgba_texture() of a malloc'd buffer, freed here
+static Texture2D upload_rgba(unsigned char *pixels, int width, int height) {
+    Texture2D texture = load_rgba_texture(pixels, width, height);
+    free(pixels);
+    return texture;
+}
+
+// Upload decoded images (main thread only) and mark the map loaded
+static void upload_tileset_textures(TileMap *map, Image *images) {
+    double start = platform_time_seconds();
+
+    // Decoded images first: a tileset sharing another's image file then hits
+    // the cache instead of reading the file again
+    for (int pass = 0; pass < 2; pass++) {
+        for (int i = 0; i < map->tileset_count; i++) {
+            TilesetInfo *ts = &map->tilesets[i];
+            Image image = images ? images[i] : (Image){ 0 };
+            if (!ts->image_path[0] || (image.data != NULL) != (pass == 0)) continue;
+            ts->texture = assets_acquire_texture_from_image(ts->image_path, image);
+            assets_release_image(image);
+            store_tile_analysis(map, ts);
+            // The map file may not state the image size (or state it wrong)
+            if (ts->texture.id != 0 &&
+                (ts->texture.width != ts->imagewidth || ts->texture.height != ts->imageheight)) {
+                ts->imagewidth = ts->texture.width;
+                ts->imageheight = ts->texture.height;
+                set_tileset_uvs(map, i);
+            }
+        }
+    }
+    for (int i = 0; i < map->tileset_count; i++) {
+        TilesetInfo *ts = &map->tilesets[i];
+        TILEMAP_LOG("[tilemap] Tileset: firstgid=%d, %dx%d tiles, %d columns, texture=%dx%d\n",
+               ts->firstgid, ts->tilewidth, ts->tileheight, ts->columns,
+               ts->texture.width, ts->texture.height);
+    }
+    free(images);
+
+    map->load_stats.upload_ms = elapsed_ms(start);
+    map->load_stats.total_ms += map->load_stats.upload_ms;
+    map->overview_px = TILEMAP_OVERVIEW_PX_DEFAULT;
+    map->bake_budget = TILEMAP_BAKE_BUDGET_DEFAULT;
+    map->batching = true;
+    map->occlusion = true;
+    map->occlusion_dirty = true;
+    for (int l = 0; l < map->tile_layer_count; l++) map->tile_layers[l].occluder = true;
+    map->loaded = true;
+    TILEMAP_LOG("[tilemap] Loaded successfully: %d tile layers, %d object layers\n",
+           map->tile_layer_count, map->object_layer_count);
+    if (tilemap_log_enabled) tilemap_log_load_stats(map);
+}
+
+void tilemap_log_load_stats(const TileMap *map) {
+    if (!map) return;
+    const TileMapLoadStats *st = &map->load_stats;
+    if (st->cooked) {
+        printf("[tilemap] Load: cooked read %.2f ms (descriptors %.2f ms, object index %.2f ms), images %.2f ms",
+               st->read_ms, st->desc_ms, st->index_ms, st->images_ms);
+    } else {
+        printf("[tilemap] Load: read %.2f ms, fix %.2f ms, stream %.2f ms, "
+               "tilesets %.2f ms, layers %.2f ms, objects %.2f ms, images %.2f ms",
+               st->read_ms, st->fix_ms, st->stream_ms,
+               st->tilesets_ms, st->layers_ms, st->objects_ms, st->images_ms);
+        printf(", descriptors %.2f ms, object index %.2f ms", st->desc_ms, st->index_ms);
+    }
+    printf(" (%.2f ms on %d thread%s), analyze %.2f ms, spans %.2f ms, upload %.2f ms, "
+           "total %.2f ms, %.1f KB in %d block%s\n",
+           st->parallel_ms, st->threads, st->threads == 1 ? "" : "s",
+           st->analyze_ms, st->spans_ms, st->upload_ms, st->total_ms,
+           st->arena_bytes / 1024.0, st->arena_blocks, st->arena_blocks == 1 ? "" : "s");
+}
+
+TileMap *tilemap_load(const char *path) {
+    // Images are decoded on the load tasks; the cache lock must exist first
+    assets_init();
+    Image *images;
+    TileMap *map = load_map_data(path, &images);
+    if (!map) return NULL;
+    upload_tileset_textures(map, images);
+    return map;
+}
+
+struct TileMapLoad {
+    char path[512];
+    PlatformThread *thread;
+    atomic_bool done;       // set by the worker when map/images are ready
+    bool finished;          // joined and uploaded (main thread)
+    TileMap *map;
+    Image *images;
+};
+
+static void load_worker(void *arg) {
+    TileMapLoad *load = (TileMapLoad *)arg;
+    load->map = load_map_data(load->path, &load->images);
+    atomic_store(&load->done, true);
+}
+
+TileMapLoad *tilemap_load_async(const char *path) {
+    TileMapLoad *load = (TileMapLoad *)calloc(1, sizeof(TileMapLoad));
+    if (!load) return NULL;
+    strncpy_safe(load->path, path, sizeof(load->path));
+    atomic_init(&load->done, false);
+    assets_init();
+
+    load->thread = platform_thread_start(load_worker, load);
+    if (!load->thread) {
+        printf("[tilemap] WARNING: Could not start loader thread, loading %s synchronously\n", path);
+        load_worker(load);
+    }
+    return load;
+}
+
+// Join the worker and do the main-thread part of the load
+static void complete_load(TileMapLoad *load) {
+    if (load->finished) return;
+    platform_thread_join(load->thread);
+    load->thread = NULL;
+    if (load->map) upload_tileset_textures(load->map, load->images);
+    load->images = NULL;
+    load->finished = true;
+}
+
+bool tilemap_load_poll(TileMapLoad *load) {
+    if (!load) return true;
+    if (!atomic_load(&load->done)) return false;
+    complete_load(load);
+    return true;
+}
+
+TileMap *tilemap_load_finish(TileMapLoad *load) {
+    if (!load) return NULL;
+    complete_load(load);
+    TileMap *map = load->map;
+    free(load);
+    return map;
+}
+
+void tilemap_load_cancel(TileMapLoad *load) {
+    if (!load) return;
+    if (!load->finished) {
+        platform_thread_join(load->thread);
+        for (int i = 0; load->map && load->images && i < load->map->tileset_count; i++) {
+            assets_release_image(load->images[i]);
+        }
+        free(load->images);
+    }
+    tilemap_unload(load->map);
+    free(load);
+}
+
+// GPU layer renderer: a layer is drawn as one quad per tileset it uses. The
+// quad samples the layer's cell texture (one texel per cell); the shader
+// resolves animation slots and GIDs through two small lookup textures and
+// samples the tileset, applying the flip bits to the in-tile coordinates.
+#define GPU_TABLE_WIDTH 256
+
+#define GPU_EFFECTS_MAX 8
+
+// The lookup shader, plain or combined with a layer shader's effect
+typedef struct GpuLayerShader {
+    Shader shader;
+    int loc_sources, loc_anims, loc_tileset;
+    int loc_layer_size, loc_tileset_index, loc_tile_size, loc_tile_stride, loc_tile_margin, loc_image_size;
+    bool failed;              // didn't compile; such layers draw per tile
+} GpuLayerShader;
+
+typedef struct TileGpuRenderer {
+    GpuLayerShader plain;
+    GpuLayerShader effects[GPU_EFFECTS_MAX];  // same order as gpu_effects
+    uint32_t effects_version; // gpu_effects_version the effects were built from
+    Texture2D sources;        // per GID: tileset column, row, tileset index
+    Texture2D anims;          // per animation slot: current GID (lo, hi)
+    uint32_t anim_version;    // TileMap.anim_version the anims table holds
+    bool unsupported;         // tables can't describe this map's tilesets
+} TileGpuRenderer;
+
+// Layer shader effects registered with tilemap_set_gpu_effect() (main thread)
+typedef struct GpuEffect {
+    char name[64];
+    char *source;
+} GpuEffect;
+
+static GpuEffect gpu_effects[GPU_EFFECTS_MAX];
+static int gpu_effect_count = 0;
+static uint32_t gpu_effects_version = 0;
+
+// raylib's default fragment inputs, declared by an effect's source itself
+static const char *gpu_layer_io =
+    "in vec2 fragTexCoord;\n"
+    "in vec4 fragColor;\n"
+    "uniform sampler2D texture0;\n"      // cell texture
+    "uniform vec4 colDiffuse;\n"
+    "out vec4 finalColor;\n";
+
+static const char *gpu_layer_lookup =
+    "uniform sampler2D sources;\n"
+    "uniform sampler2D anims;\n"
+    "uniform sampler2D tileset;\n"
+    "uniform vec2 layerSize;\n"
+    "uniform int tilesetIndex;\n"
+    "uniform vec2 tileSize;\n"
+    "uniform vec2 tileStride;\n"
+    "uniform vec2 tileMargin;\n"
+    "uniform vec2 imageSize;\n"
+    "int byteAt(float v) { return int(v * 255.0 + 0.5); }\n"
+    "ivec2 tableCoord(int i) { return ivec2(i % 256, i / 256); }\n"
+    "vec4 tileTexel() {\n"
+    "    vec2 cellPos = fragTexCoord * layerSize;\n"
+    "    vec4 cell = texelFetch(texture0, ivec2(floor(cellPos)), 0);\n"
+    "    if (cell.a == 0.0) discard;\n"
+    "    int index = byteAt(cell.r) + byteAt(cell.g) * 256;\n"
+    "    int flags = byteAt(cell.b);\n"
+    "    if ((flags & 8) != 0) {\n"
+    "        vec4 frame = texelFetch(anims, tableCoord(index), 0);\n"
+    "        index = byteAt(frame.r) + byteAt(frame.g) * 256;\n"
+    "    }\n"
+    "    vec4 source = texelFetch(sources, tableCoord(index), 0);\n"
+    "    if (source.a == 0.0 || byteAt(source.b) != tilesetIndex) discard;\n"
+    "    vec2 local = fract(cellPos);\n"
+    "    if ((flags & 4) != 0) local.x = 1.0 - local.x;\n"
+    "    if ((flags & 2) != 0) local.y = 1.0 - local.y;\n"
+    "    if ((flags & 1) != 0) local = local.yx;\n"
+    "    vec2 pixel = tileMargin + vec2(byteAt(source.r), byteAt(source.g)) * tileStride + local * tileSize;\n"
+    "    return texture(tileset, pixel / imageSize);\n"
+    "}\n";
+
+static const char *gpu_layer_main = "void main() { finalColor = tileTexel() * colDiffuse * fragColor; }\n";
+static const char *gpu_effect_main =
+    "void main() { finalColor = layer_effect(tileTexel()) * colDiffuse * fragColor; }\n";
+
+void tilemap_set_gpu_effect(const char *name, const char *fs_source) {
+    if (!name || !name[0]) return;
+    int e = 0;
+    while (e < gpu_effect_count && strcmp(gpu_effects[e].name, name) != 0) e++;
+    if (e == gpu_effect_count && (!fs_source || e == GPU_EFFECTS_MAX)) {
+        if (fs_source) printf("[tilemap] WARNING: Too many GPU layer effects, ignoring %s\n", name);
+        return;
+    }
+    char *source = fs_source ? (char *)malloc(strlen(fs_source) + 1) : NULL;
+    if (fs_source && !source) return;
+    if (source) memcpy(source, fs_source, strlen(fs_source) + 1);
+    if (e == gpu_effect_count) {
+        strncpy_safe(gpu_effects[e].name, name, sizeof(gpu_effects[e].name));
+        gpu_effect_count++;
+    }
+    free(gpu_effects[e].source);
+    gpu_effects[e].source = source;
+    gpu_effects_version++;
+}
+
+// Registered effect for a layer's "shader" property, or -1
+static int layer_gpu_effect(const TileMap *map, const TileLayer *layer) {
+    const char *name = layer->shader ? tilemap_string(map, layer->shader) : NULL;
+    for (int e = 0; name && e < gpu_effect_count; e++) {
+        if (gpu_effects[e].source && strcmp(gpu_effects[e].name, name) == 0) return e;
+    }
+    return -1;
+}
+
+static bool load_gpu_layer_shader(GpuLayerShader *out, const char *source) {
+    out->shader = LoadShaderFromMemory(NULL, source);
+    out->failed = out->shader.id == 0 || out->shader.id == rlGetShaderIdDefault();
+    if (out->failed) return false;
+    out->loc_sources = GetShaderLocation(out->shader, "sources");
+    out->loc_anims = GetShaderLocation(out->shader, "anims");
+    out->loc_tileset = GetShaderLocation(out->shader, "tileset");
+    out->loc_layer_size = GetShaderLocation(out->shader, "layerSize");
+    out->loc_tileset_index = GetShaderLocation(out->shader, "tilesetIndex");
+    out->loc_tile_size = GetShaderLocation(out->shader, "tileSize");
+    out->loc_tile_stride = GetShaderLocation(out->shader, "tileStride");
+    out->loc_tile_margin = GetShaderLocation(out->shader, "tileMargin");
+    out->loc_image_size = GetShaderLocation(out->shader, "imageSize");
+    return true;
+}
+
+static void unload_gpu_layer_shader(GpuLayerShader *shader) {
+    if (shader->shader.id != 0 && !shader->failed) UnloadShader(shader->shader);
+    memset(shader, 0, sizeof(*shader));
+}
+
+// The lookup shader for effect `e`, compiled on first use: the effect's
+// source (with TILEMAP_GPU_LAYER defined, so its own main() drops out),
+// then the lookup, then a main() that passes the tile texel through
+// layer_effect(). NULL if it doesn't compile.
+static GpuLayerShader *gpu_effect_shader(TileGpuRenderer *gpu, int e) {
+    if (gpu->effects_version != gpu_effects_version) {
+        for (int i = 0; i < GPU_EFFECTS_MAX; i++) unload_gpu_layer_shader(&gpu->effects[i]);
+        gpu->effects_version = gpu_effects_version;
+    }
+    GpuLayerShader *shader = &gpu->effects[e];
+    if (shader->failed) return NULL;
+    if (shader->shader.id != 0) return shader;
+
+    // The #version line has to stay first
+    const char *body = gpu_effects[e].source;
+    while (*body == ' ' || *body == '\t' || *body == '\r' || *body == '\n') body++;
+    if (strncmp(body, "#version", 8) == 0) body += strcspn(body, "\n");
+    size_t size = strlen(body) + strlen(gpu_layer_lookup) + strlen(gpu_effect_main) + 64;
+    char *source = (char *)malloc(size);
+    if (!source) return NULL;
+    snprintf(source, size, "#version 330\n#define TILEMAP_GPU_LAYER\n%s\n%s%s", body, gpu_layer_lookup,
+             gpu_effect_main);
+    bool loaded = load_gpu_layer_shader(shader, source);
+    free(source);
+    if (!loaded) {
+        printf("[tilemap] WARNING: GPU layer effect %s failed to compile, drawing its layers per tile\n",
+               gpu_effects[e].name);
+        return NULL;
+    }
+    return shader;
+}
+
+static void upload_gpu_anims(TileMap *map, TileGpuRenderer *gpu) {
+    int rows = (map->anim_count + GPU_TABLE_WIDTH - 1) / GPU_TABLE_WIDTH;
+    unsigned char *pixels = (unsigned char *)calloc((size_t)GPU_TABLE_WIDTH * rows, 4);
+    if (!pixels) return;
+    for (int i = 0; i < map->anim_count; i++) {
+        pixels[i * 4 + 0] = (unsigned char)(map->anim_current[i] & 0xFF);
+        pixels[i * 4 + 1] = (unsigned char)(map->anim_current[i] >> 8);
+        pixels[i * 4 + 3] = 255;
+    }
+    if (gpu->anims.id == 0) {
+        gpu->anims = upload_rgba(pixels, GPU_TABLE_WIDTH, rows);
+    } else {
+        UpdateTexture(gpu->anims, pixels);
+        free(pixels);
+    }
+    gpu->anim_version = map->anim_version;
+}
+
+// Shader and tables, once per map. False if the map can't use the renderer.
+static bool prepare_gpu_renderer(TileMap *map) {
+    if (map->gpu) return !map->gpu->unsupported;
+    TileGpuRenderer *gpu = (TileGpuRenderer *)calloc(1, sizeof(TileGpuRenderer));
+    if (!gpu) return false;
+    map->gpu = gpu;
+
+    // Cells hold 16-bit indices, the source table 8-bit columns, rows and
+    // tileset indices, and layers a 64-bit tileset mask
+    gpu->unsupported = map->tile_source_count > 65536 || map->anim_count > 65536 || map->tileset_count > 64;
+    for (int t = 0; t < map->tileset_count && !gpu->unsupported; t++) {
+        const TilesetInfo *ts = &map->tilesets[t];
+        if (ts->columns > 256 || (ts->columns > 0 && (ts->tilecount + ts->columns - 1) / ts->columns > 256)) {
+            gpu->unsupported = true;
+        }
+    }
+    if (gpu->unsupported) {
+        printf("[tilemap] WARNING: Tilesets too large for the GPU layer renderer, drawing per tile\n");
+        return false;
+    }
+
+    int rows = (map->tile_source_count + GPU_TABLE_WIDTH - 1) / GPU_TABLE_WIDTH;
+    unsigned char *pixels = (unsigned char *)calloc((size_t)GPU_TABLE_WIDTH * rows, 4);
+    if (!pixels) {
+        gpu->unsupported = true;
+        return false;
+    }
+    for (int gid = 1; gid < map->tile_source_count; gid++) {
+        const TileSource *source = &map->tile_sources[gid];
+        if (source->tileset < 0) continue;
+        const TilesetInfo *ts = &map->tilesets[source->tileset];
+        int local_id = gid - ts->firstgid;
+        pixels[gid * 4 + 0] = (unsigned char)(local_id % ts->columns);
+        pixels[gid * 4 + 1] = (unsigned char)(local_id / ts->columns);
+        pixels[gid * 4 + 2] = (unsigned char)source->tileset;
+        pixels[gid * 4 + 3] = 255;
+    }
+    gpu->sources = upload_rgba(pixels, GPU_TABLE_WIDTH, rows);
+    if (map->anim_count > 0) upload_gpu_anims(map, gpu);
+
+    gpu->effects_version = gpu_effects_version;
+    char source[4096];
+    snprintf(source, sizeof(source), "#version 330\n%s%s%s", gpu_layer_io, gpu_layer_lookup, gpu_layer_main);
+    if (!load_gpu_layer_shader(&gpu->plain, source) || gpu->sources.id == 0) {
+        gpu->unsupported = true;
+        return false;
+    }
+    return true;
+}
+
+// Cell texel: source or animation slot index (lo, hi), flip bits | 8 if
+// animated, alpha 0 for empty cells. Returns the cell's tileset bit.
+static uint64_t gpu_cell_texel(const TileMap *map, uint32_t desc, unsigned char *texel) {
+    uint32_t index = desc & TILE_DESC_SOURCE_MASK;
+    texel[0] = (unsigned char)(index & 0xFF);
+    texel[1] = (unsigned char)(index >> 8);
+    texel[2] = (unsigned char)((desc >> TILE_DESC_ORIENT_SHIFT) | ((desc & TILE_DESC_ANIMATED) ? 8 : 0));
+    texel[3] = desc ? 255 : 0;
+    if (!desc) return 0;
+    if (desc & TILE_DESC_ANIMATED) index = map->anim_gids[index];
+    return 1ull << map->tile_sources[index].tileset;
+}
+
+// Planes are stacked vertically in the cell texture. Once it exists, only
+// the invalidated rect is re-uploaded.
+static void upload_gpu_cells(TileMap *map, TileLayer *layer) {
+    int x0 = 0, y0 = 0, x1 = layer->width, y1 = layer->height;
+    if (layer->gpu_cells.id != 0) {
+        x0 = layer->gpu_dirty[0] > 0 ? layer->gpu_dirty[0] : 0;
+        y0 = layer->gpu_dirty[1] > 0 ? layer->gpu_dirty[1] : 0;
+        if (layer->gpu_dirty[2] < x1) x1 = layer->gpu_dirty[2];
+        if (layer->gpu_dirty[3] < y1) y1 = layer->gpu_dirty[3];
+    }
+    layer->gpu_cells_dirty = false;
+    if (x0 >= x1 || y0 >= y1) return;
+
+    int w = x1 - x0, h = y1 - y0;
+    unsigned char *pixels = (unsigned char *)malloc((size_t)w * h * layer->planes * 4);
+    if (!pixels) return;
+    uint64_t tilesets = 0;
+    unsigned char *texel = pixels;
+    for (int p = 0; p < layer->planes; p++) {
+        for (int y = y0; y < y1; y++) {
+            const uint32_t *row = layer_desc_run(map, layer, p, y, x0, x1);
+            for (int x = x0; x < x1; x++, texel += 4) tilesets |= gpu_cell_texel(map, row[x - x0], texel);
+        }
+    }
+
+    if (layer->gpu_cells.id == 0) {
+        layer->gpu_cells = upload_rgba(pixels, layer->width, layer->height * layer->planes);
+        layer->gpu_tilesets = tilesets;
+        return;
+    }
+    for (int p = 0; p < layer->planes; p++) {
+        Rectangle rect = { (float)x0, (float)(p * layer->height + y0), (float)w, (float)h };
+        UpdateTextureRec(layer->gpu_cells, rect, pixels + (size_t)p * w * h * 4);
+    }
+    free(pixels);
+    // Tilesets no longer used still get their (empty) quad until the next
+    // full upload
+    layer->gpu_tilesets |= tilesets;
+}
+
+// A layer with a shader needs an effect for it (see tilemap_set_gpu_effect())
+static bool layer_drawn_on_gpu(const TileMap *map, const TileLayer *layer) {
+    if (layer->renderer != TILE_RENDER_GPU || !layer_has_cells(layer) || (map->gpu && map->gpu->unsupported)) {
+        return false;
+    }
+    if (!layer->shader) return true;
+    int e = layer_gpu_effect(map, layer);
+    return e >= 0 && !(map->gpu && map->gpu->effects_version == gpu_effects_version && map->gpu->effects[e].failed);
+}
+
+// Lookup shader a GPU layer draws with, or NULL if it draws per tile
+static GpuLayerShader *layer_gpu_shader(TileMap *map, const TileLayer *layer) {
+    if (!layer_drawn_on_gpu(map, layer) || !prepare_gpu_renderer(map)) return NULL;
+    if (!layer->shader) return &map->gpu->plain;
+    return gpu_effect_shader(map->gpu, layer_gpu_effect(map, layer));
+}
+
+Shader tilemap_layer_gpu_shader(TileMap *map, int layer_index) {
+    if (!map || layer_index < 0 || layer_index >= map->tile_layer_count) return (Shader){ 0 };
+    GpuLayerShader *shader = layer_gpu_shader(map, &map->tile_layers[layer_index]);
+    return shader ? shader->shader : (Shader){ 0 };
+}
+
+// False if the layer has to be drawn per tile instead
+static bool draw_gpu_layer(TileMap *map, TileLayer *layer, int start_x, int start_y,
+                           int end_x, int end_y, Color tint) {
+    GpuLayerShader *shader = layer_gpu_shader(map, layer);
+    if (!shader) return false;
+    TileGpuRenderer *gpu = map->gpu;
+    if (layer->gpu_cells.id == 0 || layer->gpu_cells_dirty) upload_gpu_cells(map, layer);
+    if (layer->gpu_cells.id == 0) return false;
+    if (map->anim_count > 0 && gpu->anim_version != map->anim_version) upload_gpu_anims(map, gpu);
+
+    if (start_x < 0) start_x = 0;
+    if (start_y < 0) start_y = 0;
+    if (end_x > layer->width) end_x = layer->width;
+    if (end_y > layer->height) end_y = layer->height;
+    if (start_x >= end_x || start_y >= end_y) return true;
+
+    // The cell texture is one texel per tile, so the visible tile range is
+    // directly its source rect (offset to each plane)
+    Rectangle dst = {
+        (float)(start_x * map->tilewidth), (float)(start_y * map->tileheight),
+        (float)((end_x - start_x) * map->tilewidth), (float)((end_y - start_y) * map->tileheight)
+    };
+    float layer_size[2] = { (float)layer->width, (float)(layer->height * layer->planes) };
+
+    BeginShaderMode(shader->shader);
+    SetShaderValue(shader->shader, shader->loc_layer_size, layer_size, SHADER_UNIFORM_VEC2);
+    SetShaderValueTexture(shader->shader, shader->loc_sources, gpu->sources);
+    if (gpu->anims.id != 0) SetShaderValueTexture(shader->shader, shader->loc_anims, gpu->anims);
+    for (int pt = 0; pt < layer->planes * map->tileset_count; pt++) {
+        int plane = pt / map->tileset_count, t = pt % map->tileset_count;
+        const TilesetInfo *ts = &map->tilesets[t];
+        if (!(layer->gpu_tilesets & (1ull << t)) || ts->texture.id == 0) continue;
+        Rectangle src = { (float)start_x, (float)(plane * layer->height + start_y),
+                          (float)(end_x - start_x), (float)(end_y - start_y) };
+        float tile_size[2] = { (float)ts->tilewidth, (float)ts->tileheight };
+        float tile_stride[2] = { (float)(ts->tilewidth + ts->spacing), (float)(ts->tileheight + ts->spacing) };
+        float tile_margin[2] = { (float)ts->margin, (float)ts->margin };
+        float image_size[2] = { (float)ts->texture.width, (float)ts->texture.height };
+        SetShaderValue(shader->shader, shader->loc_tileset_index, &t, SHADER_UNIFORM_INT);
+        SetShaderValue(shader->shader, shader->loc_tile_size, tile_size, SHADER_UNIFORM_VEC2);
+        SetShaderValue(shader->shader, shader->loc_tile_stride, tile_stride, SHADER_UNIFORM_VEC2);
+        SetShaderValue(shader->shader, shader->loc_tile_margin, tile_margin, SHADER_UNIFORM_VEC2);
+        SetShaderValue(shader->shader, shader->loc_image_size, image_size, SHADER_UNIFORM_VEC2);
+        SetShaderValueTexture(shader->shader, shader->loc_tileset, ts->texture);
+        DrawTexturePro(layer->gpu_cells, src, dst, (Vector2){ 0, 0 }, 0.0f, tint);
+        // Uniforms are set immediately but quads are batched: draw this
+        // quad before the next one changes them
+        rlDrawRenderBatchActive();
+    }
+    EndShaderMode();
+    return true;
+}
+
+void tilemap_set_layer_renderer(TileMap *map, int layer_index, TileLayerRenderer renderer) {
+    if (!map || layer_index < 0 || layer_index >= map->tile_layer_count) return;
+    TileLayer *layer = &map->tile_layers[layer_index];
+    layer->renderer = renderer;
+    if (renderer == TILE_RENDER_GPU && layer->shader && layer_gpu_effect(map, layer) < 0) {
+        printf("[tilemap] WARNING: No GPU effect for shader %s, layer %s draws per tile\n",
+               tilemap_string(map, layer->shader), layer->name);
+    }
+}
+
+static void release_gpu_renderer(TileMap *map) {
+    for (int i = 0; i < map->tile_layer_count; i++) {
+        if (map->tile_layers[i].gpu_cells.id != 0) UnloadTexture(map->tile_layers[i].gpu_cells);
+    }
+    if (!map->gpu) return;
+    if (map->gpu->sources.id != 0) UnloadTexture(map->gpu->sources);
+    if (map->gpu->anims.id != 0) UnloadTexture(map->gpu->anims);
+    unload_gpu_layer_shader(&map->gpu->plain);
+    for (int e = 0; e < GPU_EFFECTS_MAX; e++) unload_gpu_layer_shader(&map->gpu->effects[e]);
+    free(map->gpu);
+}
+
+static void release_baked_chunks(TileMap *map) {
+    if (!map->baked) return;
+    int total = map->tile_layer_count * map->bake_cols * map->bake_rows;
+    for (int i = 0; i < total; i++) {
+        if (map->baked[i].target.id != 0) UnloadRenderTexture(map->baked[i].target);
+        free(map->baked[i].overlay);
+    }
+    free(map->baked);
+    map->baked = NULL;
+    map->bake_bytes = 0;
+}
+
+void tilemap_unload(TileMap *map) {
+    if (!map) return;
+
+    for (int i = 0; i < map->tileset_count; i++) {
+        if (map->tilesets[i].texture.id > 0) {
+            assets_release_texture(map->tilesets[i].texture);
+        }
+    }
+
+    // Resident chunk data comes and goes while the map is used, so it is
+    // malloc'd rather than taken from the arena
+    for (int i = 0; i < map->tile_layer_count; i++) {
+        TileLayer *layer = &map->tile_layers[i];
+        for (int c = 0; c < layer->chunk_count; c++) {
+            free(layer->chunks[c].data);
+        }
+        tile_palette_free(&layer->packed);
+        for (int level = 0; level < TILEMAP_OVERVIEW_LEVELS; level++) {
+            if (layer->overview[level].id != 0) UnloadTexture(layer->overview[level]);
+        }
+    }
+
+    release_baked_chunks(map);
+    release_gpu_renderer(map);
+    if (map->batches) {
+        for (int t = 0; t < map->tileset_count; t++) {
+            tile_batch_free(&map->batches[t]);
+            if (map->batch_meshes[t].vaoId != 0) UnloadMesh(map->batch_meshes[t]);
+        }
+        free(map->batches);
+        free(map->batch_meshes);
+    }
+    // Not UnloadMaterial(): that would unload the tileset texture last bound
+    free(map->batch_material.maps);
+
+    platform_unmap_file(&map->cooked);
+    platform_unmap_file(&map->source);
+    // The map itself lives in its arena
+    arena_destroy(map->arena);
+}
+
+void tilemap_update(TileMap *map, float dt) {
+    if (!map) return;
+    map->anim_time += (double)(dt * 1000.0f);
+    advance_animations(map);
+}
+
+// Tile range covered by the camera view (plus a one tile border), unclamped
+static void visible_tile_range(const TileMap *map, Camera2D camera,
+                               int *start_x, int *start_y, int *end_x, int *end_y) {
+    float cam_x = camera.target.x - camera.offset.x / camera.zoom;
+    float cam_y = camera.target.y - camera.offset.y / camera.zoom;
     float view_w = GetScreenWidth() / camera.zoom;
     float view_h = GetScreenHeight() / camera.zoom;
 
-    int start_x = (int)(cam_x / map->tilewidth) - 1;
-    int start_y = (int)(cam_y / map->tileheight) - 1;
-    int end_x = (int)((cam_x + view_w) / map->tilewidth) + 2;
-    int end_y = (int)((cam_y + view_h) / map->tileheight) + 2;
+    *start_x = (int)floorf(cam_x / map->tilewidth) - 1;
+    *start_y = (int)floorf(cam_y / map->tileheight) - 1;
+    *end_x = (int)floorf((cam_x + view_w) / map->tilewidth) + 2;
+    *end_y = (int)floorf((cam_y + view_h) / map->tileheight) + 2;
+}
+
+// Decoded GIDs plus draw descriptors of a resident chunk (one allocation)
+static size_t chunk_resident_bytes(const TileChunk *chunk) {
+    return (size_t)chunk->width * chunk->height * 2 * sizeof(uint32_t);
+}
+
+// Decode a chunk's GIDs from the mapped map file
+static bool load_chunk(TileMap *map, const TileLayer *layer, TileChunk *chunk) {
+    int cells = chunk->width * chunk->height;
+    uint32_t *data = (uint32_t *)malloc(chunk_resident_bytes(chunk));
+    if (!data) return false;
+
+    const char *text = (const char *)map->source.data + chunk->source_offset;
+    bool ok;
+    if (layer->chunk_base64) {
+        // Skip the quotes around the string
+        ok = chunk->source_length >= 2 &&
+             tile_codec_decode_layer(text + 1, chunk->source_length - 2,
+                                     layer->chunk_compression, data, cells);
+    } else {
+        JsonStream js;
+        json_stream_init(&js, text, chunk->source_length);
+        ok = json_stream_read_uint32_array(&js, data, cells) == cells;
+    }
+
+    if (!ok) {
+        // Never retried: the chunk is treated as empty from now on
+        printf("[tilemap] WARNING: Bad chunk data at (%d, %d) in layer \"%s\"\n",
+               chunk->x, chunk->y, layer->name);
+        chunk->source_length = 0;
+        free(data);
+        return false;
+    }
+
+    chunk->data = data;
+    chunk->desc = data + cells;
+    fill_descriptors(map, chunk->data, chunk->desc, cells);
+    map->chunk_bytes += chunk_resident_bytes(chunk);
+    return true;
+}
+
+static void evict_chunk(TileMap *map, TileChunk *chunk) {
+    free(chunk->data);
+    chunk->data = NULL;
+    chunk->desc = NULL;
+    map->chunk_bytes -= chunk_resident_bytes(chunk);
+}
+
+// Least recently used resident chunk that was not needed this frame
+static TileChunk *oldest_resident_chunk(TileMap *map) {
+    TileChunk *oldest = NULL;
+    for (int l = 0; l < map->tile_layer_count; l++) {
+        TileLayer *layer = &map->tile_layers[l];
+        for (int i = 0; i < layer->chunk_count; i++) {
+            TileChunk *chunk = &layer->chunks[i];
+            if (!chunk->data || chunk->edited || chunk->last_used == map->chunk_frame) continue;
+            if (!oldest || chunk->last_used < oldest->last_used) oldest = chunk;
+        }
+    }
+    return oldest;
+}
+
+void tilemap_stream_chunks(TileMap *map, Camera2D camera) {
+    if (!map || !map->infinite || map->chunk_width <= 0 || map->chunk_height <= 0) return;
+    map->chunk_frame++;
+
+    int start_x, start_y, end_x, end_y;
+    visible_tile_range(map, camera, &start_x, &start_y, &end_x, &end_y);
+
+    // One chunk of margin so chunks are decoded before they scroll into view
+    int cx0 = floor_div(start_x, map->chunk_width) - 1;
+    int cy0 = floor_div(start_y, map->chunk_height) - 1;
+    int cx1 = floor_div(end_x - 1, map->chunk_width) + 1;
+    int cy1 = floor_div(end_y - 1, map->chunk_height) + 1;
+
+    for (int l = 0; l < map->tile_layer_count; l++) {
+        TileLayer *layer = &map->tile_layers[l];
+        if (!layer->chunk_slots) continue;
+        for (int cy = cy0; cy <= cy1; cy++) {
+            for (int cx = cx0; cx <= cx1; cx++) {
+                TileChunk *chunk = find_chunk(map, layer, cx, cy);
+                if (!chunk) continue;
+                chunk->last_used = map->chunk_frame;
+                if (!chunk->data && chunk->source_length > 0) load_chunk(map, layer, chunk);
+            }
+        }
+    }
+
+    // Chunks near the camera are never evicted, so a view larger than the
+    // budget keeps everything it needs
+    while (map->chunk_bytes > map->chunk_budget) {
+        TileChunk *oldest = oldest_resident_chunk(map);
+        if (!oldest) break;
+        evict_chunk(map, oldest);
+    }
+}
+
+void tilemap_set_chunk_budget(TileMap *map, size_t bytes) {
+    if (!map) return;
+    map->chunk_budget = bytes;
+}
+
+// The eight Tiled flip combinations, indexed by desc >> TILE_DESC_ORIENT_SHIFT
+// (H, V, D bits). Diagonal flips become a 90/270 degree rotation, with the
+// destination shifted back by a tile and the source mirrored as needed.
+typedef struct TileOrientation {
+    float rotation;
+    float src_w, src_h;       // source width/height sign
+    float dst_x, dst_y;       // destination offset in tiles
+} TileOrientation;
+
+static const TileOrientation tile_orientations[8] = {
+    [0] = { 0.0f,    1.0f,  1.0f, 0.0f, 0.0f },   // none
+    [1] = { 270.0f, -1.0f,  1.0f, 0.0f, 1.0f },   // D
+    [2] = { 0.0f,    1.0f, -1.0f, 0.0f, 0.0f },   // V
+    [3] = { 270.0f,  1.0f,  1.0f, 0.0f, 1.0f },   // V + D
+    [4] = { 0.0f,   -1.0f,  1.0f, 0.0f, 0.0f },   // H
+    [5] = { 90.0f,   1.0f,  1.0f, 1.0f, 0.0f },   // H + D
+    [6] = { 0.0f,   -1.0f, -1.0f, 0.0f, 0.0f },   // H + V
+    [7] = { 90.0f,  -1.0f,  1.0f, 1.0f, 0.0f },   // H + V + D
+};
+
+static void draw_cell(TileMap *map, uint32_t desc, int x, int y, Color tint) {
+    uint32_t index = desc & TILE_DESC_SOURCE_MASK;
+    if (desc & TILE_DESC_ANIMATED) index = map->anim_current[index];
+    const TileSource *source = &map->tile_sources[index];
+    Texture2D texture = map->tilesets[source->tileset].texture;
+    if (texture.id == 0) return;
+
+    const TileOrientation *o = &tile_orientations[desc >> TILE_DESC_ORIENT_SHIFT];
+    Rectangle src = source->src;
+    src.width *= o->src_w;
+    src.height *= o->src_h;
+    Rectangle dst = {
+        (float)((x + o->dst_x) * map->tilewidth),
+        (float)((y + o->dst_y) * map->tileheight),
+        (float)map->tilewidth,
+        (float)map->tileheight
+    };
+    DrawTexturePro(texture, src, dst, (Vector2){0, 0}, o->rotation, tint);
+}
+
+// Infinite layers: the same culling, applied to each resident chunk in view
+static void draw_chunked_layer(TileMap *map, TileLayer *layer, int start_x, int start_y,
+                               int end_x, int end_y, Color tint) {
+    int cx0 = floor_div(start_x, map->chunk_width);
+    int cy0 = floor_div(start_y, map->chunk_height);
+    int cx1 = floor_div(end_x - 1, map->chunk_width);
+    int cy1 = floor_div(end_y - 1, map->chunk_height);
+
+    for (int cy = cy0; cy <= cy1; cy++) {
+        for (int cx = cx0; cx <= cx1; cx++) {
+            TileChunk *chunk = find_chunk(map, layer, cx, cy);
+            if (!chunk || !chunk->desc) continue;
+
+            int x0 = start_x > chunk->x ? start_x : chunk->x;
+            int y0 = start_y > chunk->y ? start_y : chunk->y;
+            int x1 = end_x < chunk->x + chunk->width ? end_x : chunk->x + chunk->width;
+            int y1 = end_y < chunk->y + chunk->height ? end_y : chunk->y + chunk->height;
+
+            for (int y = y0; y < y1; y++) {
+                const uint32_t *row = chunk->desc + (y - chunk->y) * chunk->width;
+                for (int x = x0; x < x1; x++) {
+                    if (row[x - chunk->x]) draw_cell(map, row[x - chunk->x], x, y, tint);
+                }
+            }
+        }
+    }
+}
+
+static bool layer_occludes(const TileLayer *layer) {
+    return layer->occluder && layer->visible && layer->opacity >= 1.0f && !layer->shader &&
+           layer_has_cells(layer) && !layer->chunk_slots;
+}
+
+static uint8_t desc_alpha(const TileMap *map, uint32_t desc) {
+    uint32_t index = desc & TILE_DESC_SOURCE_MASK;
+    if (desc & TILE_DESC_ANIMATED) index = map->anim_gids[index];
+    return map->tile_sources[index].alpha;
+}
+
+static bool cell_hidden(const uint8_t *hidden, size_t i) {
+    return hidden && (hidden[i >> 3] >> (i & 7)) & 1;
+}
+
+static BakedChunk *baked_chunk(const TileMap *map, int layer_index, int bx, int by) {
+    return &map->baked[(layer_index * map->bake_rows + by) * map->bake_cols + bx];
+}
+
+// Mark a layer's baked chunks dirty where its hidden mask differs from
+// `previous` (same layout), or all of them without one
+static void dirty_baked_hidden(TileMap *map, int layer_index, const uint8_t *previous, size_t mask_bytes) {
+    if (!map->baked) return;
+    const TileLayer *layer = &map->tile_layers[layer_index];
+    if (!previous) {
+        for (int by = 0; by < map->bake_rows; by++) {
+            for (int bx = 0; bx < map->bake_cols; bx++) {
+                BakedChunk *bc = baked_chunk(map, layer_index, bx, by);
+                if (bc->baked) bc->dirty = true;
+            }
+        }
+        return;
+    }
+    size_t plane_cells = (size_t)layer->width * layer->height;
+    for (size_t i = 0; i < mask_bytes; i++) {
+        uint8_t changed = previous[i] ^ (layer->hidden ? layer->hidden[i] : 0);
+        for (int bit = 0; changed; bit++, changed >>= 1) {
+            if (!(changed & 1)) continue;
+            size_t cell = (i * 8 + bit) % plane_cells;
+            int x = (int)(cell % layer->width), y = (int)(cell / layer->width);
+            if (x >= map->width || y >= map->height) continue;
+            BakedChunk *bc = baked_chunk(map, layer_index, x / TILEMAP_BAKE_CHUNK, y / TILEMAP_BAKE_CHUNK);
+            if (bc->baked) bc->dirty = true;
+        }
+    }
+}
+
+// Order of two layers in the assumed draw order
+static int compare_draw_order(const TileMap *map, int a, int b) {
+    int pa = map->tile_layers[a].draw_pass, pb = map->tile_layers[b].draw_pass;
+    return pa != pb ? (pa > pb) - (pa < pb) : (a > b) - (a < b);
+}
+
+// Rebuild every finite layer's hidden mask, walking the layers and their
+// planes from the last drawn down: a tile is hidden once an opaque tile of an
+// occluding layer has covered its cell, or if it draws nothing at all
+static void rebuild_occlusion(TileMap *map) {
+    map->occlusion_dirty = false;
+    map->hidden_cells = 0;
+    int count = map->tile_layer_count;
+    int *order = (int *)malloc((count > 0 ? count : 1) * sizeof(int));
+    uint8_t *covered = (uint8_t *)calloc((size_t)map->width * map->height, 1);
+    if (!order || !covered) {
+        // Nothing culled until a later rebuild succeeds; the stale masks
+        // stay in the arena, and bakes made with them are redone
+        free(order);
+        free(covered);
+        for (int l = 0; l < count; l++) {
+            if (map->tile_layers[l].hidden) dirty_baked_hidden(map, l, NULL, 0);
+            map->tile_layers[l].hidden = NULL;
+            map->tile_layers[l].hidden_chunks = NULL;
+        }
+        return;
+    }
+    for (int i = 0; i < count; i++) {
+        int j = i;
+        for (; j > 0 && compare_draw_order(map, order[j - 1], i) > 0; j--) order[j] = order[j - 1];
+        order[j] = i;
+    }
+
+    int cols = (map->width + TILEMAP_BAKE_CHUNK - 1) / TILEMAP_BAKE_CHUNK;
+    int rows = (map->height + TILEMAP_BAKE_CHUNK - 1) / TILEMAP_BAKE_CHUNK;
+    for (int k = count - 1; k >= 0; k--) {
+        TileLayer *layer = &map->tile_layers[order[k]];
+        layer->occluding = layer_occludes(layer);
+        if (!layer_has_cells(layer) || layer->chunk_slots) continue;
+
+        // Sized for the plane capacity, so add_plane() keeps the mask
+        size_t plane_cells = (size_t)layer->width * layer->height;
+        int capacity = layer->plane_capacity > layer->planes ? layer->plane_capacity : layer->planes;
+        size_t mask_bytes = (plane_cells * layer->planes + 7) / 8;
+        bool had_mask = layer->hidden != NULL;
+        if (!layer->hidden) layer->hidden = (uint8_t *)arena_alloc(map->arena, (plane_cells * capacity + 7) / 8);
+        if (!layer->hidden_chunks) layer->hidden_chunks = (uint8_t *)arena_alloc(map->arena, (size_t)cols * rows);
+        if (!layer->hidden || !layer->hidden_chunks) {
+            if (had_mask) dirty_baked_hidden(map, order[k], NULL, 0);
+            layer->hidden = NULL;
+            layer->hidden_chunks = NULL;
+            continue;
+        }
+        // Baked chunks leave hidden cells out, so the ones whose cells
+        // changed are rebaked
+        uint8_t *previous = had_mask && map->baked ? (uint8_t *)malloc(mask_bytes) : NULL;
+        if (previous) memcpy(previous, layer->hidden, mask_bytes);
+        memset(layer->hidden, 0, mask_bytes);
+        memset(layer->hidden_chunks, 1, (size_t)cols * rows);
+
+        for (int p = layer->planes - 1; p >= 0; p--) {
+            for (int y = 0; y < layer->height; y++) {
+                size_t base = p * plane_cells + (size_t)y * layer->width;
+                const uint32_t *row = layer_desc_run(map, layer, p, y, 0, layer->width);
+                for (int x = 0; x < layer->width; x++) {
+                    uint32_t desc = row[x];
+                    if (!desc) continue;
+                    // Cells outside the map (a layer larger than it) only
+                    // drop empty tiles
+                    bool in_map = x < map->width && y < map->height;
+                    uint8_t *cover = in_map ? &covered[(size_t)y * map->width + x] : NULL;
+                    uint8_t alpha = desc_alpha(map, desc);
+                    if (alpha == TILE_ALPHA_EMPTY || (cover && *cover)) {
+                        layer->hidden[(base + x) >> 3] |= (uint8_t)(1u << ((base + x) & 7));
+                        map->hidden_cells++;
+                        continue;
+                    }
+                    if (!in_map) continue;
+                    layer->hidden_chunks[(y / TILEMAP_BAKE_CHUNK) * cols + x / TILEMAP_BAKE_CHUNK] = 0;
+                    if (layer->occluding && alpha == TILE_ALPHA_OPAQUE) *cover = 1;
+                }
+            }
+        }
+        dirty_baked_hidden(map, order[k], previous, mask_bytes);
+        free(previous);
+    }
+    free(order);
+    free(covered);
+}
+
+// Hidden mask of a finite layer, rebuilt first if a pass, occluder, tile or
+// visibility/opacity change made it stale. NULL when nothing is culled.
+static const uint8_t *layer_hidden(TileMap *map, TileLayer *layer) {
+    if (!map->occlusion || map->infinite || layer->chunk_slots) return NULL;
+    bool stale = map->occlusion_dirty;
+    for (int l = 0; l < map->tile_layer_count && !stale; l++) {
+        stale = layer_occludes(&map->tile_layers[l]) != map->tile_layers[l].occluding;
+    }
+    if (stale) rebuild_occlusion(map);
+    return layer->hidden;
+}
+
+void tilemap_set_layer_pass(TileMap *map, int layer_index, int pass, bool occluder) {
+    if (!map || layer_index < 0 || layer_index >= map->tile_layer_count) return;
+    TileLayer *layer = &map->tile_layers[layer_index];
+    if (layer->draw_pass == pass && layer->occluder == occluder) return;
+    layer->draw_pass = pass;
+    layer->occluder = occluder;
+    map->occlusion_dirty = true;
+}
+
+void tilemap_set_occlusion(TileMap *map, bool enabled) {
+    if (!map) return;
+    // Bakes leave out the cells the masks hide
+    if (enabled != map->occlusion) {
+        for (int l = 0; l < map->tile_layer_count; l++) dirty_baked_hidden(map, l, NULL, 0);
+    }
+    map->occlusion = enabled;
+    map->occlusion_dirty = true;
+    map->hidden_cells = 0;
+}
+
+// Clamp a tile range to a finite layer's occupied bounds, building its span
+// index first if tiles changed or the map was only parsed
+// (tilemap_parse_json()). False if nothing in the range is occupied.
+static bool clip_to_occupied(const TileMap *map, TileLayer *layer, int *start_x, int *start_y,
+                             int *end_x, int *end_y) {
+    if (layer->spans_dirty || !layer->span_rows) build_layer_spans(map, layer);
+    if (*start_x < layer->occupied[0]) *start_x = layer->occupied[0];
+    if (*start_y < layer->occupied[1]) *start_y = layer->occupied[1];
+    if (*end_x > layer->occupied[2]) *end_x = layer->occupied[2];
+    if (*end_y > layer->occupied[3]) *end_y = layer->occupied[3];
+    return *start_x < *end_x && *start_y < *end_y;
+}
+
+// Occupied runs of row y (the whole row if there is no span index)
+static const TileSpan *row_spans(const TileLayer *layer, int y, TileSpan *whole, int *count) {
+    if (!layer->span_rows) {
+        *whole = (TileSpan){ 0, layer->width };
+        *count = 1;
+        return whole;
+    }
+    *count = layer->span_rows[y + 1] - layer->span_rows[y];
+    return layer->spans + layer->span_rows[y];
+}
+
+// Queue the cells of a descriptor grid (top-left tile origin_x/origin_y,
+// `stride` cells per row) that fall in [x0, x1) x [y0, y1). `hidden` is the
+// layer's mask (NULL for none), indexed from `hidden_base` at the origin.
+static int batch_cells(TileMap *map, const uint32_t *desc, int stride, int origin_x, int origin_y,
+                       int x0, int y0, int x1, int y1, const uint8_t *hidden, size_t hidden_base,
+                       Color tint) {
+    const unsigned char color[4] = { tint.r, tint.g, tint.b, tint.a };
+    float tw = (float)map->tilewidth, th = (float)map->tileheight;
+    int quads = 0;
+    for (int y = y0; y < y1; y++) {
+        const uint32_t *row = desc + (y - origin_y) * stride - origin_x;
+        size_t row_base = hidden_base + (size_t)(y - origin_y) * stride - origin_x;
+        for (int x = x0; x < x1; x++) {
+            uint32_t cell = row[x];
+            if (!cell || cell_hidden(hidden, row_base + x)) continue;
+            uint32_t index = cell & TILE_DESC_SOURCE_MASK;
+            if (cell & TILE_DESC_ANIMATED) index = map->anim_current[index];
+            const TileSource *source = &map->tile_sources[index];
+            TileBatch *batch = &map->batches[source->tileset];
+            if (batch->quad_count == batch->quad_capacity &&
+                !tile_batch_reserve(batch, batch->quad_count + 1)) continue;
+            tile_batch_add(batch, x * tw, y * th, tw, th, source->uv,
+                           (int)(cell >> TILE_DESC_ORIENT_SHIFT), color);
+            quads++;
+        }
+    }
+    return quads;
+}
+
+// tilemap_build_layer_batch() for planes [first_plane, last_plane) of a
+// finite layer (chunked layers have one plane)
+static int build_batches(TileMap *map, int layer_index, int first_plane, int last_plane, int start_x, int start_y,
+                         int end_x, int end_y, Color tint) {
+    if (!map || layer_index < 0 || layer_index >= map->tile_layer_count) return 0;
+    if (!map->batches) {
+        map->batches = (TileBatch *)calloc(map->tileset_count, sizeof(TileBatch));
+        map->batch_meshes = (Mesh *)calloc(map->tileset_count, sizeof(Mesh));
+        if (!map->batches || !map->batch_meshes) {
+            free(map->batches);
+            free(map->batch_meshes);
+            map->batches = NULL;
+            map->batch_meshes = NULL;
+            return 0;
+        }
+    }
+    for (int t = 0; t < map->tileset_count; t++) map->batches[t].quad_count = 0;
+
+    TileLayer *layer = &map->tile_layers[layer_index];
+    if (!layer->chunk_slots) {
+        if (!layer_has_cells(layer) || !clip_to_occupied(map, layer, &start_x, &start_y, &end_x, &end_y)) {
+            return 0;
+        }
+        const uint8_t *hidden = layer_hidden(map, layer);
+        size_t plane_cells = (size_t)layer->width * layer->height;
+        int quads = 0;
+        for (int p = first_plane; p < last_plane && p < layer->planes; p++) {
+            for (int y = start_y; y < end_y; y++) {
+                TileSpan whole;
+                int count;
+                const TileSpan *spans = row_spans(layer, y, &whole, &count);
+                for (int s = 0; s < count; s++) {
+                    int x0 = spans[s].x0 > start_x ? spans[s].x0 : start_x;
+                    int x1 = spans[s].x1 < end_x ? spans[s].x1 : end_x;
+                    if (x0 >= x1) continue;
+                    const uint32_t *run = layer_desc_run(map, layer, p, y, x0, x1);
+                    quads += batch_cells(map, run, layer->width, x0, y, x0, y, x1, y + 1,
+                                         hidden, p * plane_cells + (size_t)y * layer->width + x0, tint);
+                }
+            }
+        }
+        return quads;
+    }
+
+    int quads = 0;
+    int cx0 = floor_div(start_x, map->chunk_width);
+    int cy0 = floor_div(start_y, map->chunk_height);
+    int cx1 = floor_div(end_x - 1, map->chunk_width);
+    int cy1 = floor_div(end_y - 1, map->chunk_height);
+    for (int cy = cy0; cy <= cy1; cy++) {
+        for (int cx = cx0; cx <= cx1; cx++) {
+            TileChunk *chunk = find_chunk(map, layer, cx, cy);
+            if (!chunk || !chunk->desc) continue;
+            int x0 = start_x > chunk->x ? start_x : chunk->x;
+            int y0 = start_y > chunk->y ? start_y : chunk->y;
+            int x1 = end_x < chunk->x + chunk->width ? end_x : chunk->x + chunk->width;
+            int y1 = end_y < chunk->y + chunk->height ? end_y : chunk->y + chunk->height;
+            quads += batch_cells(map, chunk->desc, chunk->width, chunk->x, chunk->y, x0, y0, x1, y1,
+                                 NULL, 0, tint);
+        }
+    }
+    return quads;
+}
+
+int tilemap_build_layer_batch(TileMap *map, int layer_index, int start_x, int start_y,
+                              int end_x, int end_y, Color tint) {
+    return build_batches(map, layer_index, 0, INT_MAX, start_x, start_y, end_x, end_y, tint);
+}
+
+// Upload each non-empty tileset batch into its mesh (reallocated only when a
+// batch outgrows it) and draw it
+static void draw_batches(TileMap *map) {
+    if (!map->batch_material.maps) map->batch_material = LoadMaterialDefault();
+    if (!map->batch_material.maps) return;
+    // Flush what is queued in rlgl's immediate batch, so draw order is kept
+    rlDrawRenderBatchActive();
 
-    if (start_x < 0) start_x = 0;
-    if (start_y < 0) start_y = 0;
-    if (end_x > layer->width) end_x = layer->width;
-    if (end_y > layer->height) end_y = layer->height;
+    for (int t = 0; t < map->tileset_count; t++) {
+        TileBatch *batch = &map->batches[t];
+        Texture2D texture = map->tilesets[t].texture;
+        if (batch->quad_count == 0 || texture.id == 0) continue;
 
-    // Merge caller's tint alpha with layer opacity
-    tint.a = (unsigned char)(tint.a * layer->opacity);
+        Mesh *mesh = &map->batch_meshes[t];
+        int vertex_count = batch->quad_count * 6;
+        if (mesh->vertexCount < vertex_count) {
+            if (mesh->vaoId != 0) UnloadMesh(*mesh);
+            *mesh = (Mesh){ 0 };
+            mesh->vertexCount = batch->quad_capacity * 6;
+            mesh->triangleCount = batch->quad_capacity * 2;
+            mesh->vertices = batch->vertices;
+            mesh->texcoords = batch->texcoords;
+            mesh->colors = batch->colors;
+            UploadMesh(mesh, true);
+            // The CPU arrays stay owned by the batch
+            mesh->vertices = NULL;
+            mesh->texcoords = NULL;
+            mesh->colors = NULL;
+        } else {
+            UpdateMeshBuffer(*mesh, 0, batch->vertices, vertex_count * 3 * sizeof(float), 0);
+            UpdateMeshBuffer(*mesh, 1, batch->texcoords, vertex_count * 2 * sizeof(float), 0);
+            UpdateMeshBuffer(*mesh, 3, batch->colors, vertex_count * 4, 0);
+        }
+
+        Mesh draw = *mesh;
+        draw.vertexCount = vertex_count;
+        draw.triangleCount = batch->quad_count * 2;
+        map->batch_material.maps[MATERIAL_MAP_DIFFUSE].texture = texture;
+        DrawMesh(draw, map->batch_material, MatrixIdentity());
+    }
+}
+
+void tilemap_set_batching(TileMap *map, bool enabled) {
+    if (!map) return;
+    map->batching = enabled;
+}
+
+// Tiles of a layer in [start_x, end_x) x [start_y, end_y)
+static void draw_layer_region(TileMap *map, TileLayer *layer, int start_x, int start_y,
+                              int end_x, int end_y, Color tint) {
+    if (map->batching && !layer->shader) {
+        int layer_index = (int)(layer - map->tile_layers);
+        // Batches draw one tileset after another, so a merged layer that
+        // stacks a cell's tiles across tilesets out of that order draws
+        // one plane at a time
+        bool per_plane = false;
+        if (layer->planes > 1) {
+            if (layer->spans_dirty || !layer->span_rows) build_layer_spans(map, layer);
+            per_plane = layer->planes_cross_tilesets;
+        }
+        for (int p = 0; p < (per_plane ? layer->planes : 1); p++) {
+            int first = per_plane ? p : 0, last = per_plane ? p + 1 : layer->planes;
+            if (build_batches(map, layer_index, first, last, start_x, start_y, end_x, end_y, tint) > 0) {
+                draw_batches(map);
+            }
+        }
+        return;
+    }
+    if (layer->chunk_slots) {
+        draw_chunked_layer(map, layer, start_x, start_y, end_x, end_y, tint);
+        return;
+    }
+
+    if (!clip_to_occupied(map, layer, &start_x, &start_y, &end_x, &end_y)) return;
 
-    for (int y = start_y; y < end_y; y++) {
-        for (int x = start_x; x < end_x; x++) {
-            uint32_t raw_gid = layer->data[y * layer->width + x];
-            uint32_t gid = raw_gid & GID_MASK;
-            if (gid == 0) continue;
-
-            // Find owning tileset (largest firstgid <= gid)
-            TilesetInfo *ts = NULL;
-            for (int t = map->tileset_count - 1; t >= 0; t--) {
-                if ((uint32_t)map->tilesets[t].firstgid <= gid) {
-                    ts = &map->tilesets[t];
-                    break;
+    const uint8_t *hidden = layer_hidden(map, layer);
+    size_t plane_cells = (size_t)layer->width * layer->height;
+    for (int p = 0; p < layer->planes; p++) {
+        for (int y = start_y; y < end_y; y++) {
+            size_t row_base = p * plane_cells + (size_t)y * layer->width;
+            TileSpan whole;
+            int count;
+            const TileSpan *spans = row_spans(layer, y, &whole, &count);
+            for (int s = 0; s < count; s++) {
+                int x0 = spans[s].x0 > start_x ? spans[s].x0 : start_x;
+                int x1 = spans[s].x1 < end_x ? spans[s].x1 : end_x;
+                if (x0 >= x1) continue;
+                const uint32_t *row = layer_desc_run(map, layer, p, y, x0, x1);
+                for (int x = x0; x < x1; x++) {
+                    uint32_t cell = row[x - x0];
+                    if (cell && !cell_hidden(hidden, row_base + x)) draw_cell(map, cell, x, y, tint);
                 }
             }
-            if (!ts || ts->texture.id == 0) continue;
+        }
+    }
+}
+
+// Descriptor of one cell (in one plane) of a layer, finite or chunked.
+// *missing is set when the cell lies in a chunk that is not decoded right now.
+static uint32_t layer_desc_at(const TileMap *map, const TileLayer *layer, int plane, int x, int y,
+                              bool *missing) {
+    if (!layer->chunk_slots) {
+        if (!layer_has_cells(layer) || x < 0 || y < 0 || x >= layer->width || y >= layer->height) return 0;
+        if (!layer->desc) return tile_palette_get(&layer->packed, x, plane * layer->height + y);
+        return layer->desc[(plane * layer->height + y) * layer->width + x];
+    }
+    TileChunk *chunk = find_chunk(map, layer, floor_div(x, map->chunk_width), floor_div(y, map->chunk_height));
+    if (!chunk) return 0;
+    if (!chunk->desc) {
+        if (chunk->source_length > 0) *missing = true;
+        return 0;
+    }
+    return chunk->desc[(y - chunk->y) * chunk->width + (x - chunk->x)];
+}
 
-            int local_id = (int)gid - ts->firstgid;
+// Tile rect covered by bake chunk (bx, by), clipped to the map
+static void bake_chunk_rect(const TileMap *map, int bx, int by, int *x0, int *y0, int *w, int *h) {
+    *x0 = map->startx + bx * TILEMAP_BAKE_CHUNK;
+    *y0 = map->starty + by * TILEMAP_BAKE_CHUNK;
+    *w = map->startx + map->width - *x0;
+    *h = map->starty + map->height - *y0;
+    if (*w > TILEMAP_BAKE_CHUNK) *w = TILEMAP_BAKE_CHUNK;
+    if (*h > TILEMAP_BAKE_CHUNK) *h = TILEMAP_BAKE_CHUNK;
+}
 
-            // Resolve animated tile to current frame
-            if (ts->anim_lookup && local_id >= 0 && local_id < ts->tilecount) {
-                TileAnim *anim = &ts->anim_lookup[local_id];
-                if (anim->frame_count > 0) {
-                    int t = (int)fmod(map->anim_time, (double)anim->total_duration);
-                    int acc = 0;
-                    for (int f = 0; f < anim->frame_count; f++) {
-                        acc += anim->frames[f].duration;
-                        if (t < acc) {
-                            local_id = anim->frames[f].tileid;
-                            break;
-                        }
-                    }
+static size_t baked_texture_bytes(const BakedChunk *bc) {
+    return (size_t)bc->target.texture.width * bc->target.texture.height * 4;
+}
+
+static void evict_baked(TileMap *map, BakedChunk *bc) {
+    if (bc->target.id != 0) {
+        map->bake_bytes -= baked_texture_bytes(bc);
+        UnloadRenderTexture(bc->target);
+    }
+    free(bc->overlay);
+    memset(bc, 0, sizeof(*bc));
+}
+
+// Least recently used baked chunk that is not in view this frame
+static BakedChunk *oldest_baked(TileMap *map) {
+    BakedChunk *oldest = NULL;
+    int total = map->tile_layer_count * map->bake_cols * map->bake_rows;
+    for (int i = 0; i < total; i++) {
+        BakedChunk *bc = &map->baked[i];
+        if (bc->target.id == 0 || bc->last_used == map->bake_frame) continue;
+        if (!oldest || bc->last_used < oldest->last_used) oldest = bc;
+    }
+    return oldest;
+}
+
+static bool make_bake_room(TileMap *map, size_t bytes) {
+    while (map->bake_bytes + bytes > map->bake_budget) {
+        BakedChunk *oldest = oldest_baked(map);
+        if (!oldest) return false;
+        evict_baked(map, oldest);
+    }
+    return true;
+}
+
+// Descriptor of a cell as a bake draws it: 0 if the layer's hidden mask
+// (NULL for none) hides it
+static uint32_t baked_desc_at(const TileMap *map, const TileLayer *layer, const uint8_t *hidden,
+                              int plane, int x, int y, bool *missing) {
+    uint32_t desc = layer_desc_at(map, layer, plane, x, y, missing);
+    if (desc && cell_hidden(hidden, ((size_t)plane * layer->height + y) * layer->width + x)) return 0;
+    return desc;
+}
+
+// Render the static tiles of a chunk into its texture and collect the
+// animated ones into its overlay, leaving out the cells `hidden` hides.
+// False if it cannot be baked right now (source chunks not decoded, or no
+// room in the budget).
+static bool bake_chunk(TileMap *map, const TileLayer *layer, const uint8_t *hidden, int bx, int by,
+                       BakedChunk *bc) {
+    int x0, y0, w, h;
+    bake_chunk_rect(map, bx, by, &x0, &y0, &w, &h);
+
+    // An animated tile and every tile stacked above it in its cell go to the
+    // overlay, so the cell still draws bottom to top
+    int static_count = 0, overlay_count = 0;
+    int bounds[4] = { w, h, 0, 0 };
+    bool missing = false;
+    for (int y = y0; y < y0 + h && !missing; y++) {
+        for (int x = x0; x < x0 + w; x++) {
+            bool overlay = false;
+            for (int p = 0; p < layer->planes; p++) {
+                uint32_t desc = baked_desc_at(map, layer, hidden, p, x, y, &missing);
+                if (desc & TILE_DESC_ANIMATED) overlay = true;
+                if (!desc) continue;
+                if (overlay) {
+                    overlay_count++;
+                    continue;
                 }
+                static_count++;
+                if (x - x0 < bounds[0]) bounds[0] = x - x0;
+                if (y - y0 < bounds[1]) bounds[1] = y - y0;
+                if (x - x0 + 1 > bounds[2]) bounds[2] = x - x0 + 1;
+                bounds[3] = y - y0 + 1;
             }
+        }
+    }
+    if (missing) return false;
+    memcpy(bc->bounds, bounds, sizeof(bounds));
 
-            int col = local_id % ts->columns;
-            int row = local_id / ts->columns;
+    // Chunks without static tiles keep no texture; only the overlay is drawn
+    int tex_w = w * map->tilewidth, tex_h = h * map->tileheight;
+    if (static_count == 0 && bc->target.id != 0) {
+        map->bake_bytes -= baked_texture_bytes(bc);
+        UnloadRenderTexture(bc->target);
+        bc->target = (RenderTexture2D){ 0 };
+    } else if (static_count > 0 && bc->target.id == 0) {
+        if (!make_bake_room(map, (size_t)tex_w * tex_h * 4)) return false;
+        bc->target = LoadRenderTexture(tex_w, tex_h);
+        if (bc->target.id == 0) return false;
+        map->bake_bytes += baked_texture_bytes(bc);
+    }
 
-            Rectangle src = {
-                (float)(ts->margin + col * (ts->tilewidth + ts->spacing)),
-                (float)(ts->margin + row * (ts->tileheight + ts->spacing)),
-                (float)ts->tilewidth,
-                (float)ts->tileheight
-            };
+    free(bc->overlay);
+    bc->overlay = overlay_count > 0 ? (BakedCell *)malloc(overlay_count * sizeof(BakedCell)) : NULL;
+    bc->overlay_count = 0;
+
+    if (bc->target.id != 0) {
+        BeginTextureMode(bc->target);
+        ClearBackground(BLANK);
+        // Color blended as usual, alpha accumulated as coverage: the texture
+        // ends up premultiplied, so it composites exactly like the tiles would
+        rlSetBlendFactorsSeparate(RL_SRC_ALPHA, RL_ONE_MINUS_SRC_ALPHA, RL_ONE, RL_ONE_MINUS_SRC_ALPHA,
+                                  RL_FUNC_ADD, RL_FUNC_ADD);
+        BeginBlendMode(BLEND_CUSTOM_SEPARATE);
+    }
+    for (int y = y0; y < y0 + h; y++) {
+        for (int x = x0; x < x0 + w; x++) {
+            bool overlay = false;
+            for (int p = 0; p < layer->planes; p++) {
+                uint32_t desc = baked_desc_at(map, layer, hidden, p, x, y, &missing);
+                if (desc & TILE_DESC_ANIMATED) overlay = true;
+                if (!desc) continue;
+                if (!overlay) draw_cell(map, desc, x - x0, y - y0, WHITE);
+                else if (bc->overlay) bc->overlay[bc->overlay_count++] = (BakedCell){ x, y, desc };
+            }
+        }
+    }
+    if (bc->target.id != 0) {
+        EndBlendMode();
+        EndTextureMode();
+    }
 
-            // Handle flip/rotation flags
-            bool flipH = (raw_gid & FLIPPED_H_FLAG) != 0;
-            bool flipV = (raw_gid & FLIPPED_V_FLAG) != 0;
-            bool flipD = (raw_gid & FLIPPED_D_FLAG) != 0;
+    bc->baked = true;
+    bc->dirty = false;
+    return true;
+}
 
-            Rectangle dst = {
-                (float)(x * map->tilewidth),
-                (float)(y * map->tileheight),
-                (float)map->tilewidth,
-                (float)map->tileheight
-            };
+// Bake chunk range covering a tile range, clamped to the grid
+static void bake_chunk_range(const TileMap *map, int start_x, int start_y, int end_x, int end_y,
+                             int *bx0, int *by0, int *bx1, int *by1) {
+    *bx0 = floor_div(start_x - map->startx, TILEMAP_BAKE_CHUNK);
+    *by0 = floor_div(start_y - map->starty, TILEMAP_BAKE_CHUNK);
+    *bx1 = floor_div(end_x - 1 - map->startx, TILEMAP_BAKE_CHUNK);
+    *by1 = floor_div(end_y - 1 - map->starty, TILEMAP_BAKE_CHUNK);
+    if (*bx0 < 0) *bx0 = 0;
+    if (*by0 < 0) *by0 = 0;
+    if (*bx1 > map->bake_cols - 1) *bx1 = map->bake_cols - 1;
+    if (*by1 > map->bake_rows - 1) *by1 = map->bake_rows - 1;
+}
 
-            float rotation = 0;
-            if (flipD) {
-                if (flipH && flipV) {
-                    rotation = 90.0f;
-                    dst.x += map->tilewidth;
-                    src.width = -src.width;
-                } else if (flipH) {
-                    rotation = 90.0f;
-                    dst.x += map->tilewidth;
-                } else if (flipV) {
-                    rotation = 270.0f;
-                    dst.y += map->tileheight;
-                } else {
-                    rotation = 270.0f;
-                    dst.y += map->tileheight;
-                    src.width = -src.width;
+// Render and upload an overview level of a finite layer the first time it
+// is asked for. False if the layer has none at that level.
+static bool ensure_overview(TileMap *map, TileLayer *layer, int level) {
+    if (layer->overview_tried[level]) return layer->overview[level].id != 0;
+    layer->overview_tried[level] = true;
+    if (!map->tile_colors || !map->tile_average) return false;
+    if (!layer_has_cells(layer) || layer->chunk_slots || layer->width <= 0 || layer->height <= 0) return false;
+    int w = layer->width * overview_scale[level], h = layer->height * overview_scale[level];
+    if (w > TILEMAP_OVERVIEW_MAX_SIZE || h > TILEMAP_OVERVIEW_MAX_SIZE) return false;
+    unsigned char *pixels = (unsigned char *)malloc((size_t)w * h * 4);
+    if (!pixels) return false;
+    double start = platform_time_seconds();
+    render_overview(map, layer, level, 0, 0, layer->width, layer->height, pixels);
+    layer->overview[level] = upload_rgba(pixels, w, h);
+    if (level == 1 && layer->overview[level].id != 0) {
+        // Far below one pixel per tile the minified quad would alias
+        GenTextureMipmaps(&layer->overview[level]);
+        SetTextureFilter(layer->overview[level], TEXTURE_FILTER_TRILINEAR);
+    }
+    TILEMAP_LOG("[tilemap] Overview of \"%s\": %dx%d in %.2f ms\n", layer->name, w, h, elapsed_ms(start));
+    return layer->overview[level].id != 0;
+}
+
+// Overview level a layer draws from with this camera, -1 for tiles: the
+// 4-pixel level while a tile covers at most overview_px screen pixels, the
+// 1-pixel level from one pixel down (or whichever of the two can be built)
+static int overview_level(TileMap *map, TileLayer *layer, Camera2D camera) {
+    float px = map->tilewidth * camera.zoom;
+    if (map->overview_px <= 0.0f || px > map->overview_px) return -1;
+    int level = px <= 1.0f ? 1 : 0;
+    if (ensure_overview(map, layer, level)) return level;
+    return ensure_overview(map, layer, 1 - level) ? 1 - level : -1;
+}
+
+void tilemap_bake_chunks(TileMap *map, Camera2D camera) {
+    if (!map || !map->loaded || map->bake_budget == 0) return;
+    if (map->width <= 0 || map->height <= 0 || map->tilewidth <= 0 || map->tileheight <= 0) return;
+
+    if (!map->baked) {
+        map->bake_cols = (map->width + TILEMAP_BAKE_CHUNK - 1) / TILEMAP_BAKE_CHUNK;
+        map->bake_rows = (map->height + TILEMAP_BAKE_CHUNK - 1) / TILEMAP_BAKE_CHUNK;
+        map->baked = (BakedChunk *)calloc((size_t)map->tile_layer_count * map->bake_cols * map->bake_rows,
+                                          sizeof(BakedChunk));
+        if (!map->baked) return;
+    }
+    map->bake_frame++;
+
+    int start_x, start_y, end_x, end_y;
+    visible_tile_range(map, camera, &start_x, &start_y, &end_x, &end_y);
+    int bx0, by0, bx1, by1;
+    bake_chunk_range(map, start_x, start_y, end_x, end_y, &bx0, &by0, &bx1, &by1);
+
+    int bakes = 0;
+    for (int l = 0; l < map->tile_layer_count; l++) {
+        TileLayer *layer = &map->tile_layers[l];
+        if (!layer->visible || (!layer_has_cells(layer) && !layer->chunk_slots)) continue;
+        if (layer_drawn_on_gpu(map, layer) || overview_level(map, layer, camera) >= 0) continue;
+        // Hidden cells are left out of the bake; chunks with nothing left to
+        // draw are not baked (nor kept in use)
+        const uint8_t *hidden = layer_hidden(map, layer);
+        const uint8_t *hidden_chunks = hidden ? layer->hidden_chunks : NULL;
+        for (int by = by0; by <= by1; by++) {
+            for (int bx = bx0; bx <= bx1; bx++) {
+                if (hidden_chunks && hidden_chunks[by * map->bake_cols + bx]) continue;
+                BakedChunk *bc = baked_chunk(map, l, bx, by);
+                bc->last_used = map->bake_frame;
+                if ((!bc->baked || bc->dirty) && bakes < TILEMAP_BAKES_PER_FRAME) {
+                    if (bake_chunk(map, layer, hidden, bx, by, bc)) bakes++;
                 }
-            } else {
-                if (flipH) src.width = -src.width;
-                if (flipV) src.height = -src.height;
             }
+        }
+    }
+
+    // The budget may have been lowered since
+    while (map->bake_bytes > map->bake_budget) {
+        BakedChunk *oldest = oldest_baked(map);
+        if (!oldest) break;
+        evict_baked(map, oldest);
+    }
+}
+
+void tilemap_set_bake_budget(TileMap *map, size_t bytes) {
+    if (!map) return;
+    map->bake_budget = bytes;
+    // Turning baking off drops the cache so layers draw per tile again
+    if (bytes == 0) release_baked_chunks(map);
+}
+
+void tilemap_invalidate_rect(TileMap *map, int layer_index, int x, int y, int w, int h) {
+    if (!map || w <= 0 || h <= 0) return;
+    for (int l = 0; l < map->tile_layer_count; l++) {
+        if (layer_index >= 0 && l != layer_index) continue;
+        TileLayer *layer = &map->tile_layers[l];
+        int *rect = layer->gpu_dirty;
+        if (!layer->gpu_cells_dirty) {
+            rect[0] = x, rect[1] = y, rect[2] = x + w, rect[3] = y + h;
+        } else {
+            if (x < rect[0]) rect[0] = x;
+            if (y < rect[1]) rect[1] = y;
+            if (x + w > rect[2]) rect[2] = x + w;
+            if (y + h > rect[3]) rect[3] = y + h;
+        }
+        layer->gpu_cells_dirty = true;
+        layer->spans_dirty = true;
+
+        rect = layer->overview_rect;
+        if (!layer->overview_dirty) {
+            rect[0] = x, rect[1] = y, rect[2] = x + w, rect[3] = y + h;
+        } else {
+            if (x < rect[0]) rect[0] = x;
+            if (y < rect[1]) rect[1] = y;
+            if (x + w > rect[2]) rect[2] = x + w;
+            if (y + h > rect[3]) rect[3] = y + h;
+        }
+        layer->overview_dirty = true;
+    }
+    map->occlusion_dirty = true;
+    if (!map->baked) return;
+
+    int bx0, by0, bx1, by1;
+    bake_chunk_range(map, x, y, x + w, y + h, &bx0, &by0, &bx1, &by1);
+    for (int l = 0; l < map->tile_layer_count; l++) {
+        if (layer_index >= 0 && l != layer_index) continue;
+        for (int by = by0; by <= by1; by++) {
+            for (int bx = bx0; bx <= bx1; bx++) {
+                BakedChunk *bc = baked_chunk(map, l, bx, by);
+                if (bc->baked) bc->dirty = true;
+            }
+        }
+    }
+}
+
+// Give a flattened layer one more plane, for an edit that stacks a cell
+// deeper than any cell was at load. Data, sources, descriptors and the
+// hidden mask have room for plane_capacity planes; once that is used up they
+// move to arena arrays with twice the planes (the old ones stay in the arena
+// until unload), so repeated edits strand a bounded amount. The packed grid
+// of a compact layer and the GPU cell texture are redone every time.
+static bool add_plane(TileMap *map, TileLayer *layer) {
+    size_t cells = (size_t)layer->width * layer->height;
+    size_t old_count = cells * layer->planes, count = old_count + cells;
+    int capacity = layer->plane_capacity > layer->planes ? layer->plane_capacity : layer->planes;
+    if (layer->planes == capacity) {
+        capacity *= 2;
+        size_t room = cells * capacity;
+        uint32_t *data = (uint32_t *)arena_alloc_array(map->arena, room, sizeof(uint32_t));
+        uint8_t *sources = (uint8_t *)arena_alloc_array(map->arena, room, 1);
+        uint32_t *desc = layer->desc ? (uint32_t *)arena_alloc_array(map->arena, room, sizeof(uint32_t)) : NULL;
+        if (!data || !sources || (layer->desc && !desc)) return false;
+        memcpy(data, layer->data, old_count * sizeof(uint32_t));
+        memcpy(sources, layer->plane_sources, old_count);
+        if (desc) memcpy(desc, layer->desc, old_count * sizeof(uint32_t));
+        layer->data = data;
+        layer->plane_sources = sources;
+        layer->desc = desc;
+        layer->plane_capacity = capacity;
+        layer->hidden = NULL;
+    } else {
+        memset(layer->data + old_count, 0, cells * sizeof(uint32_t));
+        memset(layer->plane_sources + old_count, 0, cells);
+        if (layer->desc) memset(layer->desc + old_count, 0, cells * sizeof(uint32_t));
+    }
+    layer->planes++;
+    if (!layer->desc) {
+        tile_palette_free(&layer->packed);
+        if (!pack_descriptors(map, layer, (int)count)) {
+            layer->desc = (uint32_t *)arena_alloc_array(map->arena, cells * capacity, sizeof(uint32_t));
+            if (!layer->desc) return false;
+            fill_descriptors(map, layer->data, layer->desc, (int)count);
+        }
+    }
+
+    map->occlusion_dirty = true;
+    if (layer->gpu_cells.id != 0) UnloadTexture(layer->gpu_cells);
+    layer->gpu_cells.id = 0;
+    return true;
+}
+
+// Set plane p of the cell at (x, y) of a finite layer, descriptor included
+static bool write_plane(TileMap *map, TileLayer *layer, int x, int y, int p, uint32_t gid) {
+    size_t i = (size_t)p * layer->width * layer->height + (size_t)y * layer->width + x;
+    if (layer->data[i] == gid) return false;
+    layer->data[i] = gid;
+    if (layer->desc) {
+        fill_descriptors(map, &layer->data[i], &layer->desc[i], 1);
+    } else {
+        uint32_t packed;
+        fill_descriptors(map, &gid, &packed, 1);
+        tile_palette_set(&layer->packed, x, p * layer->height + y, packed);
+    }
+    return true;
+}
+
+// Replace merged layer `source`'s tile in a cell of a flattened layer. The
+// cell's tiles stay packed into the lowest planes in source order.
+static int write_source_tile(TileMap *map, TileLayer *layer, int source, int x, int y, uint32_t gid) {
+    size_t cells = (size_t)layer->width * layer->height, i = (size_t)y * layer->width + x;
+    uint32_t gids[257];
+    uint8_t sources[257];
+    int count = 0;
+    bool placed = gid == 0;
+    for (int p = 0; p < layer->planes; p++) {
+        uint32_t current = layer->data[p * cells + i];
+        int from = layer->plane_sources[p * cells + i];
+        if (!current || from == source) continue;
+        if (!placed && from > source) {
+            gids[count] = gid, sources[count++] = (uint8_t)source;
+            placed = true;
+        }
+        gids[count] = current, sources[count++] = (uint8_t)from;
+    }
+    if (!placed) gids[count] = gid, sources[count++] = (uint8_t)source;
+    if (count > layer->planes && !add_plane(map, layer)) return -1;
+
+    bool changed = false;
+    for (int p = 0; p < layer->planes; p++) {
+        changed |= write_plane(map, layer, x, y, p, p < count ? gids[p] : 0);
+        layer->plane_sources[p * cells + i] = p < count ? sources[p] : 0;
+    }
+    return changed;
+}
+
+// Write `gid` to the cell at (x, y) and refresh its descriptors. On a
+// flattened layer only merged layer `source`'s tile changes. Chunks of
+// infinite layers are decoded first (or allocated empty) and pinned, since
+// eviction would drop the edit. Returns -1 if the cell can't be edited,
+// else whether it changed.
+static int write_tile(TileMap *map, TileLayer *layer, int source, int x, int y, uint32_t gid) {
+    if (source < 0 || source >= (layer->source_count > 0 ? layer->source_count : 1)) return -1;
+    if (!layer->chunk_slots) {
+        if (!layer->data || !layer_has_cells(layer) || x < 0 || y < 0 || x >= layer->width || y >= layer->height) {
+            return -1;
+        }
+        if (layer->plane_sources) return write_source_tile(map, layer, source, x, y, gid);
+        return write_plane(map, layer, x, y, 0, gid);
+    }
+
+    TileChunk *chunk = find_chunk(map, layer, floor_div(x, map->chunk_width), floor_div(y, map->chunk_height));
+    if (!chunk) return -1;
+    if (!chunk->data && (chunk->source_length == 0 || !load_chunk(map, layer, chunk))) {
+        uint32_t *empty = (uint32_t *)calloc(1, chunk_resident_bytes(chunk));
+        if (!empty) return -1;
+        chunk->data = empty;
+        chunk->desc = empty + chunk->width * chunk->height;
+        map->chunk_bytes += chunk_resident_bytes(chunk);
+    }
+    chunk->edited = true;
+    size_t i = (size_t)(y - chunk->y) * chunk->width + (x - chunk->x);
+    if (chunk->data[i] == gid) return 0;
+    chunk->data[i] = gid;
+    fill_descriptors(map, &chunk->data[i], &chunk->desc[i], 1);
+    return 1;
+}
+
+static bool valid_gid(const TileMap *map, uint32_t gid) {
+    uint32_t id = gid & GID_MASK;
+    return id == 0 || (id < (uint32_t)map->tile_source_count && map->tile_sources[id].tileset >= 0);
+}
+
+int tilemap_find_tile_layer(const TileMap *map, const char *name, int *source) {
+    if (!map || !name) return -1;
+    for (int l = 0; l < map->tile_layer_count; l++) {
+        const TileLayer *layer = &map->tile_layers[l];
+        for (int k = 0; k < layer->source_count; k++) {
+            if (strcmp(layer->source_names[k], name) != 0) continue;
+            if (source) *source = k;
+            return l;
+        }
+        if (layer->source_count == 0 && strcmp(layer->name, name) == 0) {
+            if (source) *source = 0;
+            return l;
+        }
+    }
+    return -1;
+}
+
+bool tilemap_set_source_tile(TileMap *map, int layer_index, int source, int x, int y, uint32_t gid) {
+    if (!map || layer_index < 0 || layer_index >= map->tile_layer_count || !valid_gid(map, gid)) return false;
+    int changed = write_tile(map, &map->tile_layers[layer_index], source, x, y, gid);
+    if (changed > 0) tilemap_invalidate_rect(map, layer_index, x, y, 1, 1);
+    return changed >= 0;
+}
+
+int tilemap_fill_source_rect(TileMap *map, int layer_index, int source, int x, int y, int w, int h, uint32_t gid) {
+    if (!map || layer_index < 0 || layer_index >= map->tile_layer_count || !valid_gid(map, gid)) return 0;
+    TileLayer *layer = &map->tile_layers[layer_index];
+    int changed = 0;
+    for (int ty = y; ty < y + h; ty++) {
+        for (int tx = x; tx < x + w; tx++) {
+            if (write_tile(map, layer, source, tx, ty, gid) > 0) changed++;
+        }
+    }
+    if (changed > 0) tilemap_invalidate_rect(map, layer_index, x, y, w, h);
+    return changed;
+}
+
+bool tilemap_set_tile(TileMap *map, int layer_index, int x, int y, uint32_t gid) {
+    return tilemap_set_source_tile(map, layer_index, 0, x, y, gid);
+}
+
+int tilemap_fill_rect(TileMap *map, int layer_index, int x, int y, int w, int h, uint32_t gid) {
+    return tilemap_fill_source_rect(map, layer_index, 0, x, y, w, h, gid);
+}
+
+// Baked chunks are one quad each over their drawn tiles (premultiplied),
+// then their animated cells; regions not baked yet are drawn tile by tile.
+// Chunks whose every tile is hidden are skipped whole.
+static void draw_baked_layer(TileMap *map, int layer_index, int start_x, int start_y,
+                             int end_x, int end_y, Color tint) {
+    TileLayer *layer = &map->tile_layers[layer_index];
+    const uint8_t *hidden_chunks = layer_hidden(map, layer) ? layer->hidden_chunks : NULL;
+    int bx0, by0, bx1, by1;
+    bake_chunk_range(map, start_x, start_y, end_x, end_y, &bx0, &by0, &bx1, &by1);
+
+    Color premultiplied = {
+        (unsigned char)(tint.r * tint.a / 255), (unsigned char)(tint.g * tint.a / 255),
+        (unsigned char)(tint.b * tint.a / 255), tint.a
+    };
+    BeginBlendMode(BLEND_ALPHA_PREMULTIPLY);
+    for (int by = by0; by <= by1; by++) {
+        for (int bx = bx0; bx <= bx1; bx++) {
+            if (hidden_chunks && hidden_chunks[by * map->bake_cols + bx]) continue;
+            BakedChunk *bc = baked_chunk(map, layer_index, bx, by);
+            if (!bc->baked || bc->dirty || bc->target.id == 0) continue;
+            int x0, y0, w, h;
+            bake_chunk_rect(map, bx, by, &x0, &y0, &w, &h);
+            Texture2D texture = bc->target.texture;
+            // Only the tiles drawn into it; render textures are stored upside down
+            float px0 = (float)(bc->bounds[0] * map->tilewidth), py0 = (float)(bc->bounds[1] * map->tileheight);
+            float pw = (float)((bc->bounds[2] - bc->bounds[0]) * map->tilewidth);
+            float ph = (float)((bc->bounds[3] - bc->bounds[1]) * map->tileheight);
+            Rectangle src = { px0, (float)texture.height - py0 - ph, pw, -ph };
+            Rectangle dst = { (float)(x0 * map->tilewidth) + px0, (float)(y0 * map->tileheight) + py0, pw, ph };
+            DrawTexturePro(texture, src, dst, (Vector2){ 0, 0 }, 0.0f, premultiplied);
+        }
+    }
+    EndBlendMode();
 
-            DrawTexturePro(ts->texture, src, dst, (Vector2){0, 0}, rotation, tint);
+    for (int by = by0; by <= by1; by++) {
+        for (int bx = bx0; bx <= bx1; bx++) {
+            if (hidden_chunks && hidden_chunks[by * map->bake_cols + bx]) continue;
+            BakedChunk *bc = baked_chunk(map, layer_index, bx, by);
+            int x0, y0, w, h;
+            bake_chunk_rect(map, bx, by, &x0, &y0, &w, &h);
+            int rx0 = start_x > x0 ? start_x : x0;
+            int ry0 = start_y > y0 ? start_y : y0;
+            int rx1 = end_x < x0 + w ? end_x : x0 + w;
+            int ry1 = end_y < y0 + h ? end_y : y0 + h;
+
+            if (!bc->baked || bc->dirty) {
+                draw_layer_region(map, layer, rx0, ry0, rx1, ry1, tint);
+                continue;
+            }
+            for (int i = 0; i < bc->overlay_count; i++) {
+                const BakedCell *cell = &bc->overlay[i];
+                if (cell->x >= rx0 && cell->x < rx1 && cell->y >= ry0 && cell->y < ry1) {
+                    draw_cell(map, cell->desc, cell->x, cell->y, tint);
+                }
+            }
         }
     }
 }
 
+void tilemap_set_overview_threshold(TileMap *map, float px_per_tile) {
+    if (!map) return;
+    map->overview_px = px_per_tile;
+}
+
+// Re-render the invalidated rect of a layer's overview textures
+static void refresh_overview(TileMap *map, TileLayer *layer) {
+    if (!layer->overview_dirty) return;
+    layer->overview_dirty = false;
+    int *rect = layer->overview_rect;
+    int x0 = rect[0] > 0 ? rect[0] : 0, y0 = rect[1] > 0 ? rect[1] : 0;
+    int x1 = rect[2] < layer->width ? rect[2] : layer->width;
+    int y1 = rect[3] < layer->height ? rect[3] : layer->height;
+    if (x0 >= x1 || y0 >= y1) return;
+    for (int level = 0; level < TILEMAP_OVERVIEW_LEVELS; level++) {
+        if (layer->overview[level].id == 0) continue;
+        int scale = overview_scale[level];
+        unsigned char *pixels = (unsigned char *)malloc((size_t)(x1 - x0) * (y1 - y0) * scale * scale * 4);
+        if (!pixels) continue;
+        render_overview(map, layer, level, x0, y0, x1, y1, pixels);
+        Rectangle dst = { (float)(x0 * scale), (float)(y0 * scale), (float)((x1 - x0) * scale),
+                          (float)((y1 - y0) * scale) };
+        UpdateTextureRec(layer->overview[level], dst, pixels);
+        if (level == 1) GenTextureMipmaps(&layer->overview[level]);
+        free(pixels);
+    }
+}
+
+static void draw_overview_texture(Texture2D texture, Rectangle dst, Color tint) {
+    Color premultiplied = {
+        (unsigned char)(tint.r * tint.a / 255), (unsigned char)(tint.g * tint.a / 255),
+        (unsigned char)(tint.b * tint.a / 255), tint.a
+    };
+    Rectangle src = { 0, 0, (float)texture.width, (float)texture.height };
+    BeginBlendMode(BLEND_ALPHA_PREMULTIPLY);
+    DrawTexturePro(texture, src, dst, (Vector2){ 0, 0 }, 0.0f, premultiplied);
+    EndBlendMode();
+}
+
+void tilemap_draw_overview(TileMap *map, Rectangle dest, Color tint) {
+    if (!map || !map->loaded) return;
+    for (int l = 0; l < map->tile_layer_count; l++) {
+        TileLayer *layer = &map->tile_layers[l];
+        if (!layer->visible) continue;
+        int level = ensure_overview(map, layer, 1) ? 1 : 0;
+        if (level == 0 && !ensure_overview(map, layer, 0)) continue;
+        refresh_overview(map, layer);
+        Color layer_tint = tint;
+        layer_tint.a = (unsigned char)(tint.a * layer->opacity);
+        draw_overview_texture(layer->overview[level], dest, layer_tint);
+    }
+}
+
+void tilemap_draw_layer_tinted(TileMap *map, int layer_index, Camera2D camera, Color tint) {
+    if (!map || !map->loaded) return;
+    if (layer_index < 0 || layer_index >= map->tile_layer_count) return;
+
+    TileLayer *layer = &map->tile_layers[layer_index];
+    if (!layer->visible || (!layer_has_cells(layer) && !layer->chunk_slots)) return;
+
+    // Calculate visible tile range from camera
+    int start_x, start_y, end_x, end_y;
+    visible_tile_range(map, camera, &start_x, &start_y, &end_x, &end_y);
+
+    // Merge caller's tint alpha with layer opacity
+    tint.a = (unsigned char)(tint.a * layer->opacity);
+
+    int level = overview_level(map, layer, camera);
+    if (level >= 0) {
+        refresh_overview(map, layer);
+        Rectangle dst = { 0, 0, (float)(layer->width * map->tilewidth), (float)(layer->height * map->tileheight) };
+        draw_overview_texture(layer->overview[level], dst, tint);
+        return;
+    }
+    if (draw_gpu_layer(map, layer, start_x, start_y, end_x, end_y, tint)) {
+        return;
+    }
+    if (map->baked) {
+        draw_baked_layer(map, layer_index, start_x, start_y, end_x, end_y, tint);
+    } else {
+        draw_layer_region(map, layer, start_x, start_y, end_x, end_y, tint);
+    }
+}
+
 void tilemap_draw_layer(TileMap *map, int layer_index, Camera2D camera) {
     tilemap_draw_layer_tinted(map, layer_index, camera, WHITE);
 }
@@ -605,16 +3917,380 @@ void tilemap_draw_all(TileMap *map, Camera2D camera) {
     }
 }
 
+// Layer index for lookups: -1 (every layer) for NULL, -2 if there is no
+// such layer
+static int object_layer_key(const TileMap *map, const char *layer_name) {
+    if (!layer_name) return -1;
+    int id = tilemap_string_id(map, layer_name);
+    for (int l = 0; id >= 0 && l < map->object_layer_count; l++) {
+        if (map->object_layers[l].name_id == id) return l;
+    }
+    return -2;
+}
+
+static const ObjectKeyRange *lookup_objects(TileMap *map, int kind, const char *layer_name, const char *key) {
+    if (!map || !key) return NULL;
+    int layer = object_layer_key(map, layer_name);
+    if (layer == -2) return NULL;
+    return find_object_key(map, kind, layer, tilemap_string_id(map, key));
+}
+
 MapObject *tilemap_find_object(TileMap *map, const char *layer_name, const char *type) {
-    if (!map) return NULL;
-    for (int i = 0; i < map->object_layer_count; i++) {
-        if (strcmp(map->object_layers[i].name, layer_name) != 0) continue;
-        ObjectLayer *layer = &map->object_layers[i];
-        for (int j = 0; j < layer->object_count; j++) {
-            if (strcmp(layer->objects[j].type, type) == 0) {
-                return &layer->objects[j];
+    const ObjectKeyRange *range = lookup_objects(map, OBJECT_KEY_TYPE, layer_name, type);
+    return range ? map->object_refs[range->start] : NULL;
+}
+
+MapObject *tilemap_find_object_by_name(TileMap *map, const char *layer_name, const char *name) {
+    const ObjectKeyRange *range = lookup_objects(map, OBJECT_KEY_NAME, layer_name, name);
+    return range ? map->object_refs[range->start] : NULL;
+}
+
+MapObject *const *tilemap_objects_of_type(TileMap *map, const char *layer_name, const char *type, int *count) {
+    const ObjectKeyRange *range = lookup_objects(map, OBJECT_KEY_TYPE, layer_name, type);
+    if (count) *count = range ? range->count : 0;
+    return range ? &map->object_refs[range->start] : NULL;
+}
+
+ObjectLayer *tilemap_find_object_layer(TileMap *map, const char *name) {
+    if (!map || !name) return NULL;
+    int layer = object_layer_key(map, name);
+    return layer >= 0 ? &map->object_layers[layer] : NULL;
+}
+
+// An object spanning several cells is reported once: from the cell holding
+// the top-left corner of its overlap with the query
+static int query_layer_objects(const TileMap *map, const ObjectLayer *layer, Rectangle rect,
+                               MapObject **out, int capacity, int found) {
+    if (!layer->grid_start) return found;
+    float ox, oy, cw, ch;
+    object_grid_origin(map, &ox, &oy, &cw, &ch);
+    int cols = layer->grid_cols, rows = layer->grid_rows;
+    int x0 = object_cell(rect.x, ox, cw, cols), x1 = object_cell(rect.x + rect.width, ox, cw, cols);
+    int y0 = object_cell(rect.y, oy, ch, rows), y1 = object_cell(rect.y + rect.height, oy, ch, rows);
+    for (int y = y0; y <= y1; y++) {
+        for (int x = x0; x <= x1; x++) {
+            int cell = y * cols + x;
+            for (int i = layer->grid_start[cell]; i < layer->grid_start[cell + 1]; i++) {
+                MapObject *obj = &layer->objects[layer->grid_objects[i]];
+                Rectangle b = obj->bounds;
+                if (b.x > rect.x + rect.width || b.x + b.width < rect.x ||
+                    b.y > rect.y + rect.height || b.y + b.height < rect.y) continue;
+                if (object_cell(fmaxf(b.x, rect.x), ox, cw, cols) != x ||
+                    object_cell(fmaxf(b.y, rect.y), oy, ch, rows) != y) continue;
+                if (found < capacity) out[found] = obj;
+                found++;
             }
         }
     }
-    return NULL;
+    return found;
+}
+
+int tilemap_query_objects_in_rect(TileMap *map, const char *layer_name, Rectangle rect,
+                                  MapObject **out, int capacity) {
+    if (!map) return 0;
+    if (!out) capacity = 0;
+    int layer = object_layer_key(map, layer_name);
+    if (layer == -2) return 0;
+    if (layer >= 0) return query_layer_objects(map, &map->object_layers[layer], rect, out, capacity, 0);
+    int found = 0;
+    for (int l = 0; l < map->object_layer_count; l++) {
+        found = query_layer_objects(map, &map->object_layers[l], rect, out, capacity, found);
+    }
+    return found;
+}
+
+// Hot reload: the reloaded map replaces the live one, taking over what the
+// live map built at runtime wherever the data it came from is unchanged
+
+struct TileMapWatch {
+    char path[512];
+    PlatformWatch *files;
+    TileMapLoad *load;        // reload in progress
+    double changed_at;        // last change not yet reloaded, < 0 if none
+};
+
+static bool same_string(const TileMap *a, int a_id, const TileMap *b, int b_id) {
+    return strcmp(tilemap_string(a, a_id), tilemap_string(b, b_id)) == 0;
+}
+
+// Same size and the same tile layers (by name, size and planes), so cached
+// per-layer state and bake chunks line up
+static bool same_layout(const TileMap *a, const TileMap *b) {
+    if (a->width != b->width || a->height != b->height || a->tilewidth != b->tilewidth ||
+        a->tileheight != b->tileheight || a->infinite != b->infinite || a->startx != b->startx ||
+        a->starty != b->starty || a->tile_layer_count != b->tile_layer_count) {
+        return false;
+    }
+    for (int l = 0; l < a->tile_layer_count; l++) {
+        const TileLayer *la = &a->tile_layers[l], *lb = &b->tile_layers[l];
+        if (strcmp(la->name, lb->name) != 0 || la->width != lb->width || la->height != lb->height ||
+            la->planes != lb->planes || !la->chunk_slots != !lb->chunk_slots) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool same_anims(const TilesetInfo *a, const TilesetInfo *b) {
+    if (!a->anim_lookup || !b->anim_lookup) return !a->anim_lookup == !b->anim_lookup;
+    for (int id = 0; id < a->tilecount; id++) {
+        const TileAnim *x = &a->anim_lookup[id], *y = &b->anim_lookup[id];
+        if (x->frame_count != y->frame_count || x->total_duration != y->total_duration) return false;
+        if (x->frame_count > 0 && memcmp(x->frames, y->frames, x->frame_count * sizeof(TileAnimFrame)) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool same_tilesets(const TileMap *a, const TileMap *b) {
+    if (a->tileset_count != b->tileset_count) return false;
+    for (int t = 0; t < a->tileset_count; t++) {
+        const TilesetInfo *x = &a->tilesets[t], *y = &b->tilesets[t];
+        if (x->firstgid != y->firstgid || x->tilewidth != y->tilewidth || x->tileheight != y->tileheight ||
+            x->columns != y->columns || x->tilecount != y->tilecount || x->margin != y->margin ||
+            x->spacing != y->spacing || x->imagewidth != y->imagewidth || x->imageheight != y->imageheight ||
+            strcmp(x->image_path, y->image_path) != 0 || !same_anims(x, y)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool same_layer_properties(const TileMap *a, const TileLayer *la, const TileMap *b, const TileLayer *lb) {
+    return la->visible == lb->visible && la->opacity == lb->opacity && la->elevation == lb->elevation &&
+           same_string(a, la->render_layer, b, lb->render_layer) && same_string(a, la->shader, b, lb->shader);
+}
+
+static bool same_objects(const TileMap *a, const TileMap *b) {
+    if (a->object_layer_count != b->object_layer_count) return false;
+    for (int l = 0; l < a->object_layer_count; l++) {
+        const ObjectLayer *la = &a->object_layers[l], *lb = &b->object_layers[l];
+        if (strcmp(la->name, lb->name) != 0 || la->visible != lb->visible || la->object_count != lb->object_count) {
+            return false;
+        }
+        for (int i = 0; i < la->object_count; i++) {
+            const MapObject *x = &la->objects[i], *y = &lb->objects[i];
+            if (x->id != y->id || x->x != y->x || x->y != y->y || x->width != y->width ||
+                x->height != y->height || x->rotation != y->rotation || x->visible != y->visible ||
+                x->elevation != y->elevation || x->from_elevation != y->from_elevation ||
+                x->to_elevation != y->to_elevation || !same_string(a, x->name_id, b, y->name_id) ||
+                !same_string(a, x->type_id, b, y->type_id)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Invalidate the tiles of a finite layer whose GIDs differ between the two
+// maps, one row run at a time so scattered edits don't dirty everything
+// between them. Returns the number of changed tiles.
+static int invalidate_changed_tiles(TileMap *fresh, int layer_index, const TileLayer *old) {
+    const TileLayer *layer = &fresh->tile_layers[layer_index];
+    if (!layer->data || !old->data) return 0;
+    int changed = 0;
+    size_t plane_cells = (size_t)layer->width * layer->height;
+    for (int y = 0; y < layer->height; y++) {
+        int x0 = layer->width, x1 = 0;
+        for (int p = 0; p < layer->planes; p++) {
+            size_t row = p * plane_cells + (size_t)y * layer->width;
+            if (memcmp(layer->data + row, old->data + row, layer->width * sizeof(uint32_t)) == 0) continue;
+            for (int x = 0; x < layer->width; x++) {
+                if (layer->data[row + x] == old->data[row + x]) continue;
+                changed++;
+                if (x < x0) x0 = x;
+                if (x + 1 > x1) x1 = x + 1;
+            }
+        }
+        if (x0 < x1) tilemap_invalidate_rect(fresh, layer_index, x0, y, x1 - x0, 1);
+    }
+    return changed;
+}
+
+// Infinite layers: a chunk changed if its data text in the file did, or it
+// was edited at runtime. Returns the number of tiles in changed chunks.
+static int invalidate_changed_chunks(TileMap *fresh, int layer_index, const TileMap *old_map, const TileLayer *old) {
+    const TileLayer *layer = &fresh->tile_layers[layer_index];
+    if (layer->chunk_count != old->chunk_count) {
+        tilemap_invalidate_rect(fresh, layer_index, fresh->startx, fresh->starty, fresh->width, fresh->height);
+        return fresh->width * fresh->height;
+    }
+    int changed = 0;
+    for (int c = 0; c < layer->chunk_count; c++) {
+        const TileChunk *a = &layer->chunks[c], *b = &old->chunks[c];
+        bool same = a->x == b->x && a->y == b->y && a->width == b->width && a->height == b->height &&
+                    !b->edited && a->source_length == b->source_length &&
+                    memcmp((const char *)fresh->source.data + a->source_offset,
+                           (const char *)old_map->source.data + b->source_offset, a->source_length) == 0;
+        if (same) continue;
+        tilemap_invalidate_rect(fresh, layer_index, a->x, a->y, a->width, a->height);
+        tilemap_invalidate_rect(fresh, layer_index, b->x, b->y, b->width, b->height);
+        changed += a->width * a->height;
+    }
+    return changed;
+}
+
+// Move the live map's settings and runtime caches to the reloaded map, then
+// invalidate what was built from changed tiles
+static void apply_reload(TileMap *old, TileMap *fresh, TileMapReload *changes) {
+    bool layout = same_layout(old, fresh);
+    bool tilesets = same_tilesets(old, fresh);
+    if (!layout) changes->flags |= TILEMAP_RELOAD_LAYOUT;
+    if (!tilesets) changes->flags |= TILEMAP_RELOAD_TILESETS;
+    if (!same_objects(old, fresh)) changes->flags |= TILEMAP_RELOAD_OBJECTS;
+
+    fresh->anim_time = old->anim_time;
+    advance_animations(fresh);
+    fresh->chunk_budget = old->chunk_budget;
+    fresh->bake_budget = old->bake_budget;
+    fresh->batching = old->batching;
+    fresh->overview_px = old->overview_px;
+    fresh->occlusion = old->occlusion;
+    if (!layout) {
+        changes->changed_layers = fresh->tile_layer_count;
+        return;
+    }
+
+    // Batches and the GPU tables hold per-tileset and per-GID state
+    if (tilesets) {
+        fresh->batches = old->batches;
+        fresh->batch_meshes = old->batch_meshes;
+        fresh->batch_material = old->batch_material;
+        old->batches = NULL;
+        old->batch_meshes = NULL;
+        old->batch_material.maps = NULL;
+        fresh->gpu = old->gpu;
+        old->gpu = NULL;
+        // Slot numbering matches, but re-upload the current frames anyway
+        if (fresh->gpu) fresh->gpu->anim_version = fresh->anim_version - 1;
+    }
+    fresh->baked = old->baked;
+    fresh->bake_cols = old->bake_cols;
+    fresh->bake_rows = old->bake_rows;
+    fresh->bake_bytes = old->bake_bytes;
+    fresh->bake_frame = old->bake_frame;
+    old->baked = NULL;
+
+    for (int l = 0; l < fresh->tile_layer_count; l++) {
+        TileLayer *layer = &fresh->tile_layers[l];
+        TileLayer *old_layer = &old->tile_layers[l];
+        layer->renderer = old_layer->renderer;
+        layer->draw_pass = old_layer->draw_pass;
+        layer->occluder = old_layer->occluder;
+        if (tilesets) {
+            layer->gpu_cells = old_layer->gpu_cells;
+            layer->gpu_tilesets = old_layer->gpu_tilesets;
+            old_layer->gpu_cells.id = 0;
+        }
+        // With the old hidden mask, the next occlusion rebuild rebakes only
+        // the chunks whose hidden cells changed
+        if (fresh->baked && old_layer->hidden && old_layer->hidden_chunks) {
+            size_t mask_bytes = ((size_t)layer->width * layer->height * layer->planes + 7) / 8;
+            size_t chunk_bytes = (size_t)fresh->bake_cols * fresh->bake_rows;
+            layer->hidden = (uint8_t *)arena_alloc(fresh->arena, mask_bytes);
+            layer->hidden_chunks = (uint8_t *)arena_alloc(fresh->arena, chunk_bytes);
+            if (layer->hidden && layer->hidden_chunks) {
+                memcpy(layer->hidden, old_layer->hidden, mask_bytes);
+                memcpy(layer->hidden_chunks, old_layer->hidden_chunks, chunk_bytes);
+            } else {
+                layer->hidden = NULL;
+                layer->hidden_chunks = NULL;
+            }
+        }
+
+        bool properties = !same_layer_properties(old, old_layer, fresh, layer);
+        int cells;
+        if (!tilesets) {
+            // Animated tiles may have become static or the other way round,
+            // which changes what the baked chunks hold
+            tilemap_invalidate_rect(fresh, l, fresh->startx, fresh->starty, fresh->width, fresh->height);
+            cells = 0;
+        } else if (layer->chunk_slots) {
+            cells = invalidate_changed_chunks(fresh, l, old, old_layer);
+        } else {
+            cells = invalidate_changed_tiles(fresh, l, old_layer);
+        }
+        // Spans were just built from the new tiles; overviews will be
+        // rendered from them on first use
+        layer->spans_dirty = false;
+        layer->overview_dirty = false;
+
+        if (properties) changes->flags |= TILEMAP_RELOAD_LAYERS;
+        if (cells > 0) changes->flags |= TILEMAP_RELOAD_TILES;
+        if (properties || cells > 0) changes->changed_layers++;
+        changes->changed_cells += cells;
+    }
+}
+
+// The map file and every external tileset it uses
+static void watch_map_files(TileMapWatch *watch, const TileMap *map) {
+    platform_watch_clear(watch->files);
+    platform_watch_add(watch->files, watch->path);
+    for (int t = 0; map && t < map->tileset_count; t++) {
+        const char *source = map->tilesets[t].source_path;
+        bool seen = false;
+        for (int u = 0; u < t; u++) seen |= strcmp(map->tilesets[u].source_path, source) == 0;
+        if (source[0] && !seen) platform_watch_add(watch->files, source);
+    }
+}
+
+TileMapWatch *tilemap_watch(const TileMap *map, const char *path) {
+    if (!map || !path) return NULL;
+    TileMapWatch *watch = (TileMapWatch *)calloc(1, sizeof(TileMapWatch));
+    if (!watch) return NULL;
+    watch->files = platform_watch_create();
+    if (!watch->files) {
+        printf("[tilemap] WARNING: Could not watch %s for changes\n", path);
+        free(watch);
+        return NULL;
+    }
+    strncpy_safe(watch->path, path, sizeof(watch->path));
+    watch->changed_at = -1.0;
+    watch_map_files(watch, map);
+    return watch;
+}
+
+bool tilemap_watch_poll(TileMapWatch *watch, TileMap **map, TileMapReload *changes) {
+    if (!watch || !map || !*map) return false;
+    double now = platform_time_seconds();
+    if (platform_watch_changed(watch->files)) watch->changed_at = now;
+
+    if (!watch->load) {
+        if (watch->changed_at < 0.0 || (now - watch->changed_at) * 1000.0 < TILEMAP_RELOAD_SETTLE_MS) return false;
+        watch->changed_at = -1.0;
+        TILEMAP_LOG("[tilemap] %s changed, reloading\n", watch->path);
+        watch->load = tilemap_load_async(watch->path);
+        return false;
+    }
+    if (!tilemap_load_poll(watch->load)) return false;
+    TileMap *fresh = tilemap_load_finish(watch->load);
+    watch->load = NULL;
+    if (!fresh || !fresh->loaded) {
+        printf("[tilemap] WARNING: Reloading %s failed, keeping the loaded map\n", watch->path);
+        tilemap_unload(fresh);
+        return false;
+    }
+
+    double start = platform_time_seconds();
+    TileMapReload result = { 0 };
+    apply_reload(*map, fresh, &result);
+    tilemap_unload(*map);
+    *map = fresh;
+    watch_map_files(watch, fresh);
+    result.apply_ms = (platform_time_seconds() - start) * 1000.0;
+    TILEMAP_LOG("[tilemap] Reloaded %s in %.2f ms: %d tiles in %d layers changed%s%s%s\n", watch->path,
+                result.apply_ms, result.changed_cells, result.changed_layers,
+                result.flags & TILEMAP_RELOAD_OBJECTS ? ", objects" : "",
+                result.flags & TILEMAP_RELOAD_TILESETS ? ", tilesets" : "",
+                result.flags & TILEMAP_RELOAD_LAYOUT ? ", layout (nothing carried over)" : "");
+    if (changes) *changes = result;
+    return true;
+}
+
+void tilemap_watch_stop(TileMapWatch *watch) {
+    if (!watch) return;
+    if (watch->load) tilemap_load_cancel(watch->load);
+    platform_watch_destroy(watch->files);
+    free(watch);
 }
@@ -2,6 +2,9 @@
 #define TILEMAP_H
 
 #include "raylib.h"
+#include "platform.h"
+#include "tile_batch.h"
+#include "tile_palette.h"
 #include <stdint.h>
 #include <stdbool.h>
 
@@ -10,6 +13,46 @@
 #define FLIPPED_D_FLAG  0x20000000u
 #define GID_MASK        0x0FFFFFFFu
 
+// Draw descriptor of a cell, resolved from its GID at load: the flip flags
+// stay in the top three bits (orientation = desc >> 29) and the low bits
+// index TileMap.tile_sources, or TileMap.anim_current if bit 28 marks an
+// animated tile. 0 = nothing to draw (empty cell, or a GID no tileset covers).
+#define TILE_DESC_ANIMATED    0x10000000u
+#define TILE_DESC_SOURCE_MASK 0x0FFFFFFFu
+#define TILE_DESC_ORIENT_SHIFT 29
+
+// Decoded chunk data an infinite map keeps resident by default
+#define TILEMAP_CHUNK_BUDGET_DEFAULT (4 * 1024 * 1024)
+// Baked layer cache: the static tiles of each TILEMAP_BAKE_CHUNK-square
+// region of a layer are rendered once into a render texture
+#define TILEMAP_BAKE_CHUNK 32
+#define TILEMAP_BAKE_BUDGET_DEFAULT (64 * 1024 * 1024)
+// Bakes per tilemap_bake_chunks() call, so scrolling never stalls a frame
+#define TILEMAP_BAKES_PER_FRAME 8
+
+// Overview textures: each finite layer can also be drawn from textures at 4
+// and 1 pixels per tile, rendered the first time they are needed. Layers draw from them while a tile covers at most
+// TILEMAP_OVERVIEW_PX_DEFAULT screen pixels (see tilemap_set_overview_threshold()).
+#define TILEMAP_OVERVIEW_LEVELS 2
+#define TILEMAP_OVERVIEW_PX_DEFAULT 4.0f
+// Levels larger than this (in pixels, either side) are not built
+#define TILEMAP_OVERVIEW_MAX_SIZE 4096
+
+// Hot reload: quiet time after a watched file changes before reparsing, so a
+// save written in several steps is read once
+#define TILEMAP_RELOAD_SETTLE_MS 100
+
+// Load thread setting (the default) for one thread per online core when
+// parsing tilesets/layers and decoding tileset images
+#define TILEMAP_LOAD_THREADS_AUTO 0
+
+// Coverage of a tile's pixels, classified from the tileset image at load
+typedef enum TileAlpha {
+    TILE_ALPHA_PARTIAL,       // some translucent pixels (or not classified)
+    TILE_ALPHA_EMPTY,         // every pixel fully transparent
+    TILE_ALPHA_OPAQUE,        // every pixel fully opaque
+} TileAlpha;
+
 typedef struct TileAnimFrame {
     int tileid;       // local tile ID to display
     int duration;     // milliseconds
@@ -31,43 +74,220 @@ typedef struct TilesetInfo {
     int spacing;
     int imagewidth;
     int imageheight;
+    char image_path[512];     // resolved tileset image path
+    char source_path[512];    // external .tsj this tileset came from ("" if embedded)
     Texture2D texture;
     TileAnim *anim_lookup;   // array of size tilecount, indexed by local tile ID
                               // .frame_count == 0 means not animated
+    uint8_t *tile_alpha;      // TileAlpha per local tile ID; NULL if the image
+                              // could not be classified
 } TilesetInfo;
 
+// One chunk of an infinite map layer. GIDs are decoded from the map file when
+// the chunk comes near the camera and dropped again under memory pressure.
+typedef struct TileChunk {
+    int x, y;                 // top-left tile (may be negative)
+    int width, height;
+    size_t source_offset;     // "data" value inside TileMap.source
+    size_t source_length;     // 0 if the chunk has no usable data
+    uint32_t *data;           // NULL while not resident
+    uint32_t *desc;           // draw descriptors, resident along with data
+    uint32_t last_used;       // TileMap.chunk_frame when last near the camera
+    bool edited;              // changed by tilemap_set_tile(); never evicted
+} TileChunk;
+
+// How a tile layer is drawn
+typedef enum TileLayerRenderer {
+    TILE_RENDER_TILES,        // per tile, batched or baked (default)
+    TILE_RENDER_GPU,          // one quad per tileset; a shader looks up each
+                              // cell in a texture of the layer's descriptors
+} TileLayerRenderer;
+
+// Run [x0, x1) of occupied cells in one row of a layer
+typedef struct TileSpan {
+    int x0, x1;
+} TileSpan;
+
 typedef struct TileLayer {
     char name[64];
     int width;
     int height;
+    int planes;             // width x height planes in data/desc; flattened
+                            // layers stack the tiles of merged layers (bottom
+                            // first), so a cell may have several
+    int plane_capacity;     // planes data/plane_sources/desc and the hidden
+                            // mask have room for (0 = planes)
     uint32_t *data;
+    uint8_t *plane_sources; // flattened layers: which merged layer each
+                            // plane's tile came from (NULL otherwise)
+    char (*source_names)[64];  // names of the merged layers, bottom first
+    int source_count;       // 0 unless flattened
+    uint32_t *desc;         // draw descriptor per cell (see TILE_DESC_*)
+    TilePaletteGrid packed; // compact layers: the descriptors, packed (desc
+                            // is NULL), planes stacked as in desc
     bool visible;
     float opacity;
-    char render_layer[32];
+    int render_layer;       // Tiled custom property "render_layer", interned
     int elevation;
-    char shader_name[32];   // Tiled custom property "shader" (e.g., "water")
+    int shader;             // "shader" (e.g., "water"), interned; 0 = not set
+
+    // Finite layers: runs of occupied cells (a tile in any plane) per row,
+    // so drawing visits only those. Row y's runs are
+    // spans[span_rows[y]] .. spans[span_rows[y + 1] - 1]. Rebuilt on the next
+    // draw after tilemap_invalidate_rect(), in place while they fit.
+    TileSpan *spans;
+    int *span_rows;
+    int span_count;
+    int span_capacity;
+    int occupied_cells;
+    int occupied[4];        // bounds of the occupied cells (x0, y0, x1, y1)
+    bool spans_dirty;
+    bool planes_cross_tilesets;  // some cell has a higher plane's tile in an
+                                 // earlier tileset (batches draw per plane)
+
+    // Infinite maps: data is NULL and the tiles live in chunks, found through
+    // an open-addressed table keyed by chunk grid position
+    TileChunk *chunks;
+    int chunk_count;
+    int *chunk_slots;       // chunk index + 1, 0 = empty
+    int chunk_slot_mask;
+    bool chunk_base64;      // chunk "data" is a base64 string, not a number array
+    char chunk_compression[8];
+
+    // TILE_RENDER_GPU: one texel per cell (source or animation slot index,
+    // flip bits), created on first draw and re-uploaded once invalidated
+    TileLayerRenderer renderer;
+    Texture2D gpu_cells;
+    bool gpu_cells_dirty;
+    int gpu_dirty[4];         // invalidated tile rect (x0, y0, x1, y1)
+    uint64_t gpu_tilesets;    // bit per tileset the layer's cells use
+
+    // Occlusion (finite layers, see tilemap_set_layer_pass()): layers draw
+    // in (draw_pass, index) order, and a cell hidden under an opaque tile of
+    // a later occluder layer, or holding an empty tile, is skipped
+    int draw_pass;
+    bool occluder;            // drawn untinted; its opaque tiles hide cells below
+    bool occluding;           // whether it occluded when the masks were built
+    uint8_t *hidden;          // bit per cell and plane, same order as desc
+    uint8_t *hidden_chunks;   // per bake chunk: every cell hidden or empty
+
+    // Overview levels (4 and 1 pixels per tile, premultiplied): rendered on
+    // the main thread by the first draw that needs them (the 1-pixel level
+    // with mipmaps). Invalidated tiles are re-rendered before the next
+    // overview draw.
+    Texture2D overview[TILEMAP_OVERVIEW_LEVELS];
+    bool overview_tried[TILEMAP_OVERVIEW_LEVELS]; // built, or skipped for size
+    bool overview_dirty;
+    int overview_rect[4];     // invalidated tile rect (x0, y0, x1, y1)
 } TileLayer;
 
+// Cell of a baked chunk drawn over the baked texture every frame: an
+// animated tile, or a tile stacked above one in a flattened layer
+typedef struct BakedCell {
+    int x, y;                 // map tile position
+    uint32_t desc;
+} BakedCell;
+
+typedef struct BakedChunk {
+    RenderTexture2D target;   // premultiplied alpha; id 0 if no static tiles
+    bool baked;               // target and overlay match the layer's tiles
+    bool dirty;               // invalidated, or its hidden cells changed, since
+                              // it was baked
+    int bounds[4];            // tiles drawn into target, relative to the chunk
+                              // (x0, y0, x1, y1); only this part is drawn
+    uint32_t last_used;       // TileMap.bake_frame when last in view
+    BakedCell *overlay;
+    int overlay_count;
+} BakedChunk;
+
+// Where a tile is drawn from: one entry per GID, built at load
+typedef struct TileSource {
+    Rectangle src;            // source rect in the tileset texture
+    float uv[4];              // src normalized to the image (u0, v0, u1, v1)
+    int tileset;              // index into TileMap.tilesets
+    const TileAnim *anim;     // non-NULL for animated tiles
+    int anim_slot;            // index into TileMap.anim_gids/anim_current
+    uint8_t alpha;            // TileAlpha; animated tiles combine every frame,
+                              // and tiles larger than a map cell never count
+                              // as opaque
+} TileSource;
+
 typedef struct MapObject {
     int id;
-    char name[64];
-    char type[64];
+    int name_id;              // name and type ("class"), as TileMap.strings
+    int type_id;              // ids (see tilemap_string())
     double x, y;
     double width, height;
     double rotation;
+    Rectangle bounds;         // axis-aligned bounds, rotation applied
     bool visible;
     int elevation;
     int from_elevation;
     int to_elevation;
 } MapObject;
 
+// Object grid cell size, in tiles
+#define TILEMAP_OBJECT_CELL 8
+
 typedef struct ObjectLayer {
     char name[64];
+    int name_id;
     MapObject *objects;
     int object_count;
     bool visible;
+
+    // Uniform grid over the map (TILEMAP_OBJECT_CELL tiles per cell): the
+    // objects of cell c are grid_objects[grid_start[c] .. grid_start[c + 1]).
+    // Objects are listed in every cell their bounds touch; objects outside
+    // the map go to the edge cells.
+    int grid_cols, grid_rows;
+    int *grid_start;
+    int *grid_objects;        // indices into objects
 } ObjectLayer;
 
+// Per-map string interning: equal strings share an id (0 is ""), so keys
+// compare as ints
+typedef struct StringTable {
+    const char **strings;     // id -> string
+    int count, capacity;
+    int *slots;               // open-addressed by hash, id + 1 (0 = empty)
+    int slot_mask;
+} StringTable;
+
+// Objects sharing a type or a name within one object layer (layer -1: any
+// layer), as a span of TileMap.object_refs in map order
+typedef struct ObjectKeyRange {
+    int kind;                 // 0 = type, 1 = name
+    int layer;
+    int key;                  // string id
+    int start, count;
+} ObjectKeyRange;
+
+// Where a load spent its time, in milliseconds. Phases marked (sum) run on
+// the load task pool and add up the time of every task, so they can exceed
+// parallel_ms, the wall time of that section.
+typedef struct TileMapLoadStats {
+    bool cooked;              // loaded from a .tmb
+    int threads;              // load threads in use
+    double read_ms;           // map the file (cooked: also validate + build tables)
+    double fix_ms;            // json_fix_backslashes() over the JSON text
+    double stream_ms;         // top-level streaming parse (layer data only located)
+    double tilesets_ms;       // (sum) tileset parse, including external .tsj files
+    double layers_ms;         // (sum) tile layer GID decode
+    double objects_ms;        // (sum) object layer parse
+    double desc_ms;           // tile sources + per-cell draw descriptors
+    double index_ms;          // interned keys, object index and grids
+    double images_ms;         // (sum) tileset image decode
+    double parallel_ms;       // wall time of the task pool section
+    double analyze_ms;        // tile opacity and colors from the tileset images
+    double spans_ms;          // row span index of the finite layers
+    double upload_ms;         // tileset texture upload (main thread)
+    double total_ms;          // everything above, minus any wait for the main
+                              // thread to poll an async load
+    size_t arena_bytes;       // map memory handed out by the arena
+    int arena_blocks;
+} TileMapLoadStats;
+
 typedef struct TileMap {
     int width;
     int height;
@@ -80,19 +300,255 @@ typedef struct TileMap {
     TileLayer *tile_layers;
     int tile_layer_count;
 
+    TileSource *tile_sources; // indexed by GID (0 unused)
+    int tile_source_count;
+
+    // Animated tiles only: the GID of each and the GID of its current frame,
+    // advanced once per tilemap_update() rather than per drawn cell
+    uint32_t *anim_gids;
+    uint32_t *anim_current;
+    int anim_count;
+    uint32_t anim_version;    // bumped whenever an anim_current entry changes
+    uint32_t *desc_run;       // compact layers: scratch row for decoded runs
+    // Per tile source: its tile box-filtered to 4x4 premultiplied RGBA
+    // texels, and the average of those, sampled at load for the overview
+    // textures
+    unsigned char *tile_colors;
+    unsigned char *tile_average;
+    float overview_px;        // see tilemap_set_overview_threshold()
+
     ObjectLayer *object_layers;
     int object_layer_count;
 
+    // Object index built at load (see tilemap_objects_of_type()): hashed
+    // (kind, layer, key) ranges over object_refs
+    StringTable strings;
+    ObjectKeyRange *object_keys;
+    int object_key_mask;
+    MapObject **object_refs;
+
     bool loaded;
     double anim_time;         // global animation clock in milliseconds
+
+    // Every table above (and the TileMap itself) is allocated from this
+    // arena, so unloading is a single arena_destroy()
+    struct Arena *arena;
+
+    TileMapLoadStats load_stats;
+
+    MappedFile cooked;        // backing .tmb mapping (layer data and anim frames
+                              // point into it); zeroed for maps parsed from JSON
+
+    // Infinite maps (Tiled "infinite": true). width/height then cover the
+    // bounds of all chunks, starting at tile startx/starty.
+    bool infinite;
+    int startx, starty;
+    int chunk_width, chunk_height;
+    MappedFile source;        // .tmj mapping chunk data is decoded from
+    size_t chunk_budget;      // bytes of decoded chunk data to keep resident
+    size_t chunk_bytes;       // bytes currently resident
+    uint32_t chunk_frame;     // bumped by every tilemap_stream_chunks()
+
+    // Baked layer cache (see tilemap_bake_chunks()): bake_cols x bake_rows
+    // chunks per tile layer, covering the map from startx/starty
+    BakedChunk *baked;
+    int bake_cols, bake_rows;
+    size_t bake_budget;       // bytes of render textures to keep (0 = off)
+    size_t bake_bytes;
+    uint32_t bake_frame;
+
+    // Quad batches (see tilemap_build_layer_batch()): one per tileset, each
+    // uploaded to a dynamic mesh and drawn with a single DrawMesh()
+    bool batching;
+    TileBatch *batches;
+    Mesh *batch_meshes;       // vertexCount = uploaded capacity
+    Material batch_material;
+
+    // Shader and lookup tables of the GPU layer renderer, created on the
+    // first draw of a TILE_RENDER_GPU layer
+    struct TileGpuRenderer *gpu;
+
+    // Occlusion culling: the layers' hidden masks are rebuilt on the next
+    // draw after a pass, occluder or tile change
+    bool occlusion;           // on by default
+    bool occlusion_dirty;
+    int hidden_cells;         // tiles the last rebuild hid (all layers/planes)
 } TileMap;
 
+// Loads a map, preferring an up-to-date cooked .tmb next to the given .tmj
+// (see tilemap_format.h) and falling back to parsing the JSON.
 TileMap *tilemap_load(const char *path);
+// Background load: file reading, parsing and tileset image decoding run on
+// a worker thread; only the texture uploads happen on the main thread.
+//   TileMapLoad *load = tilemap_load_async(path);
+//   ...each frame: if (tilemap_load_poll(load)) map = tilemap_load_finish(load);
+typedef struct TileMapLoad TileMapLoad;
+TileMapLoad *tilemap_load_async(const char *path);
+// True once the map is ready (or failed). Uploads the tileset textures on the
+// first true result, so it must be called from the main thread.
+bool tilemap_load_poll(TileMapLoad *load);
+// Frees the handle and returns the map (NULL on failure), which the caller
+// owns and must tilemap_unload(). Waits for the worker if it is still
+// running and uploads the tileset textures if tilemap_load_poll() hasn't.
+TileMap *tilemap_load_finish(TileMapLoad *load);
+// Discards a load: waits for the worker, then frees the handle and the map.
+// Textures that were not uploaded yet never are.
+void tilemap_load_cancel(TileMapLoad *load);
+// CPU-only JSON parse: no textures are loaded. Used by the offline cooker.
+TileMap *tilemap_parse_json(const char *path);
+// Enable/disable "[tilemap]" progress output (on by default), which ends
+// with a tilemap_log_load_stats() line per load
+void tilemap_set_logging(bool enabled);
+void tilemap_log_load_stats(const TileMap *map);
+// Threads per load (including the loading thread), clamped to
+// 1..TASK_POOL_MAX_THREADS, or TILEMAP_LOAD_THREADS_AUTO for one per online
+// core. A load never uses more threads than it has tasks. 1 parses
+// everything on the loading thread.
+void tilemap_set_load_threads(int threads);
+// Merge runs of consecutive finite tile layers with the same render layer,
+// elevation, shader, opacity and visibility into one multi-plane layer at
+// load (off by default; the cooker must not use it).
+void tilemap_set_flatten_layers(bool enabled);
+// Keep finite layers' draw descriptors palette-packed per 32x32 chunk
+// (tile_palette.h) instead of 4 bytes per cell, decoded a row run at a time
+// when drawing (off by default). GIDs stay as loaded.
+void tilemap_set_compact_layers(bool enabled);
 void tilemap_unload(TileMap *map);
 void tilemap_update(TileMap *map, float dt);
+// Infinite maps: decode the chunks around the camera and evict the least
+// recently used ones beyond the budget. Call once per frame before drawing;
+// chunks that are not resident are skipped by the draw functions. No-op for
+// finite maps.
+void tilemap_stream_chunks(TileMap *map, Camera2D camera);
+void tilemap_set_chunk_budget(TileMap *map, size_t bytes);
+// Bake the chunks in view that are missing or invalidated into render
+// textures (main thread, outside drawing; call from update after
+// tilemap_stream_chunks()). Least recently used chunks are unloaded beyond
+// the budget. Draw functions use baked chunks where they exist and draw the
+// remaining regions tile by tile.
+void tilemap_bake_chunks(TileMap *map, Camera2D camera);
+void tilemap_set_bake_budget(TileMap *map, size_t bytes);
+// Mark the tiles in [x, x + w) x [y, y + h) of a layer (-1 = every layer)
+// as changed, so caches built from them are rebuilt
+void tilemap_invalidate_rect(TileMap *map, int layer_index, int x, int y, int w, int h);
+// Occlusion culling: tiles are skipped where an opaque tile of a layer drawn
+// later covers them. The tilemap assumes layers draw in (pass, index) order,
+// every layer in pass 0 and occluding by default (right for
+// tilemap_draw_all()). A game drawing layers in several passes, or with a
+// translucent tint, must say so: `occluder` false for a layer drawn tinted.
+// Only finite layers with opacity 1 and no shader occlude; baked layers skip
+// whole chunks, the GPU renderer does not cull.
+void tilemap_set_layer_pass(TileMap *map, int layer_index, int pass, bool occluder);
+void tilemap_set_occlusion(TileMap *map, bool enabled);
+// Draw finite layers from their overview textures (one quad per layer, see
+// TILEMAP_OVERVIEW_LEVELS) while a tile covers at most `px_per_tile` screen
+// pixels. 0 always draws tiles.
+void tilemap_set_overview_threshold(TileMap *map, float px_per_tile);
+// Every visible finite layer's overview, scaled into `dest` (screen or world
+// space): a minimap
+void tilemap_draw_overview(TileMap *map, Rectangle dest, Color tint);
+
+// Tile layer holding the Tiled layer `name`, which flattening may have
+// merged into another layer, or -1. `source` (may be NULL) gets its
+// position among the merged layers (0 if it wasn't merged).
+int tilemap_find_tile_layer(const TileMap *map, const char *name, int *source);
+// Write a GID (flip flags included, 0 clears) into a layer's cell(s) and
+// invalidate what was built from them. On a flattened layer only the tile
+// of merged layer `source` (see tilemap_find_tile_layer()) is replaced; the
+// other merged layers keep theirs, and the layer gains a plane if the cell
+// needs one. Infinite layers can only be edited inside their existing
+// chunks; edited chunks stay resident. Returns false if nothing could be
+// written (out of range, no such source, or a GID the map has no tile for).
+bool tilemap_set_source_tile(TileMap *map, int layer_index, int source, int x, int y, uint32_t gid);
+// tilemap_set_source_tile() over [x, x + w) x [y, y + h), invalidated as
+// one rect. Returns the number of cells that changed.
+int tilemap_fill_source_rect(TileMap *map, int layer_index, int source, int x, int y, int w, int h, uint32_t gid);
+// The same for source 0: the layer itself, or the bottom merged layer
+bool tilemap_set_tile(TileMap *map, int layer_index, int x, int y, uint32_t gid);
+int tilemap_fill_rect(TileMap *map, int layer_index, int x, int y, int w, int h, uint32_t gid);
+// Draw layers as one mesh per tileset instead of one DrawTexturePro() per
+// tile (on by default). Layers with a "shader" property keep per-tile drawing,
+// since a mesh draw uses its material's shader rather than BeginShaderMode().
+void tilemap_set_batching(TileMap *map, bool enabled);
+// Fill map->batches with the quads of a layer's tiles in [start_x, end_x) x
+// [start_y, end_y). CPU only (works on maps from tilemap_parse_json()).
+// Returns the number of quads.
+int tilemap_build_layer_batch(TileMap *map, int layer_index, int start_x, int start_y,
+                              int end_x, int end_y, Color tint);
+// Choose how a layer is drawn. TILE_RENDER_GPU covers finite layers whose
+// "shader" property, if any, has a GPU effect; other layers keep drawing per
+// tile (logged), as does every layer if the map's tilesets exceed the lookup
+// table limits (logged once).
+void tilemap_set_layer_renderer(TileMap *map, int layer_index, TileLayerRenderer renderer);
+// Let TILE_RENDER_GPU layers whose "shader" property is `name` (e.g. "water")
+// keep their shader: `fs_source` is the GLSL 330 fragment shader such layers
+// are drawn through per tile. It must define `vec4 layer_effect(vec4 texel)`
+// (a tile texel in, its color before the tint out) and leave its main() out
+// when TILEMAP_GPU_LAYER is defined; the GPU renderer compiles it into its
+// lookup shader. Registering a name again replaces its source (shader hot
+// reload); NULL removes it. Main thread only; applies to every map.
+void tilemap_set_gpu_effect(const char *name, const char *fs_source);
+// Shader a TILE_RENDER_GPU layer is drawn with (id 0 if it draws per tile),
+// so a layer with a GPU effect can get the effect's uniforms before each draw
+Shader tilemap_layer_gpu_shader(TileMap *map, int layer_index);
 void tilemap_draw_layer(TileMap *map, int layer_index, Camera2D camera);
 void tilemap_draw_layer_tinted(TileMap *map, int layer_index, Camera2D camera, Color tint);
 void tilemap_draw_all(TileMap *map, Camera2D camera);
+
+// What a hot reload changed (TileMapReload.flags)
+typedef enum TileMapReloadFlags {
+    TILEMAP_RELOAD_TILES    = 1 << 0,   // GIDs of some tile layers
+    TILEMAP_RELOAD_LAYERS   = 1 << 1,   // tile layer properties (visible, opacity,
+                                        // render_layer, elevation, shader)
+    TILEMAP_RELOAD_OBJECTS  = 1 << 2,   // object layers or their objects
+    TILEMAP_RELOAD_TILESETS = 1 << 3,   // tilesets, animations included
+    TILEMAP_RELOAD_LAYOUT   = 1 << 4,   // map/tile size or the tile layer list:
+                                        // no caches were carried over
+} TileMapReloadFlags;
+
+typedef struct TileMapReload {
+    int flags;                // TILEMAP_RELOAD_*
+    int changed_cells;        // tiles whose GID changed (every tile of a
+                              // changed chunk in infinite layers)
+    int changed_layers;       // tile layers with changed tiles or properties
+    double apply_ms;          // diff and carry-over (main thread)
+} TileMapReload;
+
+// Hot reload for level editing: watch the .tmj a map was loaded from and its
+// external .tsj tilesets.
+//   TileMapWatch *watch = tilemap_watch(map, path);
+//   ...each frame: if (tilemap_watch_poll(watch, &map, &changes)) re-resolve
+//   string ids, layer settings and MapObject pointers from the new map
+typedef struct TileMapWatch TileMapWatch;
+// NULL if the files can't be watched
+TileMapWatch *tilemap_watch(const TileMap *map, const char *path);
+// Main thread, once per frame. A change starts a background reload
+// (tilemap_load_async()). When it is done the reloaded map is diffed against
+// the live one: settings and render caches (baked chunks, GPU cell textures,
+// quad batches, the animation clock) move over to it, and only what was
+// built from changed tiles is invalidated. Then *map is replaced, the old
+// map unloaded, and true returned with *changes filled in. Tile edits made
+// at runtime are dropped. A reload that fails keeps the live map.
+bool tilemap_watch_poll(TileMapWatch *watch, TileMap **map, TileMapReload *changes);
+// Stop watching; a pending reload is cancelled
+void tilemap_watch_stop(TileMapWatch *watch);
+
+// Object lookups go through the index built at load. layer_name NULL
+// searches every object layer. Returned pointers stay valid until unload.
+// First object of a type, in map order
 MapObject *tilemap_find_object(TileMap *map, const char *layer_name, const char *type);
+MapObject *tilemap_find_object_by_name(TileMap *map, const char *layer_name, const char *name);
+// Every object of a type, in map order; NULL (count 0) if there are none
+MapObject *const *tilemap_objects_of_type(TileMap *map, const char *layer_name, const char *type, int *count);
+ObjectLayer *tilemap_find_object_layer(TileMap *map, const char *name);
+// Objects whose bounds touch or overlap `rect` (world pixels). Stores up to
+// `capacity` of them in `out` and returns how many there are in total.
+int tilemap_query_objects_in_rect(TileMap *map, const char *layer_name, Rectangle rect,
+                                  MapObject **out, int capacity);
+// Interned strings: layer render_layer/shader, object layer names, object
+// names and types. tilemap_string_id() is -1 for a string the map never
+// uses; resolve the ids a scene compares against once, after loading.
+const char *tilemap_string(const TileMap *map, int id);
+int tilemap_string_id(const TileMap *map, const char *string);
 
 #endif
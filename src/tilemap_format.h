@@ -0,0 +1,96 @@
+#ifndef TILEMAP_FORMAT_H
+#define TILEMAP_FORMAT_H
+
+#include <stdint.h>
+
+// Cooked tilemap (.tmb) — binary form of a Tiled .tmj plus its external
+// .tsj tilesets, written offline by tools/tmjcook.c and mmapped by
+// tilemap_load(). Every offset is a byte offset from the start of the file
+// and every section is 8-byte aligned, so layer data and animation frames
+// are used in place. Strings are offsets into a pool of NUL-terminated
+// strings (offset 0 is always the empty string). Little-endian only.
+//
+// Bump TMB_VERSION whenever any struct below changes.
+
+#define TMB_MAGIC   0x31424D54u   // "TMB1"
+#define TMB_VERSION 1
+#define TMB_ALIGN   8
+
+typedef struct TmbHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t file_size;
+    int32_t width;
+    int32_t height;
+    int32_t tilewidth;
+    int32_t tileheight;
+    uint32_t tileset_count;
+    uint32_t tile_layer_count;
+    uint32_t object_layer_count;
+    uint32_t tilesets_offset;       // TmbTileset[tileset_count]
+    uint32_t tile_layers_offset;    // TmbTileLayer[tile_layer_count]
+    uint32_t object_layers_offset;  // TmbObjectLayer[object_layer_count]
+    uint32_t strings_offset;
+    uint32_t strings_size;
+    uint32_t reserved;
+} TmbHeader;
+
+typedef struct TmbTileset {
+    int32_t firstgid;
+    int32_t tilewidth;
+    int32_t tileheight;
+    int32_t columns;
+    int32_t tilecount;
+    int32_t margin;
+    int32_t spacing;
+    int32_t imagewidth;
+    int32_t imageheight;
+    uint32_t image;          // string: image path relative to the map's directory
+    uint32_t source;         // string: external .tsj relative to the map's directory ("" if embedded)
+    uint32_t anim_count;
+    uint32_t anims_offset;   // TmbTileAnim[anim_count]
+    uint32_t reserved;
+} TmbTileset;
+
+typedef struct TmbTileAnim {
+    int32_t tileid;          // local tile ID that animates
+    int32_t frame_count;
+    int32_t total_duration;
+    uint32_t frames_offset;  // TileAnimFrame[frame_count] ({int32 tileid, int32 duration})
+} TmbTileAnim;
+
+typedef struct TmbTileLayer {
+    uint32_t name;
+    uint32_t render_layer;
+    uint32_t shader;
+    int32_t width;
+    int32_t height;
+    int32_t visible;
+    float opacity;
+    int32_t elevation;
+    uint32_t data_offset;    // uint32_t[width * height], raw GIDs with flip flags
+    uint32_t reserved;
+} TmbTileLayer;
+
+typedef struct TmbObjectLayer {
+    uint32_t name;
+    int32_t visible;
+    uint32_t object_count;
+    uint32_t objects_offset; // TmbObject[object_count]
+} TmbObjectLayer;
+
+typedef struct TmbObject {
+    double x, y;
+    double width, height;
+    double rotation;
+    int32_t id;
+    uint32_t name;
+    uint32_t type;
+    int32_t visible;
+    int32_t elevation;
+    int32_t from_elevation;
+    int32_t to_elevation;
+    int32_t reserved;
+} TmbObject;
+
+#endif
@@ -0,0 +1,180 @@
+// Collision benchmark: collision_move_and_slide() for many movers among many
+// static walls, through the grid broadphase against the previous linear scan
+// of every body (kept here as the reference). Both worlds are stepped in
+// lockstep and every mover must end up at the same position. A third column
+// times collision_query_rect() around each mover, which reads the kinematic
+// bodies the moves re-listed. Between frames some walls are removed and
+// fewer added back (the same in both worlds), so hole reuse, stale handles
+// and compaction are checked too. Needs no window or GPU.
+//
+// Usage: bench_collision [frames] [walls] [movers] [churn]
+
+#include "collision.h"
+#include "platform.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define WORLD_SIZE 8192.0f
+
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static double median_ms(double *times, int count) {
+    qsort(times, count, sizeof(double), compare_double);
+    return times[count / 2];
+}
+
+static float random_range(float lo, float hi) {
+    return lo + (hi - lo) * (float)rand() / (float)RAND_MAX;
+}
+
+// The move-and-slide loop before the broadphase: every body, both passes
+static void linear_move_and_slide(CollisionWorld *world, CollisionHandle handle, float dx, float dy) {
+    int index = collision_body_index(world, handle);
+    Rectangle *rect = &world->rects[index];
+    rect->x += dx;
+    for (int i = 0; i < world->body_count; i++) {
+        const Rectangle other = world->rects[i];
+        if (i == index || !(world->flags[i] & BODY_ACTIVE) || world->types[i] != BODY_STATIC) continue;
+        if (world->elevations[i] != world->elevations[index] || !CheckCollisionRecs(*rect, other)) continue;
+        if (dx > 0) rect->x = other.x - rect->width;
+        else if (dx < 0) rect->x = other.x + other.width;
+    }
+    rect->y += dy;
+    for (int i = 0; i < world->body_count; i++) {
+        const Rectangle other = world->rects[i];
+        if (i == index || !(world->flags[i] & BODY_ACTIVE) || world->types[i] != BODY_STATIC) continue;
+        if (world->elevations[i] != world->elevations[index] || !CheckCollisionRecs(*rect, other)) continue;
+        if (dy > 0) rect->y = other.y - rect->height;
+        else if (dy < 0) rect->y = other.y + other.height;
+    }
+}
+
+// Movers turn around at the world's edges
+static Rectangle random_wall(void) {
+    return (Rectangle){ random_range(0, WORLD_SIZE), random_range(0, WORLD_SIZE), random_range(16, 96),
+                        random_range(16, 96) };
+}
+
+static void bounce(Rectangle rect, Vector2 *velocity) {
+    if (rect.x < 0.0f || rect.x > WORLD_SIZE) velocity->x = -velocity->x;
+    if (rect.y < 0.0f || rect.y > WORLD_SIZE) velocity->y = -velocity->y;
+}
+
+int main(int argc, char **argv) {
+    int frames = argc > 1 ? atoi(argv[1]) : 200;
+    int walls = argc > 2 ? atoi(argv[2]) : 10000;
+    int movers = argc > 3 ? atoi(argv[3]) : 500;
+    int churn = argc > 4 ? atoi(argv[4]) : 40;
+    if (frames < 1) frames = 1;
+    if (walls < 0) walls = 0;
+    if (movers < 1) movers = 1;
+    if (churn < 0) churn = 0;
+
+    // Same walls and movers in both worlds; a fifth of everything is on
+    // elevation 1
+    CollisionWorld *grid = collision_create();
+    CollisionWorld *linear = collision_create();
+    Vector2 *velocity = (Vector2 *)malloc(movers * sizeof(Vector2));
+    CollisionHandle *mover_body = (CollisionHandle *)malloc(movers * sizeof(CollisionHandle));
+    CollisionHandle *found = (CollisionHandle *)malloc((walls + movers) * sizeof(CollisionHandle));
+    CollisionHandle *wall_body = (CollisionHandle *)malloc((walls + 1) * sizeof(CollisionHandle));
+    double *times[3];
+    for (int i = 0; i < 3; i++) times[i] = (double *)malloc(frames * sizeof(double));
+    if (!grid || !linear || !velocity || !mover_body || !found || !wall_body || !times[0] || !times[1] ||
+        !times[2]) {
+        return 1;
+    }
+    srand(1);
+    for (int i = 0; i < walls; i++) {
+        Rectangle rect = random_wall();
+        int elevation = rand() % 5 == 0;
+        wall_body[i] = collision_add_body(grid, rect, BODY_STATIC, TAG_WALL, elevation, NULL);
+        collision_add_body(linear, rect, BODY_STATIC, TAG_WALL, elevation, NULL);
+    }
+    for (int i = 0; i < movers; i++) {
+        Rectangle rect = { random_range(0, WORLD_SIZE), random_range(0, WORLD_SIZE), 16, 16 };
+        int elevation = rand() % 5 == 0;
+        float angle = random_range(0, 6.2831853f), speed = random_range(1, 3);
+        velocity[i] = (Vector2){ cosf(angle) * speed, sinf(angle) * speed };
+        mover_body[i] = collision_add_body(grid, rect, BODY_KINEMATIC, TAG_NPC, elevation, NULL);
+        collision_add_body(linear, rect, BODY_KINEMATIC, TAG_NPC, elevation, NULL);
+    }
+
+    long mismatches = 0, neighbours = 0, removed = 0, added = 0;
+    int wall_count = walls, compactions = 0;
+    for (int f = 0; f < frames; f++) {
+        double start = platform_time_seconds();
+        for (int i = 0; i < movers; i++) {
+            linear_move_and_slide(linear, mover_body[i], velocity[i].x, velocity[i].y);
+        }
+        times[0][f] = (platform_time_seconds() - start) * 1000.0;
+
+        start = platform_time_seconds();
+        for (int i = 0; i < movers; i++) {
+            collision_move_and_slide(grid, mover_body[i], velocity[i].x, velocity[i].y);
+        }
+        times[1][f] = (platform_time_seconds() - start) * 1000.0;
+
+        start = platform_time_seconds();
+        for (int i = 0; i < movers; i++) {
+            Rectangle rect = collision_body_rect(grid, mover_body[i]);
+            Rectangle around = { rect.x - 32, rect.y - 32, 80, 80 };
+            neighbours += collision_query_rect(grid, around, collision_body_elevation(grid, mover_body[i]), found,
+                                               walls + movers);
+        }
+        times[2][f] = (platform_time_seconds() - start) * 1000.0;
+
+        for (int i = 0; i < movers; i++) {
+            Rectangle a = collision_body_rect(grid, mover_body[i]), b = collision_body_rect(linear, mover_body[i]);
+            if (a.x != b.x || a.y != b.y) mismatches++;
+            bounce(a, &velocity[i]);
+        }
+
+        // Remove `churn` walls and add half as many; the handles must match
+        for (int i = 0; i < churn && wall_count > 0; i++) {
+            int pick = rand() % wall_count;
+            CollisionHandle handle = wall_body[pick];
+            collision_remove_body(grid, handle);
+            collision_remove_body(linear, handle);
+            if (collision_body_valid(grid, handle)) mismatches++;
+            wall_body[pick] = wall_body[--wall_count];
+            removed++;
+        }
+        for (int i = 0; i < churn / 2; i++) {
+            Rectangle rect = random_wall();
+            int elevation = rand() % 5 == 0;
+            CollisionHandle handle = collision_add_body(grid, rect, BODY_STATIC, TAG_WALL, elevation, NULL);
+            if (collision_add_body(linear, rect, BODY_STATIC, TAG_WALL, elevation, NULL) != handle) mismatches++;
+            if (wall_count < walls) wall_body[wall_count++] = handle;
+            added++;
+        }
+        if (collision_compact(grid)) compactions++;
+        collision_compact(linear);
+    }
+
+    printf("%d static walls, %d movers, %d frames, %d px cells (%d in use)\n", walls, movers, frames,
+           COLLISION_GRID_CELL, grid->cells_used);
+    printf("%ld walls removed, %ld added, %d compactions, %d live bodies in %d entries\n\n", removed, added,
+           compactions, grid->live_count, grid->body_count);
+    static const char *names[3] = { "linear scan", "grid", "grid query" };
+    printf("%-14s %14s %14s\n", "", "ms/frame", "kmoves/s");
+    for (int i = 0; i < 3; i++) {
+        double ms = median_ms(times[i], frames);
+        printf("%-14s %14.3f %14.1f\n", names[i], ms, ms > 0.0 ? movers / ms : 0.0);
+    }
+    printf("\n%.1f bodies around each mover on average\n", (double)neighbours / ((double)frames * movers));
+    if (mismatches > 0) printf("WARNING: %ld mover positions or handles differ from the linear scan\n", mismatches);
+
+    for (int i = 0; i < 3; i++) free(times[i]);
+    free(velocity);
+    free(mover_body);
+    free(found);
+    free(wall_body);
+    collision_destroy(grid);
+    collision_destroy(linear);
+    return mismatches > 0;
+}
@@ -0,0 +1,67 @@
+// Quad batch benchmark: CPU time of tilemap_build_layer_batch() for every
+// tile layer of a map, for views of growing size centred on the map. Only
+// parses the map (tilemap_parse_json), so it needs no window or GPU. Chunks
+// of infinite maps are never decoded here, so use a finite map.
+//
+// Usage: bench_tile_batch <map.tmj> [iterations]
+
+#include "tilemap.h"
+#include "platform.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <map.tmj> [iterations]\n", argv[0]);
+        return 2;
+    }
+    const char *path = argv[1];
+    int iterations = argc > 2 ? atoi(argv[2]) : 200;
+    if (iterations < 1) iterations = 1;
+
+    tilemap_set_logging(false);
+    TileMap *map = tilemap_parse_json(path);
+    if (!map) {
+        fprintf(stderr, "Failed to parse %s\n", path);
+        return 1;
+    }
+
+    double *times = (double *)malloc(iterations * sizeof(double));
+    if (!times) return 1;
+
+    // View sizes in tiles, from one screen at zoom 2 to the whole map
+    static const int views[] = { 40, 80, 160, 320, 640 };
+    printf("%s, %d tile layers, %d iterations per view\n", path, map->tile_layer_count, iterations);
+    printf("%-10s %10s %12s %12s %14s\n", "view", "quads", "median ms", "ns/quad", "Mquads/s");
+    for (int v = 0; v < (int)(sizeof(views) / sizeof(views[0])); v++) {
+        int start_x = map->width / 2 - views[v] / 2;
+        int start_y = map->height / 2 - views[v] / 2;
+        int end_x = start_x + views[v];
+        int end_y = start_y + views[v];
+
+        long quads = 0;
+        for (int i = 0; i < iterations; i++) {
+            quads = 0;
+            double start = platform_time_seconds();
+            for (int l = 0; l < map->tile_layer_count; l++) {
+                quads += tilemap_build_layer_batch(map, l, start_x, start_y, end_x, end_y, WHITE);
+            }
+            times[i] = (platform_time_seconds() - start) * 1000.0;
+        }
+        qsort(times, iterations, sizeof(double), compare_double);
+        double median = times[iterations / 2];
+        char label[32];
+        snprintf(label, sizeof(label), "%dx%d", views[v], views[v]);
+        printf("%-10s %10ld %12.3f %12.2f %14.1f\n", label, quads, median,
+               quads > 0 ? median * 1e6 / quads : 0.0, median > 0.0 ? quads / (median * 1000.0) : 0.0);
+    }
+
+    free(times);
+    tilemap_unload(map);
+    return 0;
+}
@@ -0,0 +1,345 @@
+// Tile layer codec check: every finite tile layer of a map is re-encoded
+// the ways Tiled can save it (base64 with no compression, zlib, gzip and,
+// in a TILEMAP_ZSTD=1 build, zstd), each copy is loaded with
+// tilemap_parse_json() and its GIDs must match the original (CSV) map's.
+// Then random buffers are base64 encoded and decoded with the SSSE3 path
+// and with the scalar loop, which must both return the input, and corrupted
+// copies must be rejected by both. Load and decode times are reported.
+// Needs no window or GPU.
+//
+// Usage: bench_tile_codec [map.tmj] [rounds]
+
+#include "tilemap.h"
+#include "tile_codec.h"
+#include "cJSON.h"
+#include "json_stream.h"
+#include "platform.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(TILEMAP_ZSTD)
+#include <zstd.h>
+#endif
+
+#define RANDOM_BUFFERS 4000
+#define RANDOM_MAX_BYTES 3000
+#define DECODE_BYTES (8 << 20)
+
+static const char base64_alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static double median_ms(double *times, int count) {
+    qsort(times, count, sizeof(double), compare_double);
+    return times[count / 2];
+}
+
+// Padded base64 of `size` bytes into `out` (4 * ceil(size / 3) + 1 bytes)
+static size_t base64_encode(const uint8_t *data, size_t size, char *out) {
+    size_t len = 0;
+    for (size_t i = 0; i < size; i += 3) {
+        uint32_t v = (uint32_t)data[i] << 16;
+        if (i + 1 < size) v |= (uint32_t)data[i + 1] << 8;
+        if (i + 2 < size) v |= data[i + 2];
+        out[len++] = base64_alphabet[(v >> 18) & 63];
+        out[len++] = base64_alphabet[(v >> 12) & 63];
+        out[len++] = i + 1 < size ? base64_alphabet[(v >> 6) & 63] : '=';
+        out[len++] = i + 2 < size ? base64_alphabet[v & 63] : '=';
+    }
+    out[len] = '\0';
+    return len;
+}
+
+static uint32_t adler32(const uint8_t *data, size_t size) {
+    uint32_t a = 1, b = 0;
+    for (size_t i = 0; i < size; i++) {
+        a = (a + data[i]) % 65521;
+        b = (b + a) % 65521;
+    }
+    return (b << 16) | a;
+}
+
+// Compress `size` bytes the way Tiled stores them: raylib's raw DEFLATE
+// inside a zlib (RFC 1950) or gzip (RFC 1952) wrapper, or a zstd frame.
+// Returns a malloc'd buffer, or NULL if the compression isn't available.
+static uint8_t *compress_layer(const uint8_t *data, size_t size, const char *compression, size_t *out_size) {
+    if (strcmp(compression, "zstd") == 0) {
+#if defined(TILEMAP_ZSTD)
+        size_t bound = ZSTD_compressBound(size);
+        uint8_t *out = (uint8_t *)malloc(bound);
+        if (!out) return NULL;
+        size_t written = ZSTD_compress(out, bound, data, size, 3);
+        if (ZSTD_isError(written)) {
+            free(out);
+            return NULL;
+        }
+        *out_size = written;
+        return out;
+#else
+        return NULL;
+#endif
+    }
+
+    int deflated_size = 0;
+    unsigned char *deflated = CompressData(data, (int)size, &deflated_size);
+    if (!deflated) return NULL;
+    bool gzip = strcmp(compression, "gzip") == 0;
+    size_t header = gzip ? 10 : 2, trailer = gzip ? 8 : 4;
+    uint8_t *out = (uint8_t *)malloc(header + deflated_size + trailer);
+    if (!out) {
+        MemFree(deflated);
+        return NULL;
+    }
+    uint8_t *p = out;
+    if (gzip) {
+        static const uint8_t gzip_header[10] = { 0x1F, 0x8B, 8, 0, 0, 0, 0, 0, 0, 0xFF };
+        memcpy(p, gzip_header, sizeof(gzip_header));
+        p += sizeof(gzip_header);
+    } else {
+        *p++ = 0x78;
+        *p++ = 0xDA;
+    }
+    memcpy(p, deflated, deflated_size);
+    p += deflated_size;
+    MemFree(deflated);
+    if (gzip) {
+        uint32_t crc = ComputeCRC32((unsigned char *)data, (int)size), length = (uint32_t)size;
+        for (int i = 0; i < 4; i++) *p++ = (uint8_t)(crc >> (8 * i));
+        for (int i = 0; i < 4; i++) *p++ = (uint8_t)(length >> (8 * i));
+    } else {
+        uint32_t sum = adler32(data, size);
+        for (int i = 3; i >= 0; i--) *p++ = (uint8_t)(sum >> (8 * i));
+    }
+    *out_size = (size_t)(p - out);
+    return out;
+}
+
+// Replace each CSV "data" array of `root`'s tile layers with its encoded
+// form. Adds the payload bytes to *encoded_bytes; false if a layer couldn't
+// be encoded.
+static bool encode_layers(cJSON *root, const char *compression, size_t *encoded_bytes) {
+    cJSON *layer;
+    cJSON_ArrayForEach(layer, cJSON_GetObjectItem(root, "layers")) {
+        cJSON *data = cJSON_GetObjectItem(layer, "data");
+        if (!data || !cJSON_IsArray(data)) continue;
+
+        int count = cJSON_GetArraySize(data), i = 0;
+        uint32_t *gids = (uint32_t *)malloc((count > 0 ? count : 1) * sizeof(uint32_t));
+        if (!gids) return false;
+        cJSON *gid;
+        cJSON_ArrayForEach(gid, data) {
+            gids[i++] = (uint32_t)gid->valuedouble;
+        }
+
+        const uint8_t *bytes = (const uint8_t *)gids;
+        size_t size = (size_t)count * sizeof(uint32_t);
+        uint8_t *packed = NULL;
+        if (compression[0]) {
+            packed = compress_layer(bytes, size, compression, &size);
+            if (!packed) {
+                free(gids);
+                return false;
+            }
+            bytes = packed;
+        }
+        char *text = (char *)malloc(4 * ((size + 2) / 3) + 1);
+        if (text) base64_encode(bytes, size, text);
+        free(packed);
+        free(gids);
+        if (!text) return false;
+
+        *encoded_bytes += strlen(text);
+        cJSON_ReplaceItemInObject(layer, "data", cJSON_CreateString(text));
+        free(text);
+        cJSON_DeleteItemFromObject(layer, "encoding");
+        cJSON_DeleteItemFromObject(layer, "compression");
+        cJSON_AddStringToObject(layer, "encoding", "base64");
+        if (compression[0]) cJSON_AddStringToObject(layer, "compression", compression);
+    }
+    return true;
+}
+
+// Tile layers of `map` whose GIDs differ from `ref`'s
+static int count_layer_mismatches(const TileMap *ref, const TileMap *map) {
+    if (map->tile_layer_count != ref->tile_layer_count) return ref->tile_layer_count;
+    int mismatches = 0;
+    for (int l = 0; l < ref->tile_layer_count; l++) {
+        const TileLayer *a = &ref->tile_layers[l], *b = &map->tile_layers[l];
+        if (!a->data) continue;
+        size_t cells = (size_t)a->width * a->height * a->planes;
+        if (!b->data || b->width != a->width || b->height != a->height || b->planes != a->planes ||
+            memcmp(a->data, b->data, cells * sizeof(uint32_t)) != 0) {
+            mismatches++;
+        }
+    }
+    return mismatches;
+}
+
+// Decode `text` with the current path; true if it returns exactly `expected`
+static bool decodes_to(const char *text, size_t len, const uint8_t *expected, size_t size, uint8_t *out) {
+    long written = base64_decode(text, len, out, RANDOM_MAX_BYTES);
+    return written == (long)size && memcmp(out, expected, size) == 0;
+}
+
+static bool rejects(const char *text, size_t len, uint8_t *out) {
+    return base64_decode(text, len, out, RANDOM_MAX_BYTES) == -1;
+}
+
+// Random round trips and corruptions through both paths. Returns failures.
+static long check_base64_paths(void) {
+    static const char invalid[] = { '*', '-', '_', ' ', '\n', '.', '=', (char)0x80, (char)0xFF, 0 };
+    uint8_t *data = (uint8_t *)malloc(RANDOM_MAX_BYTES);
+    uint8_t *out = (uint8_t *)malloc(RANDOM_MAX_BYTES);
+    char *text = (char *)malloc(4 * ((RANDOM_MAX_BYTES + 2) / 3) + 1);
+    if (!data || !out || !text) return 1;
+
+    long failures = 0;
+    srand(1);
+    for (int t = 0; t < RANDOM_BUFFERS; t++) {
+        size_t size = (size_t)(rand() % RANDOM_MAX_BYTES);
+        for (size_t i = 0; i < size; i++) data[i] = (uint8_t)rand();
+        size_t len = base64_encode(data, size, text);
+        for (int simd = 0; simd < 2; simd++) {
+            tile_codec_set_simd(simd);
+            if (!decodes_to(text, len, data, size, out)) failures++;
+        }
+        if (len < 4) continue;
+
+        // One bad character anywhere ('=' only where it isn't padding)
+        size_t pos = (size_t)rand() % len;
+        char bad = invalid[rand() % (int)(sizeof(invalid) - 1)];
+        if (bad == '=') pos = (size_t)rand() % (len - 4);
+        char saved = text[pos];
+        text[pos] = bad;
+        for (int simd = 0; simd < 2; simd++) {
+            tile_codec_set_simd(simd);
+            if (!rejects(text, len, out)) failures++;
+        }
+        text[pos] = saved;
+
+        // A length that isn't a whole number of quanta, and data after '='
+        char last = text[len - 1];
+        text[len - 2] = '=';
+        for (int simd = 0; simd < 2; simd++) {
+            tile_codec_set_simd(simd);
+            if (!rejects(text, len - 1, out)) failures++;
+            if (last != '=' && !rejects(text, len, out)) failures++;
+        }
+    }
+    tile_codec_set_simd(true);
+    free(data);
+    free(out);
+    free(text);
+    return failures;
+}
+
+int main(int argc, char **argv) {
+    const char *path = argc > 1 ? argv[1] : "assets/overworld.tmj";
+    int rounds = argc > 2 ? atoi(argv[2]) : 10;
+    if (rounds < 1) rounds = 1;
+    tilemap_set_logging(false);
+
+    TileMap *ref = tilemap_parse_json(path);
+    char *text = LoadFileText(path);
+    if (!ref || !text) {
+        printf("ERROR: Could not load %s\n", path);
+        return 1;
+    }
+    json_fix_backslashes(text, strlen(text));
+    cJSON *original = cJSON_Parse(text);
+    UnloadFileText(text);
+    double *times = (double *)malloc(rounds * sizeof(double));
+    if (!original || !times) return 1;
+
+    // Encoded copies go next to the map so its tileset paths still resolve
+    char copy_path[1024];
+    snprintf(copy_path, sizeof(copy_path), "%s.codec.tmj", path);
+
+    static const char *compressions[] = { "csv", "", "zlib", "gzip", "zstd" };
+    long failures = 0;
+    printf("%d tile layers, %d rounds\n\n", ref->tile_layer_count, rounds);
+    printf("%-14s %14s %14s %10s\n", "layer data", "bytes", "parse ms", "GIDs");
+    for (int c = 0; c < 5; c++) {
+        const char *compression = compressions[c];
+        bool csv = c == 0;
+        const char *label = csv ? "csv" : compression[0] ? compression : "base64";
+        size_t encoded_bytes = 0;
+        cJSON *doc = cJSON_Duplicate(original, true);
+        if (!doc || (!csv && !encode_layers(doc, compression, &encoded_bytes))) {
+            printf("%-14s %14s %14s %10s\n", label, "-", "-", "skipped");
+            cJSON_Delete(doc);
+            continue;
+        }
+        char *json = cJSON_PrintUnformatted(doc);
+        cJSON_Delete(doc);
+        FILE *f = json ? fopen(copy_path, "wb") : NULL;
+        bool written = f && fwrite(json, 1, strlen(json), f) == strlen(json);
+        if (f) fclose(f);
+        cJSON_free(json);
+        if (!written) {
+            printf("ERROR: Could not write %s\n", copy_path);
+            failures++;
+            break;
+        }
+
+        int mismatches = 0;
+        for (int r = 0; r < rounds; r++) {
+            double start = platform_time_seconds();
+            TileMap *map = tilemap_parse_json(copy_path);
+            times[r] = (platform_time_seconds() - start) * 1000.0;
+            mismatches = map ? count_layer_mismatches(ref, map) : ref->tile_layer_count;
+            tilemap_unload(map);
+            if (mismatches > 0) break;
+        }
+        if (mismatches > 0) failures++;
+        char bytes[32];
+        if (csv) snprintf(bytes, sizeof(bytes), "-");
+        else snprintf(bytes, sizeof(bytes), "%zu", encoded_bytes);
+        printf("%-14s %14s %14.3f %10s\n", label, bytes, median_ms(times, rounds), mismatches ? "DIFFER" : "match");
+    }
+    remove(copy_path);
+
+    // Decode throughput of each base64 path over one large buffer
+    uint8_t *data = (uint8_t *)malloc(DECODE_BYTES), *out = (uint8_t *)malloc(DECODE_BYTES);
+    char *encoded = (char *)malloc(4 * ((DECODE_BYTES + 2) / 3) + 1);
+    if (!data || !out || !encoded) return 1;
+    srand(2);
+    for (size_t i = 0; i < DECODE_BYTES; i++) data[i] = (uint8_t)rand();
+    size_t len = base64_encode(data, DECODE_BYTES, encoded);
+    printf("\n%-14s %14s %14s %10s\n", "base64", "ms", "MB/s", "bytes");
+    static const char *paths[2] = { "scalar", "ssse3" };
+    for (int simd = 0; simd < 2; simd++) {
+        if (tile_codec_set_simd(simd) != (bool)simd) {
+            printf("%-14s %14s %14s %10s\n", paths[simd], "-", "-", "no cpu");
+            continue;
+        }
+        bool same = true;
+        for (int r = 0; r < rounds; r++) {
+            double start = platform_time_seconds();
+            long written = base64_decode(encoded, len, out, DECODE_BYTES);
+            times[r] = (platform_time_seconds() - start) * 1000.0;
+            same = same && written == DECODE_BYTES && memcmp(out, data, DECODE_BYTES) == 0;
+        }
+        if (!same) failures++;
+        double ms = median_ms(times, rounds);
+        printf("%-14s %14.3f %14.1f %10s\n", paths[simd], ms, ms > 0.0 ? DECODE_BYTES / (ms * 1000.0) : 0.0,
+               same ? "match" : "DIFFER");
+    }
+
+    long path_failures = check_base64_paths();
+    printf("\n%d random buffers through both base64 paths: %ld failures\n", RANDOM_BUFFERS, path_failures);
+    failures += path_failures;
+    if (failures > 0) printf("WARNING: %ld checks failed\n", failures);
+
+    free(data);
+    free(out);
+    free(encoded);
+    free(times);
+    cJSON_Delete(original);
+    tilemap_unload(ref);
+    return failures > 0;
+}
@@ -0,0 +1,164 @@
+// Compact layer benchmark: memory of palette-packed draw descriptors
+// (tilemap_set_compact_layers) against plain 4-byte descriptors, and the
+// cost of reading them: every cell through tile_palette_get(), through
+// tile_palette_decode_run() row by row, and the batched draw loop
+// (tilemap_build_layer_batch) over views of growing size. Only parses the
+// map, so it needs no window or GPU. Use a finite map.
+//
+// Usage: bench_tile_palette <map.tmj> [iterations]
+
+#include "tilemap.h"
+#include "platform.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static double median_ms(double *times, int count) {
+    qsort(times, count, sizeof(double), compare_double);
+    return times[count / 2];
+}
+
+// Sum of every descriptor of every layer, so reads can't be optimized out
+typedef uint32_t (*ScanFunc)(const TileMap *map, uint32_t *row);
+
+static uint32_t scan_plain(const TileMap *map, uint32_t *row) {
+    (void)row;
+    uint32_t sum = 0;
+    for (int l = 0; l < map->tile_layer_count; l++) {
+        const TileLayer *layer = &map->tile_layers[l];
+        size_t cells = (size_t)layer->width * layer->height * layer->planes;
+        for (size_t i = 0; layer->desc && i < cells; i++) sum += layer->desc[i];
+    }
+    return sum;
+}
+
+static uint32_t scan_get(const TileMap *map, uint32_t *row) {
+    (void)row;
+    uint32_t sum = 0;
+    for (int l = 0; l < map->tile_layer_count; l++) {
+        const TilePaletteGrid *grid = &map->tile_layers[l].packed;
+        for (int y = 0; grid->chunks && y < grid->height; y++) {
+            for (int x = 0; x < grid->width; x++) sum += tile_palette_get(grid, x, y);
+        }
+    }
+    return sum;
+}
+
+static uint32_t scan_runs(const TileMap *map, uint32_t *row) {
+    uint32_t sum = 0;
+    for (int l = 0; l < map->tile_layer_count; l++) {
+        const TilePaletteGrid *grid = &map->tile_layers[l].packed;
+        for (int y = 0; grid->chunks && y < grid->height; y++) {
+            tile_palette_decode_run(grid, y, 0, grid->width, row);
+            for (int x = 0; x < grid->width; x++) sum += row[x];
+        }
+    }
+    return sum;
+}
+
+static double time_scan(const TileMap *map, ScanFunc scan, uint32_t *row, int iterations, double *times,
+                        uint32_t *sum) {
+    for (int i = 0; i < iterations; i++) {
+        double start = platform_time_seconds();
+        *sum = scan(map, row);
+        times[i] = (platform_time_seconds() - start) * 1000.0;
+    }
+    return median_ms(times, iterations);
+}
+
+static double time_batches(TileMap *map, int view, int iterations, double *times, long *quads) {
+    int start_x = map->width / 2 - view / 2;
+    int start_y = map->height / 2 - view / 2;
+    for (int i = 0; i < iterations; i++) {
+        *quads = 0;
+        double start = platform_time_seconds();
+        for (int l = 0; l < map->tile_layer_count; l++) {
+            *quads += tilemap_build_layer_batch(map, l, start_x, start_y, start_x + view, start_y + view, WHITE);
+        }
+        times[i] = (platform_time_seconds() - start) * 1000.0;
+    }
+    return median_ms(times, iterations);
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <map.tmj> [iterations]\n", argv[0]);
+        return 2;
+    }
+    const char *path = argv[1];
+    int iterations = argc > 2 ? atoi(argv[2]) : 100;
+    if (iterations < 1) iterations = 1;
+
+    tilemap_set_logging(false);
+    TileMap *plain = tilemap_parse_json(path);
+    tilemap_set_compact_layers(true);
+    TileMap *compact = tilemap_parse_json(path);
+    tilemap_set_compact_layers(false);
+    if (!plain || !compact) {
+        fprintf(stderr, "Failed to parse %s\n", path);
+        return 1;
+    }
+    double *times = (double *)malloc(iterations * sizeof(double));
+    int widest = 1;
+    for (int l = 0; l < plain->tile_layer_count; l++) {
+        if (plain->tile_layers[l].width > widest) widest = plain->tile_layers[l].width;
+    }
+    uint32_t *row = (uint32_t *)malloc(widest * sizeof(uint32_t));
+    if (!times || !row) return 1;
+
+    printf("%s, %d tile layers, %d iterations\n\n", path, plain->tile_layer_count, iterations);
+    printf("%-24s %10s %12s %10s %12s %8s\n", "layer", "cells", "plain KB", "packed KB", "bits/cell", "flips");
+    long total_cells = 0;
+    size_t plain_bytes = 0, packed_bytes = 0;
+    for (int l = 0; l < compact->tile_layer_count; l++) {
+        const TileLayer *layer = &compact->tile_layers[l];
+        const TilePaletteGrid *grid = &layer->packed;
+        long cells = (long)layer->width * layer->height * layer->planes;
+        int flips = 0;
+        for (int c = 0; grid->chunks && c < grid->cols * grid->rows; c++) flips += grid->chunks[c].flip_count;
+        printf("%-24.24s %10ld %12.1f %10.1f %12.2f %8d\n", layer->name, cells, cells * 4 / 1024.0,
+               grid->bytes / 1024.0, cells > 0 ? grid->bytes * 8.0 / cells : 0.0, flips);
+        total_cells += cells;
+        plain_bytes += (size_t)cells * 4;
+        packed_bytes += grid->bytes;
+    }
+    printf("%-24s %10ld %12.1f %10.1f %12.2f\n\n", "total", total_cells, plain_bytes / 1024.0,
+           packed_bytes / 1024.0, total_cells > 0 ? packed_bytes * 8.0 / total_cells : 0.0);
+
+    uint32_t sums[3];
+    double scans[3] = {
+        time_scan(plain, scan_plain, row, iterations, times, &sums[0]),
+        time_scan(compact, scan_get, row, iterations, times, &sums[1]),
+        time_scan(compact, scan_runs, row, iterations, times, &sums[2]),
+    };
+    static const char *scan_names[3] = { "plain array", "tile_palette_get", "decode_run" };
+    printf("%-20s %12s %12s\n", "full scan", "median ms", "Mcells/s");
+    for (int i = 0; i < 3; i++) {
+        printf("%-20s %12.3f %12.1f\n", scan_names[i], scans[i],
+               scans[i] > 0.0 ? total_cells / (scans[i] * 1000.0) : 0.0);
+    }
+    if (sums[1] != sums[0] || sums[2] != sums[0]) printf("WARNING: packed descriptors differ from plain ones\n");
+
+    // View sizes in tiles, from one screen at zoom 2 to the whole map
+    static const int views[] = { 40, 80, 160, 320, 640 };
+    printf("\n%-10s %10s %12s %12s\n", "view", "quads", "plain ms", "packed ms");
+    for (int v = 0; v < (int)(sizeof(views) / sizeof(views[0])); v++) {
+        long quads = 0, packed_quads = 0;
+        double plain_ms = time_batches(plain, views[v], iterations, times, &quads);
+        double packed_ms = time_batches(compact, views[v], iterations, times, &packed_quads);
+        char label[32];
+        snprintf(label, sizeof(label), "%dx%d", views[v], views[v]);
+        printf("%-10s %10ld %12.3f %12.3f%s\n", label, quads, plain_ms, packed_ms,
+               quads != packed_quads ? "  (quad counts differ)" : "");
+    }
+
+    free(times);
+    free(row);
+    tilemap_unload(plain);
+    tilemap_unload(compact);
+    return 0;
+}
@@ -0,0 +1,237 @@
+// Map draw benchmark: frame time of tilemap_draw_all() (per-cell draw
+// descriptors) against the previous per-tile path, which searched the
+// tilesets, computed the source rect and branched on the flip flags for every
+// visible cell. Runs in a hidden window, centred on the map, at several zoom
+// levels; zoomed out is where the visible tile count gets large. The last
+// columns draw the same view as one mesh per tileset (tilemap_set_batching),
+// with the GPU layer renderer (TILE_RENDER_GPU) and from the baked chunk cache.
+// Those all draw every tile; "culled" is the per-cell path again with
+// occlusion culling on (tilemap_set_occlusion), skipping covered tiles, and
+// "lod" is the default setup, which draws each layer from its overview
+// texture once a tile covers TILEMAP_OVERVIEW_PX_DEFAULT pixels or less.
+//
+// Usage: bench_tilemap_draw <map.tmj> [frames]
+
+#include "tilemap.h"
+#include "platform.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define SCREEN_W 1280
+#define SCREEN_H 720
+
+// Previous draw path, kept here as the baseline (finite layers only)
+static void draw_tile_legacy(TileMap *map, uint32_t raw_gid, int x, int y, Color tint) {
+    uint32_t gid = raw_gid & GID_MASK;
+    if (gid == 0) return;
+
+    TilesetInfo *ts = NULL;
+    for (int t = map->tileset_count - 1; t >= 0; t--) {
+        if ((uint32_t)map->tilesets[t].firstgid <= gid) {
+            ts = &map->tilesets[t];
+            break;
+        }
+    }
+    if (!ts || ts->texture.id == 0) return;
+
+    int local_id = (int)gid - ts->firstgid;
+    if (ts->anim_lookup && local_id >= 0 && local_id < ts->tilecount) {
+        TileAnim *anim = &ts->anim_lookup[local_id];
+        if (anim->frame_count > 0) {
+            int t = (int)fmod(map->anim_time, (double)anim->total_duration);
+            int acc = 0;
+            for (int f = 0; f < anim->frame_count; f++) {
+                acc += anim->frames[f].duration;
+                if (t < acc) {
+                    local_id = anim->frames[f].tileid;
+                    break;
+                }
+            }
+        }
+    }
+
+    int col = local_id % ts->columns;
+    int row = local_id / ts->columns;
+    Rectangle src = {
+        (float)(ts->margin + col * (ts->tilewidth + ts->spacing)),
+        (float)(ts->margin + row * (ts->tileheight + ts->spacing)),
+        (float)ts->tilewidth,
+        (float)ts->tileheight
+    };
+
+    bool flipH = (raw_gid & FLIPPED_H_FLAG) != 0;
+    bool flipV = (raw_gid & FLIPPED_V_FLAG) != 0;
+    bool flipD = (raw_gid & FLIPPED_D_FLAG) != 0;
+    Rectangle dst = {
+        (float)(x * map->tilewidth),
+        (float)(y * map->tileheight),
+        (float)map->tilewidth,
+        (float)map->tileheight
+    };
+
+    float rotation = 0;
+    if (flipD) {
+        if (flipH && flipV) {
+            rotation = 90.0f;
+            dst.x += map->tilewidth;
+            src.width = -src.width;
+        } else if (flipH) {
+            rotation = 90.0f;
+            dst.x += map->tilewidth;
+        } else if (flipV) {
+            rotation = 270.0f;
+            dst.y += map->tileheight;
+        } else {
+            rotation = 270.0f;
+            dst.y += map->tileheight;
+            src.width = -src.width;
+        }
+    } else {
+        if (flipH) src.width = -src.width;
+        if (flipV) src.height = -src.height;
+    }
+
+    DrawTexturePro(ts->texture, src, dst, (Vector2){0, 0}, rotation, tint);
+}
+
+static void draw_all_legacy(TileMap *map, Camera2D camera) {
+    float cam_x = camera.target.x - camera.offset.x / camera.zoom;
+    float cam_y = camera.target.y - camera.offset.y / camera.zoom;
+    int start_x = (int)floorf(cam_x / map->tilewidth) - 1;
+    int start_y = (int)floorf(cam_y / map->tileheight) - 1;
+    int end_x = (int)floorf((cam_x + GetScreenWidth() / camera.zoom) / map->tilewidth) + 2;
+    int end_y = (int)floorf((cam_y + GetScreenHeight() / camera.zoom) / map->tileheight) + 2;
+
+    for (int i = 0; i < map->tile_layer_count; i++) {
+        TileLayer *layer = &map->tile_layers[i];
+        if (!layer->visible || !layer->data) continue;
+        Color tint = WHITE;
+        tint.a = (unsigned char)(tint.a * layer->opacity);
+
+        int x0 = start_x < 0 ? 0 : start_x;
+        int y0 = start_y < 0 ? 0 : start_y;
+        int x1 = end_x > layer->width ? layer->width : end_x;
+        int y1 = end_y > layer->height ? layer->height : end_y;
+        for (int y = y0; y < y1; y++) {
+            for (int x = x0; x < x1; x++) {
+                draw_tile_legacy(map, layer->data[y * layer->width + x], x, y, tint);
+            }
+        }
+    }
+}
+
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// Median frame time in ms over `frames` frames
+static double time_frames(TileMap *map, Camera2D camera, int frames, bool legacy) {
+    double *times = (double *)malloc(frames * sizeof(double));
+    if (!times) return 0.0;
+    for (int i = 0; i < frames; i++) {
+        double start = platform_time_seconds();
+        tilemap_update(map, 1.0f / 60.0f);
+        BeginDrawing();
+        ClearBackground(BLACK);
+        BeginMode2D(camera);
+        if (legacy) draw_all_legacy(map, camera);
+        else tilemap_draw_all(map, camera);
+        EndMode2D();
+        EndDrawing();
+        times[i] = (platform_time_seconds() - start) * 1000.0;
+    }
+    qsort(times, frames, sizeof(double), compare_double);
+    double median = times[frames / 2];
+    free(times);
+    return median;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <map.tmj> [frames]\n", argv[0]);
+        return 2;
+    }
+    const char *path = argv[1];
+    int frames = argc > 2 ? atoi(argv[2]) : 120;
+    if (frames < 1) frames = 1;
+
+    SetTraceLogLevel(LOG_WARNING);
+    SetConfigFlags(FLAG_WINDOW_HIDDEN);
+    InitWindow(SCREEN_W, SCREEN_H, "bench_tilemap_draw");
+    if (!IsWindowReady()) {
+        fprintf(stderr, "Could not open a window\n");
+        return 1;
+    }
+
+    tilemap_set_logging(false);
+    TileMap *map = tilemap_load(path);
+    if (!map) {
+        fprintf(stderr, "Failed to load %s\n", path);
+        CloseWindow();
+        return 1;
+    }
+    if (map->infinite) printf("Infinite map: the legacy path draws nothing for chunked layers\n");
+    tilemap_set_occlusion(map, false);
+    tilemap_set_overview_threshold(map, 0.0f);
+
+    Camera2D camera = { 0 };
+    camera.offset = (Vector2){ SCREEN_W / 2.0f, SCREEN_H / 2.0f };
+    camera.target = (Vector2){
+        (map->startx + map->width / 2.0f) * map->tilewidth,
+        (map->starty + map->height / 2.0f) * map->tileheight
+    };
+
+    static const float zooms[] = { 2.0f, 1.0f, 0.5f, 0.25f, 0.125f, 0.0625f };
+    printf("%s, %d frames per run, %dx%d window, %d animated tile IDs\n",
+           path, frames, SCREEN_W, SCREEN_H, map->anim_count);
+    printf("%-6s %10s %12s %12s %12s %12s %12s %12s %12s\n", "zoom", "cells", "legacy ms", "desc ms", "batch ms",
+           "gpu ms", "baked ms", "culled ms", "lod ms");
+    for (int z = 0; z < (int)(sizeof(zooms) / sizeof(zooms[0])); z++) {
+        camera.zoom = zooms[z];
+        if (map->infinite) tilemap_stream_chunks(map, camera);
+
+        long cells_x = (long)ceilf(SCREEN_W / camera.zoom / map->tilewidth) + 3;
+        long cells_y = (long)ceilf(SCREEN_H / camera.zoom / map->tileheight) + 3;
+        if (cells_x > map->width) cells_x = map->width;
+        if (cells_y > map->height) cells_y = map->height;
+
+        tilemap_set_bake_budget(map, 0);
+        tilemap_set_batching(map, false);
+        double legacy = time_frames(map, camera, frames, true);
+        double desc = time_frames(map, camera, frames, false);
+        tilemap_set_batching(map, true);
+        double batch = time_frames(map, camera, frames, false);
+        for (int l = 0; l < map->tile_layer_count; l++) tilemap_set_layer_renderer(map, l, TILE_RENDER_GPU);
+        double gpu = time_frames(map, camera, frames, false);
+        for (int l = 0; l < map->tile_layer_count; l++) tilemap_set_layer_renderer(map, l, TILE_RENDER_TILES);
+
+        // Bake the whole view up front so no frame pays for baking
+        tilemap_set_bake_budget(map, TILEMAP_BAKE_BUDGET_DEFAULT);
+        tilemap_bake_chunks(map, camera);
+        int bake_chunks = map->tile_layer_count * map->bake_cols * map->bake_rows;
+        for (int i = 0; i < bake_chunks / TILEMAP_BAKES_PER_FRAME; i++) tilemap_bake_chunks(map, camera);
+        double baked = time_frames(map, camera, frames, false);
+
+        tilemap_set_bake_budget(map, 0);
+        tilemap_set_batching(map, false);
+        tilemap_set_occlusion(map, true);
+        double culled = time_frames(map, camera, frames, false);
+        tilemap_set_batching(map, true);
+        tilemap_set_overview_threshold(map, TILEMAP_OVERVIEW_PX_DEFAULT);
+        double lod = time_frames(map, camera, frames, false);
+        tilemap_set_overview_threshold(map, 0.0f);
+        tilemap_set_occlusion(map, false);
+        printf("%-6.3f %10ld %12.3f %12.3f %12.3f %12.3f %12.3f %12.3f %12.3f\n", camera.zoom,
+               cells_x * cells_y * map->tile_layer_count, legacy, desc, batch, gpu, baked, culled, lod);
+    }
+
+    tilemap_set_occlusion(map, true);
+    tilemap_draw_all(map, camera);
+    printf("Occlusion culling hides %d of the map's tiles\n", map->hidden_cells);
+
+    tilemap_unload(map);
+    CloseWindow();
+    return 0;
+}
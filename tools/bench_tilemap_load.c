@@ -0,0 +1,257 @@
+// Map load benchmark: times tilemap_parse_json() (streaming layer data) against
+// a full cJSON DOM parse of the same file, the way maps used to be loaded.
+// cJSON allocations are counted through cJSON_InitHooks for both paths, which
+// run single-threaded.
+//
+// Then sweeps the load thread count (tilemap_set_load_threads) and reports the
+// wall time of tilemap_parse_json() and of a full tilemap_load(), which also
+// decodes and uploads the tileset images (in a hidden window).
+//
+// Finally loads the map `iterations` more times with the default thread count
+// and prints percentiles of every TileMapLoadStats phase, to catch load-time
+// regressions in the asset pipeline. Without a window only the parse phases
+// (tilemap_parse_json) are measured.
+//
+// Usage: bench_tilemap_load <map.tmj> [iterations]
+
+#include "tilemap.h"
+#include "platform.h"
+#include "cJSON.h"
+#include "json_stream.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Allocation accounting for cJSON: each block carries its size in a header
+typedef struct AllocStats {
+    long count;
+    size_t live_bytes;
+    size_t peak_bytes;
+} AllocStats;
+
+static AllocStats alloc_stats;
+
+static void *counting_malloc(size_t size) {
+    size_t *block = (size_t *)malloc(size + sizeof(size_t) * 2);
+    if (!block) return NULL;
+    block[0] = size;
+    alloc_stats.count++;
+    alloc_stats.live_bytes += size;
+    if (alloc_stats.live_bytes > alloc_stats.peak_bytes) alloc_stats.peak_bytes = alloc_stats.live_bytes;
+    return block + 2;
+}
+
+static void counting_free(void *ptr) {
+    if (!ptr) return;
+    size_t *block = (size_t *)ptr - 2;
+    alloc_stats.live_bytes -= block[0];
+    free(block);
+}
+
+static void reset_alloc_stats(void) {
+    alloc_stats.count = 0;
+    alloc_stats.peak_bytes = alloc_stats.live_bytes;
+}
+
+// Previous loader: DOM for the whole file, then copy each GID out of its node
+static bool load_dom(const char *path) {
+    char *text = LoadFileText(path);
+    if (!text) return false;
+    json_fix_backslashes(text, strlen(text));
+    cJSON *root = cJSON_Parse(text);
+    UnloadFileText(text);
+    if (!root) return false;
+
+    cJSON *layers = cJSON_GetObjectItem(root, "layers");
+    cJSON *layer;
+    cJSON_ArrayForEach(layer, layers) {
+        cJSON *data = cJSON_GetObjectItem(layer, "data");
+        if (!data || !cJSON_IsArray(data)) continue;
+        uint32_t *gids = (uint32_t *)malloc(cJSON_GetArraySize(data) * sizeof(uint32_t));
+        int i = 0;
+        cJSON *gid;
+        cJSON_ArrayForEach(gid, data) {
+            gids[i++] = (uint32_t)gid->valuedouble;
+        }
+        free(gids);
+    }
+    cJSON_Delete(root);
+    return true;
+}
+
+static bool load_streaming(const char *path) {
+    TileMap *map = tilemap_parse_json(path);
+    if (!map) return false;
+    tilemap_unload(map);
+    return true;
+}
+
+static bool load_full(const char *path) {
+    TileMap *map = tilemap_load(path);
+    if (!map) return false;
+    tilemap_unload(map);
+    return true;
+}
+
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// Percentile of sorted samples (nearest rank)
+static double percentile(const double *sorted, int count, double p) {
+    int index = (int)(p * (count - 1) + 0.5);
+    return sorted[index];
+}
+
+typedef struct Phase {
+    const char *name;
+    size_t offset;          // of the double in TileMapLoadStats
+} Phase;
+
+static const Phase phases[] = {
+    { "read",      offsetof(TileMapLoadStats, read_ms) },
+    { "fix",       offsetof(TileMapLoadStats, fix_ms) },
+    { "stream",    offsetof(TileMapLoadStats, stream_ms) },
+    { "tilesets",  offsetof(TileMapLoadStats, tilesets_ms) },
+    { "layers",    offsetof(TileMapLoadStats, layers_ms) },
+    { "objects",   offsetof(TileMapLoadStats, objects_ms) },
+    { "desc",      offsetof(TileMapLoadStats, desc_ms) },
+    { "index",     offsetof(TileMapLoadStats, index_ms) },
+    { "images",    offsetof(TileMapLoadStats, images_ms) },
+    { "parallel",  offsetof(TileMapLoadStats, parallel_ms) },
+    { "analyze",   offsetof(TileMapLoadStats, analyze_ms) },
+    { "spans",     offsetof(TileMapLoadStats, spans_ms) },
+    { "upload",    offsetof(TileMapLoadStats, upload_ms) },
+    { "total",     offsetof(TileMapLoadStats, total_ms) },
+};
+#define PHASE_COUNT ((int)(sizeof(phases) / sizeof(phases[0])))
+
+static bool run_phases(const char *path, int iterations, bool upload) {
+    TileMapLoadStats *samples = (TileMapLoadStats *)calloc(iterations, sizeof(TileMapLoadStats));
+    double *values = (double *)malloc(iterations * sizeof(double));
+    if (!samples || !values) {
+        free(samples);
+        free(values);
+        return false;
+    }
+
+    bool ok = true;
+    for (int i = 0; ok && i < iterations; i++) {
+        TileMap *map = upload ? tilemap_load(path) : tilemap_parse_json(path);
+        if (!map) {
+            fprintf(stderr, "phases: failed to load %s\n", path);
+            ok = false;
+            break;
+        }
+        samples[i] = map->load_stats;
+        tilemap_unload(map);
+    }
+
+    if (ok) {
+        const TileMapLoadStats *last = &samples[iterations - 1];
+        printf("\n%s phases over %d loads (%s, %d thread%s, %.1f KB map memory in %d block%s)\n",
+               upload ? "tilemap_load" : "tilemap_parse_json", iterations,
+               last->cooked ? "cooked" : "json", last->threads, last->threads == 1 ? "" : "s",
+               last->arena_bytes / 1024.0, last->arena_blocks, last->arena_blocks == 1 ? "" : "s");
+        printf("%-10s %9s %9s %9s %9s\n", "phase", "p50 ms", "p90 ms", "p99 ms", "max ms");
+        for (int p = 0; p < PHASE_COUNT; p++) {
+            for (int i = 0; i < iterations; i++) {
+                values[i] = *(const double *)((const char *)&samples[i] + phases[p].offset);
+            }
+            qsort(values, iterations, sizeof(double), compare_double);
+            printf("%-10s %9.3f %9.3f %9.3f %9.3f\n", phases[p].name,
+                   percentile(values, iterations, 0.50), percentile(values, iterations, 0.90),
+                   percentile(values, iterations, 0.99), values[iterations - 1]);
+        }
+    }
+    free(samples);
+    free(values);
+    return ok;
+}
+
+static bool run(const char *label, bool (*load)(const char *), const char *path, int iterations,
+                bool show_allocs) {
+    double *times = (double *)malloc(iterations * sizeof(double));
+    long allocs = 0;
+    size_t peak = 0;
+
+    for (int i = 0; i < iterations; i++) {
+        reset_alloc_stats();
+        double start = platform_time_seconds();
+        if (!load(path)) {
+            fprintf(stderr, "%s: failed to load %s\n", label, path);
+            free(times);
+            return false;
+        }
+        times[i] = (platform_time_seconds() - start) * 1000.0;
+        allocs = alloc_stats.count;
+        peak = alloc_stats.peak_bytes;
+    }
+
+    qsort(times, iterations, sizeof(double), compare_double);
+    if (show_allocs) {
+        printf("%-10s min %8.2f ms   median %8.2f ms   cJSON allocs %8ld   cJSON peak %8.1f KB\n",
+               label, times[0], times[iterations / 2], allocs, peak / 1024.0);
+    } else {
+        printf("%-10s min %8.2f ms   median %8.2f ms\n", label, times[0], times[iterations / 2]);
+    }
+    free(times);
+    return true;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <map.tmj> [iterations]\n", argv[0]);
+        return 2;
+    }
+    const char *path = argv[1];
+    int iterations = argc > 2 ? atoi(argv[2]) : 20;
+    if (iterations < 1) iterations = 1;
+
+    cJSON_Hooks hooks = { counting_malloc, counting_free };
+    cJSON_InitHooks(&hooks);
+    SetTraceLogLevel(LOG_WARNING);
+    tilemap_set_logging(false);
+
+    printf("%s, %d iterations\n", path, iterations);
+    tilemap_set_load_threads(1);
+    bool ok = run("cjson-dom", load_dom, path, iterations, true);
+    ok = ok && run("streaming", load_streaming, path, iterations, true);
+
+    // The allocation counters are not thread-safe
+    cJSON_InitHooks(NULL);
+
+    static const int thread_counts[] = { 1, 2, 4, 8 };
+    int sweep = sizeof(thread_counts) / sizeof(thread_counts[0]);
+
+    printf("\ntilemap_parse_json by load threads\n");
+    for (int i = 0; ok && i < sweep; i++) {
+        char label[32];
+        snprintf(label, sizeof(label), "%d thread%s", thread_counts[i], thread_counts[i] > 1 ? "s" : "");
+        tilemap_set_load_threads(thread_counts[i]);
+        ok = run(label, load_streaming, path, iterations, false);
+    }
+
+    SetConfigFlags(FLAG_WINDOW_HIDDEN);
+    InitWindow(64, 64, "bench_tilemap_load");
+    if (!IsWindowReady()) {
+        printf("\nNo window available, skipping tilemap_load\n");
+        tilemap_set_load_threads(TILEMAP_LOAD_THREADS_AUTO);
+        ok = ok && run_phases(path, iterations, false);
+        return ok ? 0 : 1;
+    }
+    printf("\ntilemap_load (with tileset images) by load threads\n");
+    for (int i = 0; ok && i < sweep; i++) {
+        char label[32];
+        snprintf(label, sizeof(label), "%d thread%s", thread_counts[i], thread_counts[i] > 1 ? "s" : "");
+        tilemap_set_load_threads(thread_counts[i]);
+        ok = run(label, load_full, path, iterations, false);
+    }
+
+    tilemap_set_load_threads(TILEMAP_LOAD_THREADS_AUTO);
+    ok = ok && run_phases(path, iterations, true);
+    CloseWindow();
+    return ok ? 0 : 1;
+}
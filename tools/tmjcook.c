@@ -0,0 +1,256 @@
+// Offline map cooker: converts a Tiled .tmj (plus its external .tsj tilesets)
+// into the binary .tmb format that tilemap_load() maps at runtime.
+//
+// Usage: tmjcook <map.tmj> [out.tmb]
+// The output defaults to the input path with a .tmb extension.
+
+#include "tilemap.h"
+#include "tilemap_format.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct CookBuffer {
+    uint8_t *data;
+    size_t size;
+    size_t capacity;
+} CookBuffer;
+
+// Append `size` zeroed bytes at the next TMB_ALIGN boundary, return their offset.
+// Pointers into the buffer are invalidated; always go through COOK_AT().
+static uint32_t cook_reserve(CookBuffer *buf, size_t size) {
+    size_t offset = (buf->size + (TMB_ALIGN - 1)) & ~(size_t)(TMB_ALIGN - 1);
+    size_t needed = offset + size;
+    if (needed > buf->capacity) {
+        size_t cap = buf->capacity ? buf->capacity : 4096;
+        while (cap < needed) cap *= 2;
+        uint8_t *grown = (uint8_t *)realloc(buf->data, cap);
+        if (!grown) {
+            fprintf(stderr, "[tmjcook] ERROR: out of memory\n");
+            exit(1);
+        }
+        memset(grown + buf->capacity, 0, cap - buf->capacity);
+        buf->data = grown;
+        buf->capacity = cap;
+    }
+    buf->size = needed;
+    return (uint32_t)offset;
+}
+
+#define COOK_AT(buf, offset, type) ((type *)((buf)->data + (offset)))
+
+// String pool: offset 0 is the empty string, equal strings are stored once
+static uint32_t cook_string(CookBuffer *pool, const char *str) {
+    if (!str || !str[0]) return 0;
+    size_t pos = 1;
+    while (pos < pool->size) {
+        const char *existing = (const char *)pool->data + pos;
+        if (strcmp(existing, str) == 0) return (uint32_t)pos;
+        pos += strlen(existing) + 1;
+    }
+    size_t len = strlen(str) + 1;
+    size_t offset = pool->size;
+    if (offset + len > pool->capacity) {
+        size_t cap = pool->capacity ? pool->capacity : 1024;
+        while (cap < offset + len) cap *= 2;
+        pool->data = (uint8_t *)realloc(pool->data, cap);
+        if (!pool->data) {
+            fprintf(stderr, "[tmjcook] ERROR: out of memory\n");
+            exit(1);
+        }
+        pool->capacity = cap;
+    }
+    memcpy(pool->data + offset, str, len);
+    pool->size += len;
+    return (uint32_t)offset;
+}
+
+// Paths in the .tmb are relative to the map's directory
+static const char *relative_to(const char *path, const char *dir) {
+    size_t len = strlen(dir);
+    if (len > 0 && strncmp(path, dir, len) == 0) return path + len;
+    return path;
+}
+
+static void map_directory(const char *path, char *dir, size_t dir_size) {
+    snprintf(dir, dir_size, "%s", path);
+    for (char *p = dir; *p; p++) {
+        if (*p == '\\') *p = '/';
+    }
+    char *last_slash = strrchr(dir, '/');
+    if (last_slash) {
+        last_slash[1] = '\0';
+    } else {
+        dir[0] = '\0';
+    }
+}
+
+static bool cook_map(const TileMap *map, const char *map_dir, const char *out_path) {
+    CookBuffer buf = {0};
+    CookBuffer pool = { (uint8_t *)calloc(1, 1024), 1, 1024 };   // starts with ""
+
+    uint32_t header_off = cook_reserve(&buf, sizeof(TmbHeader));
+
+    // Tilesets and their animation tables
+    uint32_t tilesets_off = cook_reserve(&buf, map->tileset_count * sizeof(TmbTileset));
+    for (int i = 0; i < map->tileset_count; i++) {
+        const TilesetInfo *ts = &map->tilesets[i];
+        uint32_t anim_count = 0;
+        for (int t = 0; ts->anim_lookup && t < ts->tilecount; t++) {
+            if (ts->anim_lookup[t].frame_count > 0) anim_count++;
+        }
+        uint32_t anims_off = cook_reserve(&buf, anim_count * sizeof(TmbTileAnim));
+
+        uint32_t a = 0;
+        for (int t = 0; ts->anim_lookup && t < ts->tilecount; t++) {
+            const TileAnim *anim = &ts->anim_lookup[t];
+            if (anim->frame_count <= 0) continue;
+            uint32_t frames_off = cook_reserve(&buf, anim->frame_count * sizeof(TileAnimFrame));
+            memcpy(buf.data + frames_off, anim->frames, anim->frame_count * sizeof(TileAnimFrame));
+
+            TmbTileAnim *dst = COOK_AT(&buf, anims_off, TmbTileAnim) + a++;
+            dst->tileid = t;
+            dst->frame_count = anim->frame_count;
+            dst->total_duration = anim->total_duration;
+            dst->frames_offset = frames_off;
+        }
+
+        TmbTileset *dst = COOK_AT(&buf, tilesets_off, TmbTileset) + i;
+        dst->firstgid = ts->firstgid;
+        dst->tilewidth = ts->tilewidth;
+        dst->tileheight = ts->tileheight;
+        dst->columns = ts->columns;
+        dst->tilecount = ts->tilecount;
+        dst->margin = ts->margin;
+        dst->spacing = ts->spacing;
+        dst->imagewidth = ts->imagewidth;
+        dst->imageheight = ts->imageheight;
+        dst->image = cook_string(&pool, relative_to(ts->image_path, map_dir));
+        dst->source = cook_string(&pool, relative_to(ts->source_path, map_dir));
+        dst->anim_count = anim_count;
+        dst->anims_offset = anims_off;
+    }
+
+    // Tile layers; GIDs are copied verbatim, flip flags included
+    uint32_t layers_off = cook_reserve(&buf, map->tile_layer_count * sizeof(TmbTileLayer));
+    for (int i = 0; i < map->tile_layer_count; i++) {
+        const TileLayer *layer = &map->tile_layers[i];
+        size_t cells = (size_t)layer->width * layer->height;
+        uint32_t data_off = cook_reserve(&buf, cells * sizeof(uint32_t));
+        if (layer->data) memcpy(buf.data + data_off, layer->data, cells * sizeof(uint32_t));
+
+        TmbTileLayer *dst = COOK_AT(&buf, layers_off, TmbTileLayer) + i;
+        dst->name = cook_string(&pool, layer->name);
+        dst->render_layer = cook_string(&pool, tilemap_string(map, layer->render_layer));
+        dst->shader = cook_string(&pool, tilemap_string(map, layer->shader));
+        dst->width = layer->data ? layer->width : 0;
+        dst->height = layer->data ? layer->height : 0;
+        dst->visible = layer->visible;
+        dst->opacity = layer->opacity;
+        dst->elevation = layer->elevation;
+        dst->data_offset = data_off;
+    }
+
+    // Object layers
+    uint32_t obj_layers_off = cook_reserve(&buf, map->object_layer_count * sizeof(TmbObjectLayer));
+    for (int i = 0; i < map->object_layer_count; i++) {
+        const ObjectLayer *layer = &map->object_layers[i];
+        uint32_t objects_off = cook_reserve(&buf, layer->object_count * sizeof(TmbObject));
+        for (int j = 0; j < layer->object_count; j++) {
+            const MapObject *mo = &layer->objects[j];
+            TmbObject *dst = COOK_AT(&buf, objects_off, TmbObject) + j;
+            dst->x = mo->x;
+            dst->y = mo->y;
+            dst->width = mo->width;
+            dst->height = mo->height;
+            dst->rotation = mo->rotation;
+            dst->id = mo->id;
+            dst->name = cook_string(&pool, tilemap_string(map, mo->name_id));
+            dst->type = cook_string(&pool, tilemap_string(map, mo->type_id));
+            dst->visible = mo->visible;
+            dst->elevation = mo->elevation;
+            dst->from_elevation = mo->from_elevation;
+            dst->to_elevation = mo->to_elevation;
+        }
+
+        TmbObjectLayer *dst = COOK_AT(&buf, obj_layers_off, TmbObjectLayer) + i;
+        dst->name = cook_string(&pool, layer->name);
+        dst->visible = layer->visible;
+        dst->object_count = (uint32_t)layer->object_count;
+        dst->objects_offset = objects_off;
+    }
+
+    uint32_t strings_off = cook_reserve(&buf, pool.size);
+    memcpy(buf.data + strings_off, pool.data, pool.size);
+    cook_reserve(&buf, 0);  // pad the file to TMB_ALIGN
+
+    TmbHeader *hdr = COOK_AT(&buf, header_off, TmbHeader);
+    hdr->magic = TMB_MAGIC;
+    hdr->version = TMB_VERSION;
+    hdr->file_size = (uint32_t)buf.size;
+    hdr->width = map->width;
+    hdr->height = map->height;
+    hdr->tilewidth = map->tilewidth;
+    hdr->tileheight = map->tileheight;
+    hdr->tileset_count = (uint32_t)map->tileset_count;
+    hdr->tile_layer_count = (uint32_t)map->tile_layer_count;
+    hdr->object_layer_count = (uint32_t)map->object_layer_count;
+    hdr->tilesets_offset = tilesets_off;
+    hdr->tile_layers_offset = layers_off;
+    hdr->object_layers_offset = obj_layers_off;
+    hdr->strings_offset = strings_off;
+    hdr->strings_size = (uint32_t)pool.size;
+
+    bool ok = false;
+    FILE *f = fopen(out_path, "wb");
+    if (f) {
+        ok = fwrite(buf.data, 1, buf.size, f) == buf.size;
+        ok = (fclose(f) == 0) && ok;
+    }
+    if (ok) {
+        printf("[tmjcook] Wrote %s (%zu bytes)\n", out_path, buf.size);
+    } else {
+        fprintf(stderr, "[tmjcook] ERROR: Could not write %s\n", out_path);
+    }
+
+    free(pool.data);
+    free(buf.data);
+    return ok;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2 || argc > 3) {
+        fprintf(stderr, "Usage: %s <map.tmj> [out.tmb]\n", argv[0]);
+        return 2;
+    }
+
+    const char *in_path = argv[1];
+    char out_path[512];
+    if (argc == 3) {
+        snprintf(out_path, sizeof(out_path), "%s", argv[2]);
+    } else {
+        const char *ext = strrchr(in_path, '.');
+        int stem_len = ext ? (int)(ext - in_path) : (int)strlen(in_path);
+        snprintf(out_path, sizeof(out_path), "%.*s.tmb", stem_len, in_path);
+    }
+
+    TileMap *map = tilemap_parse_json(in_path);
+    if (!map) {
+        fprintf(stderr, "[tmjcook] ERROR: Could not parse %s\n", in_path);
+        return 1;
+    }
+
+    // Infinite maps stay JSON: their chunks are streamed from the .tmj at runtime
+    if (map->infinite) {
+        printf("[tmjcook] Skipping %s: infinite maps are not cooked\n", in_path);
+        tilemap_unload(map);
+        return 0;
+    }
+
+    char map_dir[512];
+    map_directory(in_path, map_dir, sizeof(map_dir));
+    bool ok = cook_map(map, map_dir, out_path);
+
+    tilemap_unload(map);
+    return ok ? 0 : 1;
+}